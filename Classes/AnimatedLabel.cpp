@@ -18,11 +18,30 @@
 */
 
 #include "AnimatedLabel.h"
+#include "AnimatedLabelChoreographer.h"
+#include "GlyphDrawCounter.h"
+#include "GlyphEffectLibrary.h"
+#include "GlyphTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+
+//trace event tagged with this label and the start of its text
+#define TRACE_LABEL(name) GLYPH_TRACE_SCOPE(name, this, _utf8Text.c_str())
+
+//see EFFECT LOG
+static bool isLoggedLabel(const AnimatedLabel* label);
+static void forgetLoggedLabel(const AnimatedLabel* label);
+//logged in place of a call that can't be replayed, with the call's name as its text
+static const char* const kUnreplayableCall = "unreplayable";
 
 //CREATE FUNCTIONS
 
 AnimatedLabel* AnimatedLabel::createWithBMFont(const std::string& bmfontFilePath, const std::string& text,const cocos2d::TextHAlignment& alignment /* = TextHAlignment::LEFT */, int maxLineWidth /* = 0 */, const cocos2d::Vec2& imageOffset /* = Vec2::ZERO */)
 {
+	GLYPH_TRACE_SCOPE("createWithBMFont", nullptr, text.c_str());
+
 	auto ret = new AnimatedLabel();
 
 	if (ret && ret->setBMFontFilePath(bmfontFilePath,imageOffset))
@@ -40,6 +59,8 @@ AnimatedLabel* AnimatedLabel::createWithBMFont(const std::string& bmfontFilePath
 
 AnimatedLabel* AnimatedLabel::createWithTTF(const std::string& text, const std::string& fontFile, float fontSize, const cocos2d::Size& dimensions /* = Size::ZERO */, cocos2d::TextHAlignment hAlignment /* = TextHAlignment::LEFT */, cocos2d::TextVAlignment vAlignment /* = TextVAlignment::TOP */)
 {
+	GLYPH_TRACE_SCOPE("createWithTTF", nullptr, text.c_str());
+
 	auto ret = new (std::nothrow) AnimatedLabel();
 
 	if (ret && cocos2d::FileUtils::getInstance()->isFileExist(fontFile))
@@ -61,6 +82,108 @@ AnimatedLabel* AnimatedLabel::createWithTTF(const std::string& text, const std::
 	return nullptr;
 }
 
+typedef std::chrono::steady_clock SetupClock;
+
+static inline float secondsSince(const SetupClock::time_point& start)
+{
+	return std::chrono::duration<float>(SetupClock::now() - start).count();
+}
+
+AnimatedLabel::~AnimatedLabel()
+{
+	clearStaggeredRuns();
+	unregisterAnimatedGlyphs();
+	forgetLoggedLabel(this);
+
+	if (_choreographer != nullptr)
+	{
+		_choreographer->forgetLabel(this);
+		_choreographer->release();
+	}
+
+	CC_SAFE_RELEASE(_sharedAtlas);
+}
+
+void AnimatedLabel::setString(const std::string& text)
+{
+	TRACE_LABEL("setString");
+
+	//only once the label is in the log, its text is logged with it when it first appears
+	EffectLogScope effectLog(isLoggedLabel(this) ? this : nullptr, "setString", {}, text);
+
+	beginNewString();
+	cocos2d::Label::setString(text);
+
+	//replaces a string still on its way, whose effects start on this one
+	if (_pendingString != nullptr)
+	{
+		_pendingString.reset();
+		startQueuedEffects();
+	}
+}
+
+bool AnimatedLabel::setBMFontFilePath(const std::string& bmfontFilePath, const cocos2d::Vec2& imageOffset /* = Vec2::ZERO */, float fontSize /* = 0 */)
+{
+	_bmfontImageOffset = imageOffset;
+	return cocos2d::Label::setBMFontFilePath(bmfontFilePath, imageOffset, fontSize);
+}
+
+void AnimatedLabel::beginNewString()
+{
+	//the compact layout and any baked clip are about to go stale
+	stopCompactAnimation();
+	stopBakedEffect();
+
+	//idle letter sprites are about to be moved by the new layout, so rather than
+	//remembering where they used to rest, let the label draw as one batch again
+	if (!isAnimatingLetters())
+		releaseSettledLetters();
+	_letterRest.clear();
+	_hitGridDirty = true;
+	_letterPagesDirty = true;
+
+	//a label given a new string with nothing left to start is being recycled
+	recycleEffectArena();
+}
+
+void AnimatedLabel::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTransform, uint32_t parentFlags)
+{
+	//anything else that makes the label lay out again (alignment, dimensions, fonts)
+	//also ends a compact animation
+	if (_contentDirty && _glyphAnimator.getGlyphCount() > 0)
+	{
+		stopCompactAnimation();
+	}
+
+	if (_contentDirty)
+	{
+		_hitGridDirty = true;
+		_letterPagesDirty = true;
+		stopBakedEffect();
+	}
+
+	//before Label::visit settles the label's and the letters' dirty flags
+	const bool changed = hasChangesToDraw(parentFlags);
+
+	//Label::visit would lay out anyway, this only gives the layout its own trace event
+	if (_contentDirty && isVisible() && GlyphTrace::isEnabled())
+	{
+		TRACE_LABEL("layout");
+		updateContent();
+	}
+
+	cocos2d::Label::visit(renderer, parentTransform, parentFlags);
+
+	//the quads are only final once drawn, letter sprites and compact state included
+	if (_bakeCapture != nullptr)
+	{
+		captureBakedFrame();
+	}
+
+	recordFrameChanges(changed);
+}
+
+
 void AnimatedLabel::setCharScale(int index, float s)
 {
 
@@ -161,6 +284,7 @@ void AnimatedLabel::offsetAllCharsPositionBy(cocos2d::Vec2 offset)
 
 void AnimatedLabel::runActionOnSpriteAtIndex(int index, cocos2d::FiniteTimeAction* action)
 {
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runActionOnSpriteAtIndex");
 
 	if (index >= getStringLength() || index < 0)
 	{
@@ -176,6 +300,10 @@ void AnimatedLabel::runActionOnSpriteAtIndex(int index, cocos2d::FiniteTimeActio
 
 void AnimatedLabel::runActionOnAllSprites(cocos2d::Action* action, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
 {
+	TRACE_LABEL("runActionOnAllSprites");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runActionOnAllSprites");
+
+	registerAnimatedGlyphs();
 
 	const int numChars = getStringLength();
 
@@ -215,255 +343,668 @@ void AnimatedLabel::runActionOnAllSprites(cocos2d::Action* action, bool removeOn
 void AnimatedLabel::stopActionsOnAllSprites()
 {
 
+	clearStaggeredRuns();
+	clearLetterSetup();
+
 	const int numChars = getStringLength();
 
 	for (int i = 0; i < numChars; ++i)
 	{
 		cocos2d::Sprite *charSprite = getLetter(i);
-		charSprite->stopAllActions();
+		if (charSprite != nullptr)
+			charSprite->stopAllActions();
 	}
 }
 
-// TODO: Some functions below can only work if the number of characters is 2 or
-// more. I noticed this is not really necessary for all of these functions
-// since this requirement can be dropped. Work on this later on.
-// TL;DR: Remove the numChars < 2 requirement where possible.
 void AnimatedLabel::runActionOnAllSpritesSequentially(cocos2d::FiniteTimeAction* action, float duration, float initialDelay /* = 0.f */, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
 {
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runActionOnAllSpritesSequentially");
 
-	const int numChars = getStringLength();
+	runActionOnAllSpritesStaggered(action, GlyphStagger::linear(), duration, initialDelay, removeOnCompletion, callFuncOnCompletion);
+}
+
+void AnimatedLabel::runActionOnAllSpritesSequentiallyReverse(cocos2d::FiniteTimeAction* action, float duration, float initialDelay /* = 0.f */, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+{
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runActionOnAllSpritesSequentiallyReverse");
+
+	runActionOnAllSpritesStaggered(action, GlyphStagger::linearReverse(), duration, initialDelay, removeOnCompletion, callFuncOnCompletion);
+}
+
+void AnimatedLabel::runActionOnAllSpritesStaggered(cocos2d::FiniteTimeAction* action, const GlyphStagger& stagger, float duration, float initialDelay /* = 0.f */, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+{
+	TRACE_LABEL("runActionOnAllSpritesStaggered");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runActionOnAllSpritesStaggered");
+
+	registerAnimatedGlyphs();
 
-	if (numChars < 2)
+	StaggeredRun run(&_effectArena);
+	run.action = action;
+
+	if (callFuncOnCompletion != nullptr)
 	{
-		cocos2d::log("AnimatedLabel - runActionOnAllSpritesSequentially() requires at least 2 children to operate");
-		return;
+		run.completion.pushBack(callFuncOnCompletion);
 	}
-
-	for (int i = 0; i < numChars; ++i)
+	if (removeOnCompletion)
 	{
-		cocos2d::DelayTime *delay = cocos2d::DelayTime::create((duration/(numChars-1)) *i + initialDelay);
-		cocos2d::Action *actionCopy = action->clone();
-		cocos2d::Sequence *delayAndAction = cocos2d::Sequence::create(delay, actionCopy, nullptr);
-
-		cocos2d::Sprite *charSprite = getLetter(i);
+		run.completion.pushBack(cocos2d::CallFunc::create(CC_CALLBACK_0(AnimatedLabel::removeFromParent, this)));
+	}
 
-		if (i == numChars-1) //if i is the last character, run the call func actions
-		{
+	//the run points into the effect arena until it's released below: letters started
+	//straight away mustn't get the arena recycled under it
+	++_effectArenaHolds;
 
-			cocos2d::Vector<cocos2d::FiniteTimeAction*> actionsArray;
-			actionsArray.pushBack(delayAndAction);
+	collectStaggerGlyphs(_staggerGlyphs);
+	stagger.computeOffsets(_staggerGlyphs, duration, initialDelay, _staggerOffsets);
+	run.offsets.assign(_staggerOffsets.begin(), _staggerOffsets.end());
 
-			if (callFuncOnCompletion != nullptr)
-			{
-				actionsArray.pushBack(callFuncOnCompletion);
-			}
-			if (removeOnCompletion)
-			{
-				actionsArray.pushBack(cocos2d::CallFunc::create(CC_CALLBACK_0(AnimatedLabel::removeFromParent, this)));
-			}
+	//characters without a letter sprite (spaces, new lines) are skipped
+	run.order.reserve(_staggerGlyphs.size());
+	for (int i = 0, numChars = (int)_staggerGlyphs.size(); i < numChars; ++i)
+	{
+		if (getLetter(i) != nullptr)
+			run.order.push_back(i);
+	}
 
-			// TODO: When the last character is a new line, we are not able to
-			// run an action on it. I suppose we can't because there's nothing
-			// getting rendered. In any case, I won't need to run an action on
-			// that last newline character. Let's just cicunvent the issue for now.
-			if (_utf32Text[i] == '\n')
-			{
-				charSprite = getLetter(i - 1);
-				charSprite->stopAllActions();
-			}
+	bool finished = run.order.empty();
+	if (finished)
+	{
+		//nothing to animate, but the caller still expects the completion to happen
+		if (!run.completion.empty())
+			this->runAction(cocos2d::Sequence::create(run.completion));
+	}
+	else
+	{
+		const EffectVector<float>& offsets = run.offsets;
+		std::stable_sort(run.order.begin(), run.order.end(), [&offsets](int a, int b) { return offsets[a] < offsets[b]; });
 
-			cocos2d::Sequence *actionsSequence = cocos2d::Sequence::create(actionsArray);
-			charSprite->runAction(actionsSequence);
+		//letters due straight away start now, the rest are started by updateStaggeredRuns
+		action->retain();
+		finished = advanceStaggeredRun(run);
+		if (finished)
+		{
+			action->release();
 		}
-		else //if i is not the last character, just run the action
+		else
 		{
-			if (_utf32Text[i] != '\n') //both _label and _currentUTF16String has been made public!!!!
-				charSprite->runAction(delayAndAction);
-			//cocos2d::log("position: %f, %f, %d", charSprite->getPositionX(), charSprite->getPositionY(), i);
+			_staggeredRuns.push_back(std::move(run));
+			startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateStaggeredRuns));
 		}
+	}
 
+	run.releaseBuffers();
+	--_effectArenaHolds;
+
+	if (finished)
+	{
+		recycleEffectArena();
 	}
 }
 
-void AnimatedLabel::runActionOnAllSpritesSequentiallyReverse(cocos2d::FiniteTimeAction* action, float duration, float initialDelay /* = 0.f */, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+void AnimatedLabel::setEffectStagger(const GlyphStagger& stagger)
 {
-	const int numChars = getStringLength();
+	_effectStagger = stagger;
+	_hasEffectStagger = true;
+}
+
+void AnimatedLabel::resetEffectStagger()
+{
+	_hasEffectStagger = false;
+}
+
+GlyphStagger AnimatedLabel::getEffectStagger(bool reverse) const
+{
+	if (_hasEffectStagger)
+		return _effectStagger;
+
+	return reverse ? GlyphStagger::linearReverse() : GlyphStagger::linear();
+}
 
-	if (numChars < 2)
+void AnimatedLabel::runEffectStaggered(cocos2d::FiniteTimeAction* action, float duration, bool reverse, float initialDelay /* = 0.f */, bool removeOnCompletion /* = false */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+{
+	runActionOnAllSpritesStaggered(action, getEffectStagger(reverse), duration, initialDelay, removeOnCompletion, callFuncOnCompletion);
+}
+
+void AnimatedLabel::collectStaggerGlyphs(std::vector<GlyphStagger::Glyph>& glyphs)
+{
+	layoutIfDirty();
+
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
+	glyphs.resize(numChars);
+
+	int word = -1;
+	bool inWord = false;
+
+	for (int i = 0; i < numChars; ++i)
 	{
-		cocos2d::log("AnimatedLabel - runActionOnAllSpritesSequentiallyReverse() requires at least 2 children to operate");
-		return;
+		const LetterInfo& letterInfo = _lettersInfo[i];
+		char32_t c = _utf32Text[i];
+		bool whitespace = (c == ' ' || c == '\n' || c == '\t' || c == 0x3000);
+
+		if (!whitespace && !inWord)
+			++word;
+		inWord = !whitespace;
+
+		int line = letterInfo.lineIndex;
+		float lineOffsetX = (line >= 0 && line < (int)_linesOffsetX.size()) ? _linesOffsetX[line] : 0.f;
+
+		glyphs[i].x = letterInfo.positionX + lineOffsetX;
+		glyphs[i].y = letterInfo.positionY;
+		glyphs[i].word = std::max(word, 0);
+		glyphs[i].line = line;
 	}
+}
+
+void AnimatedLabel::getLineStarts(std::vector<int>& starts)
+{
+	layoutIfDirty();
+
+	starts.clear();
 
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
 	for (int i = 0; i < numChars; ++i)
 	{
-		cocos2d::DelayTime *delay = cocos2d::DelayTime::create((duration/(numChars-1)) *((numChars-1)-i) + initialDelay);
-		cocos2d::Action *actionCopy = action->clone();
-		cocos2d::Sequence *delayAndAction = cocos2d::Sequence::create(delay, actionCopy, nullptr);
-		cocos2d::Sprite *charSprite = getLetter(i);
+		if (i == 0 || _lettersInfo[i].lineIndex != _lettersInfo[i - 1].lineIndex)
+			starts.push_back(i);
+	}
+}
 
-		if (i == 0) //if i is the first character, run the call func actions
-		{
+bool AnimatedLabel::advanceStaggeredRun(StaggeredRun& run)
+{
+	const int numStarts = (int)run.order.size();
 
-			cocos2d::Vector<cocos2d::FiniteTimeAction*> actionsArray;
-			actionsArray.pushBack(delayAndAction);
+	if (run.next >= numStarts || run.offsets[run.order[run.next]] > run.elapsed)
+		return run.next >= numStarts;
 
-			if (callFuncOnCompletion != nullptr)
-			{
-				actionsArray.pushBack(callFuncOnCompletion);
-			}
-			if (removeOnCompletion)
+	const SetupClock::time_point setupStart = SetupClock::now();
+	const int firstStart = run.next;
+
+	while (run.next < numStarts && run.offsets[run.order[run.next]] <= run.elapsed)
+	{
+		const int index = run.order[run.next++];
+		const float lateBy = run.elapsed - run.offsets[index];
+		cocos2d::Sprite *charSprite = getLetter(index);
+
+		//the string may have changed since the run was set up
+		if (charSprite == nullptr)
+			continue;
+
+		cocos2d::FiniteTimeAction *actionCopy = run.action->clone();
+
+		if (run.next == numStarts && !run.completion.empty()) //the last letter to start runs the completion actions
+		{
+			cocos2d::Vector<cocos2d::FiniteTimeAction*> actionsArray;
+			actionsArray.pushBack(actionCopy);
+			for (auto&& completionAction : run.completion)
 			{
-				actionsArray.pushBack(cocos2d::CallFunc::create(CC_CALLBACK_0(AnimatedLabel::removeFromParent, this)));
+				actionsArray.pushBack(completionAction);
 			}
-			cocos2d::Sequence *actionsSequence = cocos2d::Sequence::create(actionsArray);
-			charSprite->runAction(actionsSequence);
+			startLetterAction(charSprite, cocos2d::Sequence::create(actionsArray), lateBy);
 		}
-		else //if i is not the first character, just run the action
+		else
 		{
-			charSprite->runAction(delayAndAction);
+			startLetterAction(charSprite, actionCopy, lateBy);
 		}
 	}
 
+	recordSetupTime(secondsSince(setupStart), run.next - firstStart);
+
+	return run.next >= numStarts;
 }
 
-void AnimatedLabel::flyPastAndRemove()
+void AnimatedLabel::updateStaggeredRuns(float dt)
 {
+	TRACE_LABEL("updateStaggeredRuns");
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	//started letters may run user code that removes the label, and the scheduler doesn't
+	//hold on to it
+	retain();
 
-	offsetAllCharsPositionBy(cocos2d::Vec2(-visibleSize.width * rescaleFactor, 0));
+	for (size_t i = 0; i < _staggeredRuns.size();)
+	{
+		_staggeredRuns[i].elapsed += dt;
 
-	float centrePortion = visibleSize.width*0.05;
-	float centreSlowTime = 0.9;
+		if (advanceStaggeredRun(_staggeredRuns[i]))
+		{
+			_staggeredRuns[i].action->release();
+			_staggeredRuns.erase(_staggeredRuns.begin() + i);
+		}
+		else
+		{
+			++i;
+		}
+	}
 
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(0.5, cocos2d::Vec2((visibleSize.width* rescaleFactor) -((centrePortion* rescaleFactor)/2), 0));
-	cocos2d::EaseExponentialInOut *flyInEase = cocos2d::EaseExponentialInOut::create(flyIn);
+	if (_staggeredRuns.empty())
+	{
+		stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateStaggeredRuns));
+		recycleEffectArena();
+	}
 
-	cocos2d::MoveBy *centreSlowMove = cocos2d::MoveBy::create(centreSlowTime, cocos2d::Vec2(centrePortion * rescaleFactor, 0));
-	cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(centreSlowTime/2, 1.5);
-	cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(centreSlowTime/2, 1);
-	cocos2d::Sequence *swell = cocos2d::Sequence::create(scaleUp, scaleDown, nullptr);
-	cocos2d::Spawn *centreMoveAndSwell = cocos2d::Spawn::create(centreSlowMove, swell, nullptr);
+	release();
+}
 
-	cocos2d::MoveBy *flyOut = cocos2d::MoveBy::create(0.5, cocos2d::Vec2((visibleSize.width*rescaleFactor) -((centrePortion*rescaleFactor)/2), 0));
-	cocos2d::EaseExponentialInOut *flyOutEase = cocos2d::EaseExponentialInOut::create(flyOut);
+void AnimatedLabel::startLetterAction(cocos2d::Sprite* letter, cocos2d::FiniteTimeAction* action, float lateBy)
+{
+	letter->runAction(action);
 
-	cocos2d::Sequence *flyPast = cocos2d::Sequence::create(flyInEase, centreMoveAndSwell, flyOutEase, nullptr);
+	//the first step of an interval only starts its clock, the second one catches up. It
+	//stops just short of the end, so whatever runs when the action finishes (a completion
+	//that removes the label, say) runs from the ActionManager on the next frame, not here.
+	if (lateBy > 0)
+	{
+		action->step(0);
+		action->step(std::min(lateBy, action->getDuration() * 0.999f));
+	}
+}
+
+void AnimatedLabel::queueLetterSetup(int index, float startOffset, const LetterActionBuilder& builder)
+{
+	if (_pendingLetterSetups.empty())
+	{
+		_setupElapsed = 0;
+		_setupStats = SetupStats();
+		//effects queue one setup per letter, so the arena isn't left with the smaller buffers
+		_pendingLetterSetups.reserve(getStringLength());
+	}
 
-	runActionOnAllSpritesSequentiallyReverse(flyPast, 0.7, 0, true, nullptr);
+	PendingLetterSetup setup;
+	setup.index = index;
+	setup.startTime = _setupElapsed + startOffset;
+	setup.builder = builder;
+	_pendingLetterSetups.push_back(setup);
 }
 
-void AnimatedLabel::animateInTypewriter(float duration, float initialDelay /* = 0.f */, cocos2d::CallFunc *callFuncOnEach /* = nullptr */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+void AnimatedLabel::flushLetterSetup()
 {
-	//set all the characters scale to zero
-	setAllCharsScale(0);
+	std::stable_sort(_pendingLetterSetups.begin() + _nextLetterSetup, _pendingLetterSetups.end(),
+			[](const PendingLetterSetup& a, const PendingLetterSetup& b) { return a.startTime < b.startTime; });
 
-	cocos2d::ScaleTo *appear = cocos2d::ScaleTo::create(0, 1);
-	if ( callFuncOnEach != nullptr)
+	processLetterSetup();
+
+	if (_nextLetterSetup < _pendingLetterSetups.size())
 	{
-		cocos2d::Sequence *appearAndAction = cocos2d::Sequence::create(appear, callFuncOnEach, nullptr);
-		runActionOnAllSpritesSequentially(appearAndAction, duration, initialDelay, false, callFuncOnCompletion);
+		startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateLetterSetup));
 	}
 	else
 	{
-		runActionOnAllSpritesSequentially(appear, duration, initialDelay, false, callFuncOnCompletion);
+		recycleEffectArena();
 	}
 }
 
-void AnimatedLabel::animateInFlyInFromLeft(float duration)
+void AnimatedLabel::processLetterSetup()
 {
+	const SetupClock::time_point frameStart = SetupClock::now();
+	int lettersSetUp = 0;
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
-	float offsetX = visibleSize.width * rescaleFactor;
-	offsetAllCharsPositionBy(cocos2d::Vec2(-offsetX, 0));
-
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(offsetX, 0));
-	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+	while (_nextLetterSetup < _pendingLetterSetups.size())
+	{
+		const PendingLetterSetup& setup = _pendingLetterSetups[_nextLetterSetup];
 
-	runActionOnAllSpritesSequentially(flyInEase, duration);
+		if (setup.startTime > _setupElapsed)
+			break;
 
+		if (_setupBudget > 0 && lettersSetUp > 0 && secondsSince(frameStart) >= _setupBudget)
+			break;
 
-}
+		++_nextLetterSetup;
 
-void AnimatedLabel::animateInFlyInFromRight(float duration)
-{
+		cocos2d::Sprite *charSprite = getLetter(setup.index);
+		if (charSprite == nullptr)
+			continue;
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
-	float offsetX = visibleSize.width * rescaleFactor;
-	offsetAllCharsPositionBy(cocos2d::Vec2(offsetX, 0));
+		//read before the action starts, which may queue more setups and move this one
+		const float lateBy = _setupElapsed - setup.startTime;
+		cocos2d::FiniteTimeAction *action = setup.builder(charSprite);
+		if (action != nullptr)
+			startLetterAction(charSprite, action, lateBy);
 
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(-offsetX, 0));
-	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+		++lettersSetUp;
+	}
 
-	runActionOnAllSpritesSequentiallyReverse(flyInEase, duration);
+	if (_nextLetterSetup >= _pendingLetterSetups.size())
+	{
+		_pendingLetterSetups.clear();
+		_nextLetterSetup = 0;
+	}
 
+	recordSetupTime(secondsSince(frameStart), lettersSetUp);
 }
 
-void AnimatedLabel::animateInFlyInFromTop(float duration)
+void AnimatedLabel::updateLetterSetup(float dt)
 {
+	TRACE_LABEL("updateLetterSetup");
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
-	float offsetY = visibleSize.height * rescaleFactor;
-	offsetAllCharsPositionBy(cocos2d::Vec2(0, offsetY));
+	//as in updateStaggeredRuns, a letter's setup may end up removing the label
+	retain();
 
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, -offsetY));
-	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+	_setupElapsed += dt;
 
-	runActionOnAllSpritesSequentially(flyInEase, duration);
+	processLetterSetup();
 
+	if (_pendingLetterSetups.empty())
+	{
+		stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateLetterSetup));
+		recycleEffectArena();
+	}
+
+	release();
 }
 
-void AnimatedLabel::animateInFlyInFromBottom(float duration)
+void AnimatedLabel::clearLetterSetup()
 {
+	_pendingLetterSetups.clear();
+	_nextLetterSetup = 0;
+	_setupStats.lettersPending = 0;
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
-	float offsetY = visibleSize.height * rescaleFactor;
-	offsetAllCharsPositionBy(cocos2d::Vec2(0, -offsetY));
-
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, offsetY));
-	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateLetterSetup));
+	recycleEffectArena();
+}
 
-	runActionOnAllSpritesSequentially(flyInEase, duration);
+void AnimatedLabel::recordSetupTime(float seconds, int lettersSetUp)
+{
+	if (lettersSetUp == 0)
+		return;
 
+	_setupStats.lastFrameTime = seconds;
+	_setupStats.totalTime += seconds;
+	_setupStats.frames++;
+	_setupStats.lettersSetUp += lettersSetUp;
+	_setupStats.lettersPending = (int)(_pendingLetterSetups.size() - _nextLetterSetup);
 }
 
-
-void AnimatedLabel::animateInDropFromTop(float duration)
+void AnimatedLabel::clearStaggeredRuns()
 {
+	for (auto&& run : _staggeredRuns)
+	{
+		run.action->release();
+	}
+	_staggeredRuns.clear();
 
-	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
-	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
-	float offsetY = visibleSize.height * rescaleFactor;
-	offsetAllCharsPositionBy(cocos2d::Vec2(0, offsetY));
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateStaggeredRuns));
+	recycleEffectArena();
+}
 
-	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, -offsetY));
-	cocos2d::EaseBounceOut *flyInEase = cocos2d::EaseBounceOut::create(flyIn);
+void AnimatedLabel::recycleEffectArena()
+{
+	//only once nothing is left pointing into it
+	if (!_staggeredRuns.empty() || !_pendingLetterSetups.empty() || _effectArenaHolds > 0 || _effectArena.getAllocationCount() == 0)
+		return;
 
-	runActionOnAllSpritesSequentially(flyInEase, duration);
+	//a cleared vector still holds its buffer, swap the buffers out before they go
+	EffectVector<StaggeredRun>(&_effectArena).swap(_staggeredRuns);
+	EffectVector<PendingLetterSetup>(&_effectArena).swap(_pendingLetterSetups);
+	_nextLetterSetup = 0;
 
+	_effectArena.reset();
+	++_effectArenaResets;
 }
 
-void AnimatedLabel::animateInSwell(float duration)
+AnimatedLabel::EffectArenaStats AnimatedLabel::getEffectArenaStats() const
 {
+	EffectArenaStats stats = EffectArenaStats();
+	stats.allocations = _effectArena.getAllocationCount();
+	stats.chunkAllocations = _effectArena.getChunkAllocationCount();
+	stats.resets = _effectArenaResets;
+	stats.bytesUsed = _effectArena.getBytesUsed();
+	stats.bytesReserved = _effectArena.getBytesReserved();
+	return stats;
+}
 
-	setAllCharsScale(0);
+void AnimatedLabel::flyPastAndRemove()
+{
+	TRACE_LABEL("flyPastAndRemove");
+	EffectLogScope effectLog(this, "flyPastAndRemove", {});
 
-	cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(0.2, 1.5);
-	cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(0.2, 1);
-	cocos2d::Sequence *scaleSeq = cocos2d::Sequence::create(scaleUp, scaleDown, nullptr);
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
 
-	runActionOnAllSpritesSequentially(scaleSeq, duration);
+	if (updateLOD())
+	{
+		//same path for the label as a whole, in its parent's coordinates
+		float centrePortion = visibleSize.width*0.05;
+		float centreSlowTime = 0.9;
+
+		setPosition(getPosition() - cocos2d::Vec2(visibleSize.width, 0));
+
+		cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(0.5, cocos2d::Vec2(visibleSize.width - centrePortion/2, 0));
+		cocos2d::MoveBy *centreSlowMove = cocos2d::MoveBy::create(centreSlowTime, cocos2d::Vec2(centrePortion, 0));
+		cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(centreSlowTime/2, getScale() * 1.5);
+		cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(centreSlowTime/2, getScale());
+		cocos2d::Spawn *centreMoveAndSwell = cocos2d::Spawn::create(centreSlowMove, cocos2d::Sequence::create(scaleUp, scaleDown, nullptr), nullptr);
+		cocos2d::MoveBy *flyOut = cocos2d::MoveBy::create(0.5, cocos2d::Vec2(visibleSize.width - centrePortion/2, 0));
+		cocos2d::CallFunc *remove = cocos2d::CallFunc::create(CC_CALLBACK_0(AnimatedLabel::removeFromParent, this));
 
-}
+		runAction(cocos2d::Sequence::create(cocos2d::EaseExponentialInOut::create(flyIn), centreMoveAndSwell, cocos2d::EaseExponentialInOut::create(flyOut), remove, nullptr));
+		return;
+	}
 
-void AnimatedLabel::animateInRevealFromLeft(float duration)
-{
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(-visibleSize.width * rescaleFactor, 0));
+
+	float centrePortion = visibleSize.width*0.05;
+	float centreSlowTime = 0.9;
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(0.5, cocos2d::Vec2((visibleSize.width* rescaleFactor) -((centrePortion* rescaleFactor)/2), 0));
+	cocos2d::EaseExponentialInOut *flyInEase = cocos2d::EaseExponentialInOut::create(flyIn);
+
+	cocos2d::MoveBy *centreSlowMove = cocos2d::MoveBy::create(centreSlowTime, cocos2d::Vec2(centrePortion * rescaleFactor, 0));
+	cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(centreSlowTime/2, 1.5);
+	cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(centreSlowTime/2, 1);
+	cocos2d::Sequence *swell = cocos2d::Sequence::create(scaleUp, scaleDown, nullptr);
+	cocos2d::Spawn *centreMoveAndSwell = cocos2d::Spawn::create(centreSlowMove, swell, nullptr);
+
+	cocos2d::MoveBy *flyOut = cocos2d::MoveBy::create(0.5, cocos2d::Vec2((visibleSize.width*rescaleFactor) -((centrePortion*rescaleFactor)/2), 0));
+	cocos2d::EaseExponentialInOut *flyOutEase = cocos2d::EaseExponentialInOut::create(flyOut);
+
+	cocos2d::Sequence *flyPast = cocos2d::Sequence::create(flyInEase, centreMoveAndSwell, flyOutEase, nullptr);
+
+	runEffectStaggered(flyPast, 0.7, true, 0, true, nullptr);
+}
+
+void AnimatedLabel::animateWordsJump(float duration, float height)
+{
+	TRACE_LABEL("animateWordsJump");
+	EffectLogScope effectLog(this, "animateWordsJump", { duration, height });
+
+	runGroupEffect(GlyphAnimator::GroupLevel::WORD, GlyphEffectLibrary::jump(height), getEffectStagger(false), duration);
+}
+
+void AnimatedLabel::animateInLinesFlyInFromLeft(float duration)
+{
+	TRACE_LABEL("animateInLinesFlyInFromLeft");
+	EffectLogScope effectLog(this, "animateInLinesFlyInFromLeft", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale();
+	float offsetX = visibleSize.width * rescaleFactor;
+
+	runGroupEffect(GlyphAnimator::GroupLevel::LINE, GlyphEffectLibrary::flyIn(-offsetX, 0), GlyphStagger::perLine(), duration);
+}
+
+void AnimatedLabel::animateInTypewriter(float duration, float initialDelay /* = 0.f */, cocos2d::CallFunc *callFuncOnEach /* = nullptr */, cocos2d::CallFunc *callFuncOnCompletion /* = nullptr */)
+{
+	TRACE_LABEL("animateInTypewriter");
+	EffectLogScope effectLog(this, "animateInTypewriter", { duration, initialDelay });
+
+	if (callFuncOnEach == nullptr && useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::typewriter(), getEffectStagger(false), duration, initialDelay);
+
+		if (callFuncOnCompletion != nullptr)
+			this->runAction(cocos2d::Sequence::create(cocos2d::DelayTime::create(initialDelay + duration), callFuncOnCompletion, nullptr));
+		return;
+	}
+
+	//set all the characters scale to zero
+	setAllCharsScale(0);
+
+	cocos2d::ScaleTo *appear = cocos2d::ScaleTo::create(0, 1);
+	if ( callFuncOnEach != nullptr)
+	{
+		cocos2d::Sequence *appearAndAction = cocos2d::Sequence::create(appear, callFuncOnEach, nullptr);
+		runEffectStaggered(appearAndAction, duration, false, initialDelay, false, callFuncOnCompletion);
+	}
+	else
+	{
+		runEffectStaggered(appear, duration, false, initialDelay, false, callFuncOnCompletion);
+	}
+}
+
+void AnimatedLabel::animateInFlyInFromLeft(float duration)
+{
+	TRACE_LABEL("animateInFlyInFromLeft");
+	EffectLogScope effectLog(this, "animateInFlyInFromLeft", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	float offsetX = visibleSize.width * rescaleFactor;
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::flyIn(-offsetX, 0), getEffectStagger(false), duration);
+		return;
+	}
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(-offsetX, 0));
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(offsetX, 0));
+	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+
+	runEffectStaggered(flyInEase, duration, false);
+
+
+}
+
+void AnimatedLabel::animateInFlyInFromRight(float duration)
+{
+	TRACE_LABEL("animateInFlyInFromRight");
+	EffectLogScope effectLog(this, "animateInFlyInFromRight", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	float offsetX = visibleSize.width * rescaleFactor;
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::flyIn(offsetX, 0), getEffectStagger(true), duration);
+		return;
+	}
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(offsetX, 0));
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(-offsetX, 0));
+	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+
+	runEffectStaggered(flyInEase, duration, true);
+
+}
+
+void AnimatedLabel::animateInFlyInFromTop(float duration)
+{
+	TRACE_LABEL("animateInFlyInFromTop");
+	EffectLogScope effectLog(this, "animateInFlyInFromTop", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	float offsetY = visibleSize.height * rescaleFactor;
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::flyIn(0, offsetY), getEffectStagger(false), duration);
+		return;
+	}
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(0, offsetY));
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, -offsetY));
+	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+
+	runEffectStaggered(flyInEase, duration, false);
+
+}
+
+void AnimatedLabel::animateInFlyInFromBottom(float duration)
+{
+	TRACE_LABEL("animateInFlyInFromBottom");
+	EffectLogScope effectLog(this, "animateInFlyInFromBottom", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	float offsetY = visibleSize.height * rescaleFactor;
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::flyIn(0, -offsetY), getEffectStagger(false), duration);
+		return;
+	}
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(0, -offsetY));
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, offsetY));
+	cocos2d::EaseExponentialOut *flyInEase = cocos2d::EaseExponentialOut::create(flyIn);
+
+	runEffectStaggered(flyInEase, duration, false);
+
+}
+
+
+void AnimatedLabel::animateInDropFromTop(float duration)
+{
+	TRACE_LABEL("animateInDropFromTop");
+	EffectLogScope effectLog(this, "animateInDropFromTop", { duration });
+
+	cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+	float rescaleFactor = 1/getScale(); //if the label has been scaled down, all the action coordinates will be too small, rescale factor scales them up
+	float offsetY = visibleSize.height * rescaleFactor;
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::dropFromTop(offsetY), getEffectStagger(false), duration);
+		return;
+	}
+
+	offsetAllCharsPositionBy(cocos2d::Vec2(0, offsetY));
+
+	cocos2d::MoveBy *flyIn = cocos2d::MoveBy::create(1, cocos2d::Vec2(0, -offsetY));
+	cocos2d::EaseBounceOut *flyInEase = cocos2d::EaseBounceOut::create(flyIn);
+
+	runEffectStaggered(flyInEase, duration, false);
+
+}
+
+void AnimatedLabel::animateInSwell(float duration)
+{
+	TRACE_LABEL("animateInSwell");
+	EffectLogScope effectLog(this, "animateInSwell", { duration });
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::inSwell(), getEffectStagger(false), duration);
+		return;
+	}
+
+
+	setAllCharsScale(0);
+
+	cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(0.2, 1.5);
+	cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(0.2, 1);
+	cocos2d::Sequence *scaleSeq = cocos2d::Sequence::create(scaleUp, scaleDown, nullptr);
+
+	runEffectStaggered(scaleSeq, duration, false);
+
+}
+
+void AnimatedLabel::animateInRevealFromLeft(float duration)
+{
+	TRACE_LABEL("animateInRevealFromLeft");
+	EffectLogScope effectLog(this, "animateInRevealFromLeft", { duration });
+
+	if (updateLOD())
+	{
+		setOpacity(0);
+		runAction(cocos2d::EaseExponentialOut::create(cocos2d::FadeIn::create(duration)));
+		return;
+	}
 
 	//set all chars opacity to zero, apart from first
 	setAllCharsOpacity(0);
@@ -498,76 +1039,125 @@ void AnimatedLabel::animateInRevealFromLeft(float duration)
 
 void AnimatedLabel::animateSwell(float duration)
 {
+	TRACE_LABEL("animateSwell");
+	EffectLogScope effectLog(this, "animateSwell", { duration });
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::swell(), getEffectStagger(false), duration);
+		return;
+	}
+
 
 	cocos2d::ScaleTo *scaleUp = cocos2d::ScaleTo::create(0.2, 1.5);
 	cocos2d::ScaleTo *scaleDown = cocos2d::ScaleTo::create(0.2, 1);
 	cocos2d::Sequence *scaleSeq = cocos2d::Sequence::create(scaleUp, scaleDown, nullptr);
 
-	runActionOnAllSpritesSequentially(scaleSeq, duration);
+	runEffectStaggered(scaleSeq, duration, false);
 
 }
 
 void AnimatedLabel::animateJump(float duration, float height)
 {
+	TRACE_LABEL("animateJump");
+	EffectLogScope effectLog(this, "animateJump", { duration, height });
 
-	for (int i = 0, numChars = getStringLength(); i < numChars; ++i)
+	if (useGlyphEffect())
 	{
-		cocos2d::Sprite *charSprite = getLetter(i);
-
-		cocos2d::DelayTime *delay = cocos2d::DelayTime::create((duration/(numChars-1)) *i);
-		cocos2d::JumpTo *jump = cocos2d::JumpTo::create(0.5, charSprite->getPosition(), height, 1);
-		cocos2d::Sequence *delayThenJump = cocos2d::Sequence::create(delay, jump, nullptr);
-		charSprite->runAction(delayThenJump);
+		//retriggered mid jump, the letters fall back from where they are on their springs
+		//while the new jump starts, instead of snapping to the ground
+		handOverToSprings();
+		startGlyphEffect(GlyphEffectLibrary::jump(height), getEffectStagger(false), duration);
+		return;
 	}
 
+
+	//jumping by zero lands every letter back where it started, so one action can be shared
+	cocos2d::JumpBy *jump = cocos2d::JumpBy::create(0.5, cocos2d::Vec2::ZERO, height, 1);
+
+	runEffectStaggered(jump, duration, false);
+
 }
 
 void AnimatedLabel::animateStretchElastic(float stretchDuration, float releaseDuration, float stretchAmount)
 {
+	TRACE_LABEL("animateStretchElastic");
+	EffectLogScope effectLog(this, "animateStretchElastic", { stretchDuration, releaseDuration, stretchAmount });
+
+	if (useGlyphEffect())
+	{
+		handOverToSprings();
+		startGlyphEffect(GlyphEffectLibrary::stretchElastic(stretchDuration, releaseDuration, stretchAmount, getContentSize().width), GlyphStagger::linear(), 0);
+		return;
+	}
+
+
+	const float quarterWidth = getContentSize().width/4;
 
 	for (int i = 0, numChars = getStringLength(); i < numChars; ++i)
 	{
 
-		cocos2d::Sprite *charSprite = getLetter(i);
+		queueLetterSetup(i, 0, [=](cocos2d::Sprite *charSprite) -> cocos2d::FiniteTimeAction* {
 
-		cocos2d::MoveTo *stretch = cocos2d::MoveTo::create(stretchDuration,
-				cocos2d::Vec2((charSprite->getPosition().x - (getContentSize().width/4)) * stretchAmount,
-					charSprite->getPosition().y));
-		cocos2d::MoveTo *release = cocos2d::MoveTo::create(releaseDuration, charSprite->getPosition());
-		cocos2d::EaseElasticOut *releaseElastic = cocos2d::EaseElasticOut::create(release);
-		cocos2d::Sequence *animation = cocos2d::Sequence::create(stretch, releaseElastic, nullptr);
+			cocos2d::MoveTo *stretch = cocos2d::MoveTo::create(stretchDuration,
+					cocos2d::Vec2((charSprite->getPosition().x - quarterWidth) * stretchAmount,
+						charSprite->getPosition().y));
+			cocos2d::MoveTo *release = cocos2d::MoveTo::create(releaseDuration, charSprite->getPosition());
+			cocos2d::EaseElasticOut *releaseElastic = cocos2d::EaseElasticOut::create(release);
+			return cocos2d::Sequence::create(stretch, releaseElastic, nullptr);
 
-		charSprite->runAction(animation);
+		});
 
 	}
 
+	flushLetterSetup();
+
 }
 
 void AnimatedLabel::animateInSpin(float duration, int spins)
 {
+	TRACE_LABEL("animateInSpin");
+	EffectLogScope effectLog(this, "animateInSpin", { duration, (double)spins });
+
+	if (useGlyphEffect())
+	{
+		//as a single node the label spin and the letters' counter spin cancel out
+		if (!_lodCollapsed)
+		{
+			cocos2d::RotateBy *spin = cocos2d::RotateBy::create(duration, 360 * spins);
+			this->runAction(cocos2d::EaseSineOut::create(spin));
+		}
+
+		startGlyphEffect(GlyphEffectLibrary::inSpin(duration, spins, getContentSize().width, !_lodCollapsed), GlyphStagger::linear(), 0);
+		return;
+	}
+
 
 	setAllCharsOpacity(0);
 
+	const float centreX = this->getContentSize().width/2;
+
 	for (int i = 0, numChars = getStringLength(); i < numChars; ++i)
 	{
 
-		cocos2d::Sprite *charSprite = getLetter(i);
+		queueLetterSetup(i, 0, [=](cocos2d::Sprite *charSprite) -> cocos2d::FiniteTimeAction* {
 
-		cocos2d::MoveTo *moveToPosition = cocos2d::MoveTo::create(duration, charSprite->getPosition());
-		cocos2d::EaseExponentialOut *moveToPositionEase = cocos2d::EaseExponentialOut::create(moveToPosition);
-		float centreX = this->getContentSize().width/2;
-		charSprite->setPosition(cocos2d::Vec2(centreX, charSprite->getPosition().y));
-		charSprite->runAction(moveToPositionEase);
+			cocos2d::MoveTo *moveToPosition = cocos2d::MoveTo::create(duration, charSprite->getPosition());
+			cocos2d::EaseExponentialOut *moveToPositionEase = cocos2d::EaseExponentialOut::create(moveToPosition);
+			charSprite->setPosition(cocos2d::Vec2(centreX, charSprite->getPosition().y));
 
-		cocos2d::RotateBy *counterRotate = cocos2d::RotateBy::create(duration, -360 * spins);
-		cocos2d::EaseSineOut *counterRotateEase = cocos2d::EaseSineOut::create(counterRotate);
-		charSprite->runAction(counterRotateEase);
+			cocos2d::RotateBy *counterRotate = cocos2d::RotateBy::create(duration, -360 * spins);
+			cocos2d::EaseSineOut *counterRotateEase = cocos2d::EaseSineOut::create(counterRotate);
 
-		cocos2d::FadeIn *fadeIn = cocos2d::FadeIn::create(duration);
-		charSprite->runAction(fadeIn);
+			cocos2d::FadeIn *fadeIn = cocos2d::FadeIn::create(duration);
+
+			return cocos2d::Spawn::create(moveToPositionEase, counterRotateEase, fadeIn, nullptr);
+
+		});
 
 	}
 
+	flushLetterSetup();
 
 	//spin the label
 	cocos2d::RotateBy *spin = cocos2d::RotateBy::create(duration, 360 * spins);
@@ -577,15 +1167,108 @@ void AnimatedLabel::animateInSpin(float duration, int spins)
 
 }
 
+//PATHS
+
+//Moves a letter sprite by scale * (the path's point at the eased time minus its first
+//point), so it sets off from wherever it is. One action per letter instead of a
+//sequence of eased moves for every stretch of the curve.
+class PathMove : public cocos2d::ActionInterval
+{
+	public:
+
+		static PathMove* create(float duration, const std::shared_ptr<const GlyphPath>& path, float scale, GlyphEffect::Ease ease)
+		{
+			PathMove *ret = new (std::nothrow) PathMove();
+
+			if (ret && ret->initWithDuration(duration))
+			{
+				ret->_path = path;
+				ret->_scale = scale;
+				ret->_ease = ease;
+				ret->autorelease();
+				return ret;
+			}
+
+			delete ret;
+			return nullptr;
+		}
+
+		virtual PathMove* clone() const override
+		{
+			PathMove *ret = create(_duration, _path, _scale, _ease);
+			if (ret)
+				ret->_reversed = _reversed;
+			return ret;
+		}
+
+		//back along the path from its end to its start
+		virtual PathMove* reverse() const override
+		{
+			PathMove *ret = clone();
+			if (ret)
+				ret->_reversed = !_reversed;
+			return ret;
+		}
+
+		virtual void startWithTarget(cocos2d::Node *target) override
+		{
+			cocos2d::ActionInterval::startWithTarget(target);
+			_startPosition = target->getPosition();
+			_origin = _path->getPoint(_reversed ? 1.f : 0.f);
+		}
+
+		virtual void update(float time) override
+		{
+			if (_target == nullptr)
+				return;
+
+			const GlyphPath::Point point = _path->getPoint(GlyphEffect::ease(_ease, _reversed ? 1 - time : time));
+			_target->setPosition(_startPosition.x + (point.x - _origin.x) * _scale, _startPosition.y + (point.y - _origin.y) * _scale);
+		}
+
+	private:
+
+		std::shared_ptr<const GlyphPath> _path;
+		float _scale = 1.f;
+		GlyphEffect::Ease _ease = GlyphEffect::Ease::LINEAR;
+		bool _reversed = false;
+		cocos2d::Vec2 _startPosition;
+		GlyphPath::Point _origin;
+};
+
+void AnimatedLabel::animateInAlongPath(const GlyphPath& path, float pathDuration, float staggerDuration, GlyphEffect::Ease ease /* = GlyphEffect::Ease::SINE_OUT */)
+{
+	TRACE_LABEL("animateInAlongPath");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "animateInAlongPath");
+
+	if (useGlyphEffect())
+	{
+		startGlyphEffect(GlyphEffectLibrary::alongPath(path, pathDuration, ease), getEffectStagger(false), staggerDuration);
+		return;
+	}
+
+	//every letter waits at the start of the path, which ends where it rests
+	const GlyphPath::Point start = path.getPoint(0);
+	const GlyphPath::Point end = path.getPoint(1);
+	offsetAllCharsPositionBy(cocos2d::Vec2(start.x - end.x, start.y - end.y));
+
+	runEffectStaggered(PathMove::create(pathDuration, std::make_shared<GlyphPath>(path), 1.f, ease), staggerDuration, false);
+}
+
 void AnimatedLabel::animateInVortex(float duration, int spins, bool removeOnCompletion /* = false */, bool createGhosts /* = true */)
 {
+	TRACE_LABEL("animateInVortex");
+	EffectLogScope effectLog(this, "animateInVortex", { duration, (double)spins, removeOnCompletion ? 1. : 0., createGhosts ? 1. : 0. });
 
 	//fade in the label
 	float fadeDuration = duration * 0.25;
 	cocos2d::FadeIn *fadeIn = cocos2d::FadeIn::create(fadeDuration);
 	this->runAction(fadeIn);
 
-	if (createGhosts)
+	//as a single node only the fade is left
+	const bool collapsed = updateLOD();
+
+	if (createGhosts && !collapsed)
 	{
 		int numGhosts = 3;
 		float ghostMaxOpacity = 100;
@@ -598,112 +1281,70 @@ void AnimatedLabel::animateInVortex(float duration, int spins, bool removeOnComp
 			// AnimatedLabel *ghostLabel = AnimatedLabel::create(getString(), getBMFontFilePath(), getContentSize().width*2, cocos2d::kCCTextAlignmentCenter);
 			ghostLabel->setOpacity(ghostMaxOpacity/(i+1));
 			ghostLabel->setPosition(this->getPosition());
+			ghostLabel->setSetupBudget(_setupBudget);
+			ghostLabel->setSharedAtlas(_sharedAtlas);
+			ghostLabel->setCompactAnimation(_compactAnimation);
+			ghostLabel->setRandomSeed(_random.next());
 			this->getParent()->addChild(ghostLabel);
+			if (_choreographer != nullptr)
+			{
+				_choreographer->addLabel(ghostLabel, _choreographer->getLabelGroup(this));
+			}
 			ghostLabel->animateInVortex(duration, spins, true, false);
 
 		}
 	}
 
-	for (int i = 0, numChars = getStringLength(); i < numChars; ++i)
+	if (!collapsed && _compactAnimation)
 	{
-
-		//Alter the number of spins on some characters for variation
-		int charSpins = spins;
-		if (i % 2 == 0)
-		{
-			charSpins--;
-		}
-		else if (i % 3 == 0)
+		//the same letters as the sprite vortex spin a turn less or more. Letter speeds vary
+		//through their start times instead of their durations.
+		std::vector<unsigned char> variants;
+		GlyphEffectLibrary::vortexVariants(getStringLength(), variants);
+		startGlyphEffect(GlyphEffectLibrary::vortex(duration, spins, getContentSize().width), GlyphStagger::random(_random.next()), 0.9, 0.f, variants);
+	}
+	else if (!collapsed)
+	{
+		//letters spin one turn less, as many or one more, on three paths shared by all of them
+		const std::shared_ptr<const GlyphPath> paths[3] = {
+			std::make_shared<GlyphPath>(GlyphPath::circle(1, 0, spins - 1)),
+			std::make_shared<GlyphPath>(GlyphPath::circle(1, 0, spins)),
+			std::make_shared<GlyphPath>(GlyphPath::circle(1, 0, spins + 1))
+		};
+		const float centreX = getContentSize().width/2;
+
+		for (int i = 0, numChars = getStringLength(); i < numChars; ++i)
 		{
-			charSpins++;
-		}
-
-		//randomly vary the speed of letters
-		float staggerAmount = (cocos2d::random() % 10)/10.0f;
-		float letterDuration = duration + staggerAmount;
 
-		float spinDuration = letterDuration/charSpins;
-
-		cocos2d::Sprite *charSprite = getLetter(i);
-
-		float radius = fabs((this->getContentSize().width/2) - charSprite->getPosition().x);
-		float squareLength = sqrtf((radius*radius)/2);
-		float arcAmount = radius - squareLength;
-
-		float segmentDuration = spinDuration*0.25;
-
-		cocos2d::Vector<cocos2d::FiniteTimeAction*> spinActions;
-
-		for (int s = 0; s < charSpins; s++)
-		{
-
-			/*
-			   Spin in a circular motion. Circle is split into 4 segments.
-			   Segment 1 is the NW arc of the circle
-			   Segment 2 is the NE arc of the circle
-			   Segment 3 is the SW arc of the circle
-			   Segment 4 is the SE arc of the circle
-			   */
-
-			//segment 4
-			cocos2d::MoveBy *segment4Straight = cocos2d::MoveBy::create(segmentDuration, cocos2d::Vec2(-radius, -radius));
-			cocos2d::MoveBy *segment4PositiveArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(arcAmount, -arcAmount));
-			cocos2d::EaseSineOut *segment4PositiveArcEase = cocos2d::EaseSineOut::create(segment4PositiveArc);
-			cocos2d::MoveBy *segment4NegativeArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(-arcAmount, arcAmount));
-			cocos2d::EaseSineIn *segment4NegativeArcEase = cocos2d::EaseSineIn::create(segment4NegativeArc);
-			cocos2d::Sequence *segment4Arc = cocos2d::Sequence::create(segment4PositiveArcEase, segment4NegativeArcEase, nullptr);
-			cocos2d::Spawn *segment4Action = cocos2d::Spawn::create(segment4Straight, segment4Arc, nullptr);
-
-			//segment 3
-			cocos2d::MoveBy *segment3Straight = cocos2d::MoveBy::create(segmentDuration, cocos2d::Vec2(-radius, radius));
-			cocos2d::MoveBy *segment3PositiveArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(-arcAmount, -arcAmount));
-			cocos2d::EaseSineOut *segment3PositiveArcEase = cocos2d::EaseSineOut::create(segment3PositiveArc);
-			cocos2d::MoveBy *segment3NegativeArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(arcAmount, arcAmount));
-			cocos2d::EaseSineIn *segment3NegativeArcEase = cocos2d::EaseSineIn::create(segment3NegativeArc);
-			cocos2d::Sequence *segment3Arc = cocos2d::Sequence::create(segment3PositiveArcEase, segment3NegativeArcEase, nullptr);
-			cocos2d::Spawn *segment3Action = cocos2d::Spawn::create(segment3Straight, segment3Arc, nullptr);
-
-			//segment 1
-			cocos2d::MoveBy *segment1Straight = cocos2d::MoveBy::create(segmentDuration, cocos2d::Vec2(radius, radius));
-			cocos2d::MoveBy *segment1PositiveArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(-arcAmount, arcAmount));
-			cocos2d::EaseSineOut *segment1PositiveArcEase = cocos2d::EaseSineOut::create(segment1PositiveArc);
-			cocos2d::MoveBy *segment1NegativeArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(arcAmount, -arcAmount));
-			cocos2d::EaseSineIn *segment1NegativeArcEase = cocos2d::EaseSineIn::create(segment1NegativeArc);
-			cocos2d::Sequence *segment1Arc = cocos2d::Sequence::create(segment1PositiveArcEase, segment1NegativeArcEase, nullptr);
-			cocos2d::Spawn *segment1Action = cocos2d::Spawn::create(segment1Straight, segment1Arc, nullptr);
-
-			//segment 2
-			cocos2d::MoveBy *segment2Straight = cocos2d::MoveBy::create(segmentDuration, cocos2d::Vec2(radius, -radius));
-			cocos2d::MoveBy *segment2PositiveArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(arcAmount, arcAmount));
-			cocos2d::EaseSineOut *segment2PositiveArcEase = cocos2d::EaseSineOut::create(segment2PositiveArc);
-			cocos2d::MoveBy *segment2NegativeArc = cocos2d::MoveBy::create(segmentDuration/2, cocos2d::Vec2(-arcAmount, -arcAmount));
-			cocos2d::EaseSineIn *segment2NegativeArcEase = cocos2d::EaseSineIn::create(segment2NegativeArc);
-			cocos2d::Sequence *segment2Arc = cocos2d::Sequence::create(segment2PositiveArcEase, segment2NegativeArcEase, nullptr);
-			cocos2d::Spawn *segment2Action = cocos2d::Spawn::create(segment2Straight, segment2Arc, nullptr);
-
-			cocos2d::Sequence *spinAction;
-
-			//Depending on if the letter is to the left or right of the centre of the label, the segments will need to be in different orders:
-
-			if ((this->getContentSize().width/2) < charSprite->getPosition().x)
+			//Alter the number of spins on some characters for variation
+			int charSpins = spins;
+			if (i % 2 == 0)
 			{
-				spinAction = cocos2d::Sequence::create(segment4Action, segment3Action, segment1Action, segment2Action, nullptr);
+				charSpins--;
 			}
-			else
+			else if (i % 3 == 0)
 			{
-				spinAction = cocos2d::Sequence::create(segment1Action, segment2Action, segment4Action, segment3Action, nullptr);
+				charSpins++;
 			}
 
+			//randomly vary the speed of letters
+			float staggerAmount = _random.nextInt(0, 9)/10.0f;
+			float letterDuration = duration + staggerAmount;
 
-			spinActions.pushBack(spinAction);
+			const std::shared_ptr<const GlyphPath> path = paths[charSpins - spins + 1];
 
+			queueLetterSetup(i, 0, [=](cocos2d::Sprite *charSprite) -> cocos2d::FiniteTimeAction* {
 
-		}
+				if (charSpins <= 0)
+					return nullptr;
 
-		cocos2d::Sequence *animation = cocos2d::Sequence::create(spinActions);
-		cocos2d::EaseSineOut *animationEase = cocos2d::EaseSineOut::create(animation);
+				//a clockwise circle through the letter around the centre of the label: letters
+				//right of the centre set off downwards and letters left of it upwards
+				return PathMove::create(letterDuration, path, charSprite->getPosition().x - centreX, GlyphEffect::Ease::SINE_OUT);
+			});
+		}
 
-		charSprite->runAction(animationEase);
+		flushLetterSetup();
 	}
 
 	if (removeOnCompletion)
@@ -719,6 +1360,9 @@ void AnimatedLabel::animateInVortex(float duration, int spins, bool removeOnComp
 
 void AnimatedLabel::animateRainbow(float duration)
 {
+	TRACE_LABEL("animateRainbow");
+	EffectLogScope effectLog(this, "animateRainbow", { duration });
+
 	const float tintDuration = 0.2;
 
 	cocos2d::TintTo *red = cocos2d::TintTo::create(tintDuration, 255, 0, 0);
@@ -731,5 +1375,2603 @@ void AnimatedLabel::animateRainbow(float duration)
 	cocos2d::TintTo *white = cocos2d::TintTo::create(tintDuration, 255, 255, 255);
 
 	cocos2d::Sequence *rainbow = cocos2d::Sequence::create(red, orange, yellow, green, blue, purple, pink, white, nullptr);
-	runActionOnAllSpritesSequentially(rainbow, duration);
+
+	if (updateLOD())
+	{
+		//tint the whole label while the middle letter would have been
+		runAction(cocos2d::Sequence::create(cocos2d::DelayTime::create(duration/2), rainbow, nullptr));
+		return;
+	}
+
+	runEffectStaggered(rainbow, duration, false);
+}
+
+//PER-VERTEX COLOUR ANIMATIONS
+
+static const int kColorLookupSize = 256;
+
+//Resamples a cyclic palette (the last colour blends back into the first) into a
+//fixed size table so a frame only needs one lookup per vertex.
+static void buildColorLookup(const std::vector<cocos2d::Color4B>& palette, std::vector<cocos2d::Color4B>& lookup)
+{
+	lookup.resize(kColorLookupSize);
+
+	const int numColors = (int)palette.size();
+
+	for (int i = 0; i < kColorLookupSize; ++i)
+	{
+		float position = ((float)i / kColorLookupSize) * numColors;
+		int from = (int)position % numColors;
+		int to = (from + 1) % numColors;
+		float t = position - floorf(position);
+
+		const cocos2d::Color4B& a = palette[from];
+		const cocos2d::Color4B& b = palette[to];
+		lookup[i] = cocos2d::Color4B(a.r + (b.r - a.r) * t,
+				a.g + (b.g - a.g) * t,
+				a.b + (b.b - a.b) * t,
+				a.a + (b.a - a.a) * t);
+	}
+}
+
+static inline const cocos2d::Color4B& sampleColorLookup(const std::vector<cocos2d::Color4B>& lookup, float phase)
+{
+	return lookup[(int)((phase - floorf(phase)) * kColorLookupSize) & (kColorLookupSize - 1)];
+}
+
+//Multiplies the animated colour with the colour the label (or the letter sprite) would
+//have drawn the vertex with, honouring premultiplied alpha the same way Label::updateColor does.
+static inline cocos2d::Color4B modulateColor(const cocos2d::Color4B& color, const cocos2d::Color3B& base, GLubyte opacity, bool opacityModifyRGB)
+{
+	float alpha = (color.a / 255.f) * (opacity / 255.f);
+	float rgbScale = opacityModifyRGB ? alpha : 1.f;
+
+	return cocos2d::Color4B(base.r * (color.r / 255.f) * rgbScale,
+			base.g * (color.g / 255.f) * rgbScale,
+			base.b * (color.b / 255.f) * rgbScale,
+			alpha * 255);
+}
+
+void AnimatedLabel::animateColorsRainbow(float cycleDuration, float spread /* = 1.f */, bool perCorner /* = false */, float duration /* = 0.f */)
+{
+	TRACE_LABEL("animateColorsRainbow");
+	EffectLogScope effectLog(this, "animateColorsRainbow", { cycleDuration, spread, perCorner ? 1. : 0., duration });
+
+	//same colours animateRainbow tints through
+	std::vector<cocos2d::Color4B> rainbow;
+	rainbow.push_back(cocos2d::Color4B(255, 0, 0, 255));
+	rainbow.push_back(cocos2d::Color4B(255, 153, 51, 255));
+	rainbow.push_back(cocos2d::Color4B(255, 255, 0, 255));
+	rainbow.push_back(cocos2d::Color4B(0, 255, 0, 255));
+	rainbow.push_back(cocos2d::Color4B(0, 0, 255, 255));
+	rainbow.push_back(cocos2d::Color4B(102, 0, 204, 255));
+	rainbow.push_back(cocos2d::Color4B(255, 51, 255, 255));
+
+	animateColorsGradient(rainbow, cycleDuration, spread, 0.f, perCorner, duration);
+}
+
+void AnimatedLabel::animateColorsGradient(const std::vector<cocos2d::Color4B>& palette, float cycleDuration, float spreadX /* = 1.f */, float spreadY /* = 0.f */, bool perCorner /* = false */, float duration /* = 0.f */)
+{
+	TRACE_LABEL("animateColorsGradient");
+
+	//the palette follows the other arguments, four channels a colour
+	std::vector<double> logArgs;
+	if (isEffectLogRunning())
+	{
+		logArgs = { cycleDuration, spreadX, spreadY, perCorner ? 1. : 0., duration };
+		for (auto&& color : palette)
+		{
+			logArgs.insert(logArgs.end(), { (double)color.r, (double)color.g, (double)color.b, (double)color.a });
+		}
+	}
+	EffectLogScope effectLog(this, "animateColorsGradient", logArgs);
+
+	if (palette.empty())
+	{
+		cocos2d::log("AnimatedLabel::animateColorsGradient - palette is empty");
+		return;
+	}
+
+	buildColorLookup(palette, _colorLookup);
+	_colorFunction = nullptr;
+	_colorCycleDuration = cycleDuration;
+	_colorSpreadX = spreadX;
+	_colorSpreadY = spreadY;
+	_colorPerCorner = perCorner;
+
+	startColorAnimation(duration);
+}
+
+void AnimatedLabel::animateColors(const ColorFunction& colorFunction, float duration /* = 0.f */)
+{
+	TRACE_LABEL("animateColors");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "animateColors");
+
+	if (!colorFunction)
+	{
+		cocos2d::log("AnimatedLabel::animateColors - colorFunction is empty");
+		return;
+	}
+
+	_colorFunction = colorFunction;
+
+	startColorAnimation(duration);
+}
+
+void AnimatedLabel::startColorAnimation(float duration)
+{
+	_colorAnimationElapsed = 0.f;
+	_colorAnimationDuration = duration;
+
+	if (!_colorAnimationRunning)
+	{
+		_colorAnimationRunning = true;
+		startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateColorAnimation));
+	}
+}
+
+void AnimatedLabel::stopColorAnimation()
+{
+	if (!_colorAnimationRunning)
+		return;
+
+	_colorAnimationRunning = false;
+	_colorFunction = nullptr;
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateColorAnimation));
+
+	//put back the colours the label and its letter sprites would normally draw with
+	updateColor();
+	for (auto&& letter : _letters)
+	{
+		letter.second->setColor(letter.second->getColor());
+	}
+}
+
+void AnimatedLabel::updateColorAnimation(float dt)
+{
+	TRACE_LABEL("updateColorAnimation");
+
+	_colorAnimationElapsed += dt;
+
+	if (_colorAnimationDuration > 0 && _colorAnimationElapsed >= _colorAnimationDuration)
+	{
+		stopColorAnimation();
+	}
+}
+
+void AnimatedLabel::draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags)
+{
+	if (_sharedAtlas != nullptr && drawFromSharedAtlas(renderer, transform, flags))
+		return;
+
+	cocos2d::Label::draw(renderer, transform, flags);
+	countDraw();
+
+	//letter sprites rewrite their whole quad when they are dirty, so the vertices and
+	//colours are written afterwards. The render commands only read the quads once the
+	//frame is rendered, so they still pick these up.
+	if (_glyphAnimator.isRunning() || _springs.isAwake())
+	{
+		applyCompactAnimation(false);
+	}
+
+	if (_colorAnimationRunning)
+	{
+		applyColorAnimation();
+	}
+}
+
+//HIT TESTING
+
+AnimatedLabel::GlyphHit AnimatedLabel::hitTestGlyph(const cocos2d::Vec2& point)
+{
+	refreshHitGrid();
+
+	GlyphHit hit = { -1, -1, -1 };
+
+	const int index = _hitGrid.hitTest(point.x, point.y);
+	if (index >= 0 && index < (int)_hitGlyphs.size())
+	{
+		hit.index = index;
+		hit.word = _hitGlyphs[index].word;
+		hit.line = _hitGlyphs[index].line;
+	}
+
+	return hit;
+}
+
+size_t AnimatedLabel::getHitGridLayoutKey() const
+{
+	//changes to the text go through setString and visit, this catches the layout
+	//changing under them (alignment, dimensions, font) when something else laid it out
+	size_t key = (size_t)_fontAtlas ^ ((size_t)_lengthOfString << 1);
+	const std::hash<float> hashFloat;
+	key = key * 31 + hashFloat(_contentSize.width);
+	key = key * 31 + hashFloat(_contentSize.height);
+	for (auto&& offsetX : _linesOffsetX)
+	{
+		key = key * 31 + hashFloat(offsetX);
+	}
+
+	return key;
+}
+
+void AnimatedLabel::refreshHitGrid()
+{
+	layoutIfDirty();
+
+	const size_t layoutKey = getHitGridLayoutKey();
+	if (layoutKey != _hitGridLayout)
+	{
+		_hitGridDirty = true;
+	}
+
+	//one more refresh after the letters stop, to pick up where they came to rest
+	const bool moving = isAnimatingLetters() || !_letters.empty();
+	if (!_hitGridDirty && !moving && !_hitGridMoving)
+		return;
+
+	const unsigned int frame = cocos2d::Director::getInstance()->getTotalFrames();
+	if (!_hitGridDirty && frame == _hitGridFrame)
+		return;
+
+	TRACE_LABEL("refreshHitGrid");
+
+	_hitGridFrame = frame;
+	_hitGridMoving = moving;
+
+	if (_hitGridDirty)
+	{
+		collectStaggerGlyphs(_hitGlyphs);
+		_hitGrid.reset((int)_hitGlyphs.size(), getLineHeight());
+		_hitGridLayout = layoutKey;
+		_hitGridDirty = false;
+	}
+
+	float corners[8];
+	const std::vector<int>& pages = getLetterPages();
+
+	for (int i = 0, numGlyphs = std::min(_hitGrid.getGlyphCount(), (int)pages.size()); i < numGlyphs; ++i)
+	{
+		GlyphLayout layout;
+		layout.page = pages[i];
+		layout.atlasIndex = _lettersInfo[i].valid ? _lettersInfo[i].atlasIndex : -1;
+
+		const cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(layout);
+		if (quad == nullptr)
+		{
+			_hitGrid.removeGlyph(i);
+			continue;
+		}
+
+		corners[0] = quad->bl.vertices.x; corners[1] = quad->bl.vertices.y;
+		corners[2] = quad->br.vertices.x; corners[3] = quad->br.vertices.y;
+		corners[4] = quad->tl.vertices.x; corners[5] = quad->tl.vertices.y;
+		corners[6] = quad->tr.vertices.x; corners[7] = quad->tr.vertices.y;
+		_hitGrid.setGlyph(i, corners);
+	}
+}
+
+//SHARED ATLAS
+
+void AnimatedLabel::setSharedAtlas(AnimatedLabelAtlas* atlas)
+{
+	CC_SAFE_RETAIN(atlas);
+	CC_SAFE_RELEASE(_sharedAtlas);
+	_sharedAtlas = atlas;
+
+	if (_sharedAtlas == nullptr)
+	{
+		std::vector<AnimatedLabelAtlas::Glyph>().swap(_sharedGlyphs);
+		std::vector<std::vector<cocos2d::V3F_C4B_T2F_Quad>>().swap(_sharedQuads);
+		_sharedCommands.clear();
+	}
+}
+
+bool AnimatedLabel::drawFromSharedAtlas(cocos2d::Renderer* renderer, const cocos2d::Mat4& transform, uint32_t flags)
+{
+	TRACE_LABEL("drawFromSharedAtlas");
+
+	//the effects need their own shaders
+	if (_shadowEnabled || _useDistanceField || _currLabelEffect != cocos2d::LabelEffect::NORMAL || _currentLabelType == LabelType::STRING_TEXTURE)
+		return false;
+
+	if (_batchNodes.empty() || _lengthOfString <= 0)
+		return true;
+
+	//every glyph has to be in the pages before anything is written
+	const int numLetters = std::min(_lengthOfString, (int)_lettersInfo.size());
+	_sharedGlyphs.resize(numLetters);
+	for (int i = 0; i < numLetters; ++i)
+	{
+		const LetterInfo& letterInfo = _lettersInfo[i];
+		_sharedGlyphs[i].page = -1;
+
+		if (!letterInfo.valid || letterInfo.atlasIndex < 0)
+			continue;
+
+		if (!_sharedAtlas->getGlyph(_fontAtlas, letterInfo.utf32Char, _sharedGlyphs[i]))
+			return false;
+	}
+
+	if (!_sharedAtlas->flush())
+		return false;
+
+	if (flags & FLAGS_TRANSFORM_DIRTY)
+	{
+		_insideBounds = renderer->checkVisibility(transform, _contentSize);
+	}
+
+	if (!_insideBounds)
+		return true;
+
+	//what Label::draw and this class' draw would have written into the font's quads
+	for (auto&& letter : _letters)
+	{
+		letter.second->updateTransform();
+	}
+
+	if (_glyphAnimator.isRunning() || _springs.isAwake())
+	{
+		applyCompactAnimation(false);
+	}
+
+	if (_colorAnimationRunning)
+	{
+		applyColorAnimation();
+	}
+
+	const int numPages = _sharedAtlas->getPageCount();
+	if ((int)_sharedQuads.size() < numPages)
+	{
+		_sharedQuads.resize(numPages);
+	}
+	for (auto&& quads : _sharedQuads)
+	{
+		quads.clear();
+	}
+
+	//ttf labels get their text colour from a uniform, the atlas' shader takes it per vertex
+	const bool ttf = _currentLabelType == LabelType::TTF;
+	const float textAlpha = ttf ? _textColor.a / 255.f : 1.f;
+	const float textRed = ttf ? _textColor.r / 255.f : 1.f;
+	const float textGreen = ttf ? _textColor.g / 255.f : 1.f;
+	const float textBlue = ttf ? _textColor.b / 255.f : 1.f;
+	const bool premultiplied = isOpacityModifyRGB();
+	const std::vector<int>& pages = getLetterPages();
+
+	for (int i = 0, numChars = std::min(numLetters, (int)pages.size()); i < numChars; ++i)
+	{
+		const AnimatedLabelAtlas::Glyph& glyph = _sharedGlyphs[i];
+		if (glyph.page < 0)
+			continue;
+
+		GlyphLayout layout;
+		layout.page = pages[i];
+		layout.atlasIndex = _lettersInfo[i].atlasIndex;
+
+		const cocos2d::V3F_C4B_T2F_Quad *fontQuad = getGlyphQuad(layout);
+		if (fontQuad == nullptr)
+			continue;
+
+		_sharedQuads[glyph.page].push_back(*fontQuad);
+		cocos2d::V3F_C4B_T2F_Quad& quad = _sharedQuads[glyph.page].back();
+
+		quad.bl.texCoords = glyph.bottomLeft;
+		quad.tr.texCoords = glyph.topRight;
+		quad.br.texCoords.u = glyph.topRight.u;
+		quad.br.texCoords.v = glyph.bottomLeft.v;
+		quad.tl.texCoords.u = glyph.bottomLeft.u;
+		quad.tl.texCoords.v = glyph.topRight.v;
+
+		//the pages are premultiplied, so the colours have to be too
+		for (cocos2d::V3F_C4B_T2F *vertex : { &quad.bl, &quad.br, &quad.tl, &quad.tr })
+		{
+			cocos2d::Color4B& color = vertex->colors;
+			const float alpha = color.a * textAlpha;
+			const float rgbScale = premultiplied ? textAlpha : alpha / 255.f;
+			color.r = (GLubyte)(color.r * textRed * rgbScale);
+			color.g = (GLubyte)(color.g * textGreen * rgbScale);
+			color.b = (GLubyte)(color.b * textBlue * rgbScale);
+			color.a = (GLubyte)alpha;
+		}
+	}
+
+	while ((int)_sharedCommands.size() < numPages)
+	{
+		_sharedCommands.push_back(std::unique_ptr<cocos2d::QuadCommand>(new cocos2d::QuadCommand()));
+	}
+
+	GlyphDrawCounter *counter = GlyphDrawCounter::getActive();
+
+	for (int page = 0; page < numPages; ++page)
+	{
+		std::vector<cocos2d::V3F_C4B_T2F_Quad>& quads = _sharedQuads[page];
+		if (quads.empty())
+			continue;
+
+		cocos2d::Texture2D *texture = _sharedAtlas->getPageTexture(page);
+		cocos2d::QuadCommand *command = _sharedCommands[page].get();
+		command->init(_globalZOrder, texture, _sharedAtlas->getDrawState(), cocos2d::BlendFunc::ALPHA_PREMULTIPLIED, quads.data(), quads.size(), transform, flags);
+		renderer->addCommand(command);
+
+		if (counter != nullptr)
+		{
+			counter->addQuads(texture->getName(), command->getMaterialID(), (int)quads.size());
+		}
+	}
+
+	return true;
+}
+
+void AnimatedLabel::countDraw()
+{
+	GlyphDrawCounter *counter = GlyphDrawCounter::getActive();
+	if (counter == nullptr || _batchNodes.empty() || _lengthOfString <= 0 || !_insideBounds)
+		return;
+
+	//the same choice Label::draw makes: bitmap fonts batch their first page, the
+	//rest draw each page on their own, twice with a shadow or an outline
+	if (!_shadowEnabled && (_currentLabelType == LabelType::BMFONT || _currentLabelType == LabelType::CHARMAP))
+	{
+		cocos2d::TextureAtlas *textureAtlas = _batchNodes.at(0)->getTextureAtlas();
+		counter->addQuads(textureAtlas->getTexture()->getName(), _quadCommand.getMaterialID(), (int)textureAtlas->getTotalQuads());
+		return;
+	}
+
+	const int passes = _shadowEnabled || _currLabelEffect == cocos2d::LabelEffect::OUTLINE ? 2 : 1;
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (auto&& batchNode : _batchNodes)
+		{
+			cocos2d::TextureAtlas *textureAtlas = batchNode->getTextureAtlas();
+			counter->addCustom(textureAtlas->getTexture()->getName(), (int)textureAtlas->getTotalQuads());
+		}
+	}
+}
+
+void AnimatedLabel::applyColorAnimation()
+{
+	TRACE_LABEL("applyColorAnimation");
+
+	if (_batchNodes.empty() || _lengthOfString <= 0)
+		return;
+
+	const cocos2d::Size& size = getContentSize();
+	const float invWidth = size.width > 0 ? 1.f / size.width : 0.f;
+	const float invHeight = size.height > 0 ? 1.f / size.height : 0.f;
+	const float timePhase = _colorCycleDuration > 0 ? _colorAnimationElapsed / _colorCycleDuration : 0.f;
+	const bool opacityModifyRGB = isOpacityModifyRGB();
+	const std::vector<int>& pages = getLetterPages();
+
+	cocos2d::Color4B corners[4];
+
+	for (int i = 0, numChars = (int)pages.size(); i < numChars; ++i)
+	{
+		const LetterInfo& letterInfo = _lettersInfo[i];
+		if (!letterInfo.valid || pages[i] < 0)
+			continue;
+
+		cocos2d::TextureAtlas *textureAtlas = _batchNodes.at(pages[i])->getTextureAtlas();
+
+		if (letterInfo.atlasIndex < 0 || letterInfo.atlasIndex >= textureAtlas->getTotalQuads())
+			continue;
+
+		cocos2d::V3F_C4B_T2F_Quad& quad = textureAtlas->getQuads()[letterInfo.atlasIndex];
+
+		if (_colorFunction)
+		{
+			corners[0] = corners[1] = corners[2] = corners[3] = cocos2d::Color4B::WHITE;
+			_colorFunction(i, _colorAnimationElapsed, corners);
+		}
+		else if (_colorPerCorner)
+		{
+			corners[0] = sampleColorLookup(_colorLookup, timePhase + _colorSpreadX * quad.bl.vertices.x * invWidth + _colorSpreadY * quad.bl.vertices.y * invHeight);
+			corners[1] = sampleColorLookup(_colorLookup, timePhase + _colorSpreadX * quad.br.vertices.x * invWidth + _colorSpreadY * quad.br.vertices.y * invHeight);
+			corners[2] = sampleColorLookup(_colorLookup, timePhase + _colorSpreadX * quad.tl.vertices.x * invWidth + _colorSpreadY * quad.tl.vertices.y * invHeight);
+			corners[3] = sampleColorLookup(_colorLookup, timePhase + _colorSpreadX * quad.tr.vertices.x * invWidth + _colorSpreadY * quad.tr.vertices.y * invHeight);
+		}
+		else
+		{
+			float centreX = (quad.bl.vertices.x + quad.tr.vertices.x) * 0.5f;
+			float centreY = (quad.bl.vertices.y + quad.tr.vertices.y) * 0.5f;
+			corners[0] = sampleColorLookup(_colorLookup, timePhase + _colorSpreadX * centreX * invWidth + _colorSpreadY * centreY * invHeight);
+			corners[1] = corners[2] = corners[3] = corners[0];
+		}
+
+		//glyphs that have a letter sprite keep its own colour and opacity underneath
+		cocos2d::Color3B baseColor = _displayedColor;
+		GLubyte baseOpacity = _displayedOpacity * getCompactOpacity(i);
+		if (!_letters.empty())
+		{
+			auto letter = _letters.find(i);
+			if (letter != _letters.end())
+			{
+				baseColor = letter->second->getDisplayedColor();
+				baseOpacity = letter->second->getDisplayedOpacity() * getCompactOpacity(i);
+			}
+		}
+
+		quad.bl.colors = modulateColor(corners[0], baseColor, baseOpacity, opacityModifyRGB);
+		quad.br.colors = modulateColor(corners[1], baseColor, baseOpacity, opacityModifyRGB);
+		quad.tl.colors = modulateColor(corners[2], baseColor, baseOpacity, opacityModifyRGB);
+		quad.tr.colors = modulateColor(corners[3], baseColor, baseOpacity, opacityModifyRGB);
+	}
+
+	for (auto&& batchNode : _batchNodes)
+	{
+		batchNode->getTextureAtlas()->setDirty(true);
+	}
+}
+
+//COMPACT ANIMATIONS
+
+void AnimatedLabel::setCompactAnimation(bool enabled)
+{
+	EffectLogScope effectLog(this, "setCompactAnimation", { enabled ? 1. : 0. });
+
+	_compactAnimation = enabled;
+}
+
+bool AnimatedLabel::useGlyphEffect()
+{
+	return updateLOD() || _compactAnimation;
+}
+
+void AnimatedLabel::startGlyphEffect(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, float initialDelay /* = 0.f */, const std::vector<unsigned char>& variants /* = std::vector<unsigned char>() */)
+{
+	if (_lodCollapsed)
+	{
+		//the label as a whole starts with its middle letter
+		startCollapsedEffect(effect, initialDelay + staggerDuration/2);
+		return;
+	}
+
+	snapshotGlyphLayout();
+
+	collectStaggerGlyphs(_staggerGlyphs);
+	_glyphAnimator.startStaggered(effect, stagger, _staggerGlyphs, staggerDuration, initialDelay, variants, _staggerOffsets);
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCompactAnimation));
+}
+
+void AnimatedLabel::snapshotGlyphLayout()
+{
+	//a compact animation already running keeps its layout and groups, so a new letter
+	//effect composes with a running group effect. A new string stops it in setString.
+	if (_glyphAnimator.getGlyphCount() > 0 && !_contentDirty)
+		return;
+
+	layoutIfDirty();
+
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
+	_glyphAnimator.reset(numChars);
+
+	for (int i = 0; i < numChars; ++i)
+	{
+		getRestLayout(i, _glyphAnimator.getLayout(i));
+	}
+
+	std::vector<GlyphStagger::Glyph> glyphs;
+	collectStaggerGlyphs(glyphs);
+	_glyphAnimator.setGroups(glyphs);
+}
+
+void AnimatedLabel::prepareForBatch(const std::shared_ptr<GlyphArena>& arena, int numGlyphs)
+{
+	_arena = arena;
+	_glyphAnimator.setArena(_arena.get());
+	_glyphAnimator.reserve(numGlyphs);
+
+	_lettersInfo.reserve(numGlyphs);
+}
+
+bool AnimatedLabel::getRestLayout(int index, GlyphLayout& layout)
+{
+	//reads the quad, so only valid while no compact animation has moved it
+	if (_batchNodes.empty() || index >= (int)_lettersInfo.size())
+		return false;
+
+	const LetterInfo& letterInfo = _lettersInfo[index];
+	if (!letterInfo.valid || letterInfo.atlasIndex < 0)
+		return false;
+
+	layout.page = getLetterPage(index);
+	if (layout.page < 0)
+		return false;
+	layout.atlasIndex = letterInfo.atlasIndex;
+
+	cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(layout);
+	if (quad == nullptr)
+	{
+		layout.atlasIndex = -1;
+		return false;
+	}
+
+	layout.left = quad->bl.vertices.x;
+	layout.bottom = quad->bl.vertices.y;
+	layout.right = quad->tr.vertices.x;
+	layout.top = quad->tr.vertices.y;
+	return true;
+}
+
+int AnimatedLabel::getLetterPage(int index) const
+{
+	if (index < 0 || index >= (int)_lettersInfo.size() || _batchNodes.empty())
+		return -1;
+
+	if (_batchNodes.size() == 1)
+		return 0;
+
+	cocos2d::FontLetterDefinition letterDef;
+	if (!_fontAtlas->getLetterDefinitionForChar(_lettersInfo[index].utf32Char, letterDef))
+		return -1;
+
+	return letterDef.textureID;
+}
+
+const std::vector<int>& AnimatedLabel::getLetterPages()
+{
+	//a font with several pages finds a character's page through a hash lookup, so it is
+	//done once per layout rather than for every glyph on every frame
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
+	if (_letterPagesDirty || (int)_letterPages.size() != numChars)
+	{
+		_letterPages.resize(numChars);
+		for (int i = 0; i < numChars; ++i)
+		{
+			_letterPages[i] = getLetterPage(i);
+		}
+		_letterPagesDirty = false;
+	}
+
+	return _letterPages;
+}
+
+void AnimatedLabel::layoutIfDirty()
+{
+	if (!_contentDirty)
+		return;
+
+	updateContent();
+	_hitGridDirty = true;
+	_letterPagesDirty = true;
+}
+
+cocos2d::V3F_C4B_T2F_Quad* AnimatedLabel::getGlyphQuad(const GlyphLayout& layout)
+{
+	if (layout.atlasIndex < 0 || layout.page >= (int)_batchNodes.size())
+		return nullptr;
+
+	cocos2d::TextureAtlas *textureAtlas = _batchNodes.at(layout.page)->getTextureAtlas();
+	if (layout.atlasIndex >= textureAtlas->getTotalQuads())
+		return nullptr;
+
+	return &textureAtlas->getQuads()[layout.atlasIndex];
+}
+
+//WORD AND LINE GROUPS
+
+int AnimatedLabel::getWordCount()
+{
+	std::vector<GlyphStagger::Glyph> glyphs;
+	collectStaggerGlyphs(glyphs);
+
+	int words = 0;
+	for (int i = 0; i < (int)glyphs.size(); ++i)
+	{
+		char32_t c = _utf32Text[i];
+		if (c != ' ' && c != '\n' && c != '\t' && c != 0x3000)
+			words = std::max(words, glyphs[i].word + 1);
+	}
+
+	return words;
+}
+
+void AnimatedLabel::runGroupEffect(GlyphAnimator::GroupLevel level, const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, float initialDelay /* = 0.f */)
+{
+	TRACE_LABEL("runGroupEffect");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "runGroupEffect");
+
+	if (updateLOD())
+	{
+		startCollapsedEffect(effect, initialDelay + staggerDuration/2);
+		return;
+	}
+
+	snapshotGlyphLayout();
+
+	std::vector<GlyphStagger::Glyph> glyphs;
+	collectStaggerGlyphs(glyphs);
+	_glyphAnimator.startStaggeredGroupEffect(level, effect, stagger, glyphs, staggerDuration, initialDelay);
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCompactAnimation));
+}
+
+//ANIMATION LAYERS
+
+int AnimatedLabel::addAnimationLayer(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, bool loop /* = false */, float fadeIn /* = 0.f */, float weight /* = 1.f */)
+{
+	TRACE_LABEL("addAnimationLayer");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "addAnimationLayer");
+
+	if (updateLOD())
+		return 0;
+
+	snapshotGlyphLayout();
+
+	std::vector<GlyphStagger::Glyph> glyphs;
+	collectStaggerGlyphs(glyphs);
+	const int layer = _glyphAnimator.addStaggeredLayer(effect, stagger, glyphs, staggerDuration, loop, fadeIn, weight);
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCompactAnimation));
+	return layer;
+}
+
+void AnimatedLabel::fadeAnimationLayer(int layer, float weight, float duration)
+{
+	_glyphAnimator.fadeLayer(layer, weight, duration);
+}
+
+void AnimatedLabel::removeAnimationLayer(int layer, float fadeOut /* = 0.f */)
+{
+	_glyphAnimator.removeLayer(layer, fadeOut);
+
+	//the next update stops the compact animation if that was the last thing running
+}
+
+int AnimatedLabel::addWobbleLayer(float amplitude, float period)
+{
+	EffectLogScope effectLog(this, "addWobbleLayer", { amplitude, period });
+
+	return addAnimationLayer(GlyphEffectLibrary::wobble(amplitude, period), getEffectStagger(false), period/2, true, period/4);
+}
+
+int AnimatedLabel::addPulseLayer(float scale, float period)
+{
+	EffectLogScope effectLog(this, "addPulseLayer", { scale, period });
+
+	return addAnimationLayer(GlyphEffectLibrary::pulse(scale, period), getEffectStagger(false), period/2, true, period/4);
+}
+
+void AnimatedLabel::updateCompactAnimation(float dt)
+{
+	TRACE_LABEL("updateCompactAnimation");
+
+	//springs still moving keep the compact layout alive
+	if (!_glyphAnimator.update(dt) && !_springs.isAwake())
+	{
+		stopCompactAnimation();
+	}
+}
+
+void AnimatedLabel::stopCompactAnimation()
+{
+	if (_glyphAnimator.getGlyphCount() == 0)
+		return;
+
+	//every effect ends at rest, so the quads go back to the layout and the block is released
+	applyCompactAnimation(true);
+	_glyphAnimator.clear();
+	_springs.clear();
+
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCompactAnimation));
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateSprings));
+}
+
+float AnimatedLabel::getCompactOpacity(int index) const
+{
+	if (!_glyphAnimator.isRunning() || index >= _glyphAnimator.getGlyphCount())
+		return 1.f;
+
+	return std::max(0.f, std::min(1.f, _glyphAnimator.getOpacity(index)));
+}
+
+void AnimatedLabel::applyCompactAnimation(bool atRest)
+{
+	TRACE_LABEL("applyCompactAnimation");
+
+	if (_batchNodes.empty())
+		return;
+
+	const bool opacityModifyRGB = isOpacityModifyRGB();
+	const bool effectRunning = _glyphAnimator.isRunning();
+	const bool springs = !atRest && _springs.getCount() == _glyphAnimator.getGlyphCount();
+	float corners[8];
+
+	for (int i = 0, numGlyphs = _glyphAnimator.getGlyphCount(); i < numGlyphs; ++i)
+	{
+		const GlyphLayout& layout = _glyphAnimator.getLayout(i);
+		cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(layout);
+		if (quad == nullptr)
+			continue;
+
+		//with only the springs moving, letter sprites keep their own quads
+		if (!atRest && !effectRunning && _letters.find(i) != _letters.end())
+			continue;
+
+		float opacity = 1.f;
+
+		if (atRest || !effectRunning)
+		{
+			corners[0] = corners[4] = layout.left;
+			corners[2] = corners[6] = layout.right;
+			corners[1] = corners[3] = layout.bottom;
+			corners[5] = corners[7] = layout.top;
+		}
+		else
+		{
+			_glyphAnimator.getCorners(i, corners);
+			opacity = getCompactOpacity(i);
+		}
+
+		if (springs)
+		{
+			const float springX = _springs.getOffsetX(i);
+			const float springY = _springs.getOffsetY(i);
+			for (int corner = 0; corner < 8; corner += 2)
+			{
+				corners[corner] += springX;
+				corners[corner + 1] += springY;
+			}
+		}
+
+		quad->bl.vertices.x = corners[0]; quad->bl.vertices.y = corners[1];
+		quad->br.vertices.x = corners[2]; quad->br.vertices.y = corners[3];
+		quad->tl.vertices.x = corners[4]; quad->tl.vertices.y = corners[5];
+		quad->tr.vertices.x = corners[6]; quad->tr.vertices.y = corners[7];
+
+		cocos2d::Color3B baseColor = _displayedColor;
+		GLubyte baseOpacity = _displayedOpacity;
+		if (!_letters.empty())
+		{
+			auto letter = _letters.find(i);
+			if (letter != _letters.end())
+			{
+				baseColor = letter->second->getDisplayedColor();
+				baseOpacity = letter->second->getDisplayedOpacity();
+			}
+		}
+
+		cocos2d::Color4B color = modulateColor(cocos2d::Color4B(255, 255, 255, opacity * 255), baseColor, baseOpacity, opacityModifyRGB);
+		quad->bl.colors = quad->br.colors = quad->tl.colors = quad->tr.colors = color;
+	}
+
+	for (auto&& batchNode : _batchNodes)
+	{
+		batchNode->getTextureAtlas()->setDirty(true);
+	}
+}
+
+//CHOREOGRAPHER
+
+void AnimatedLabel::startTimeline(cocos2d::SEL_SCHEDULE selector)
+{
+	if (std::find(_timelines.begin(), _timelines.end(), selector) == _timelines.end())
+	{
+		_timelines.push_back(selector);
+	}
+
+	//Node::cleanup() unschedules everything without telling the list, so check the scheduler
+	if (_choreographer == nullptr && !isScheduled(selector))
+	{
+		schedule(selector);
+	}
+}
+
+void AnimatedLabel::stopTimeline(cocos2d::SEL_SCHEDULE selector)
+{
+	auto timeline = std::find(_timelines.begin(), _timelines.end(), selector);
+	if (timeline != _timelines.end())
+	{
+		_timelines.erase(timeline);
+	}
+
+	if (_choreographer == nullptr)
+	{
+		unschedule(selector);
+	}
+}
+
+void AnimatedLabel::tickTimelines(float dt)
+{
+	//a timeline may stop itself while it runs, the next one then moves into its slot
+	for (size_t i = 0; i < _timelines.size();)
+	{
+		cocos2d::SEL_SCHEDULE selector = _timelines[i];
+		(this->*selector)(dt);
+
+		if (i < _timelines.size() && _timelines[i] == selector)
+			++i;
+	}
+}
+
+void AnimatedLabel::setChoreographer(AnimatedLabelChoreographer* choreographer)
+{
+	if (choreographer == _choreographer)
+		return;
+
+	//running timelines move between the scheduler and the choreographer
+	if (_choreographer == nullptr)
+	{
+		for (auto&& selector : _timelines)
+			unschedule(selector);
+	}
+	else
+	{
+		_choreographer->release();
+	}
+
+	_choreographer = choreographer;
+
+	if (_choreographer == nullptr)
+	{
+		for (auto&& selector : _timelines)
+			schedule(selector);
+	}
+	else
+	{
+		_choreographer->retain();
+	}
+}
+
+void AnimatedLabel::setActionsPaused(bool paused)
+{
+	cocos2d::ActionManager *actionManager = getActionManager();
+
+	if (paused)
+		actionManager->pauseTarget(this);
+	else
+		actionManager->resumeTarget(this);
+
+	for (auto&& letter : _letters)
+	{
+		if (paused)
+			actionManager->pauseTarget(letter.second);
+		else
+			actionManager->resumeTarget(letter.second);
+	}
+}
+
+//SPRINGS
+
+bool AnimatedLabel::prepareSprings()
+{
+	snapshotGlyphLayout();
+
+	const int numGlyphs = _glyphAnimator.getGlyphCount();
+	if (numGlyphs == 0)
+		return false;
+
+	if (_springs.getCount() != numGlyphs)
+	{
+		_springs.resize(numGlyphs);
+	}
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateSprings));
+
+	//counts towards the level of detail budget while moving
+	updateLOD();
+
+	return true;
+}
+
+void AnimatedLabel::updateSprings(float dt)
+{
+	TRACE_LABEL("updateSprings");
+
+	if (_springs.update(dt))
+		return;
+
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateSprings));
+
+	if (!_glyphAnimator.isRunning())
+	{
+		stopCompactAnimation();
+	}
+}
+
+void AnimatedLabel::handOverToSprings()
+{
+	if (!_glyphAnimator.isRunning() || _lodCollapsed)
+		return;
+
+	//read first, preparing the springs may lay the label out again
+	const int numGlyphs = _glyphAnimator.getGlyphCount();
+	std::vector<float> offsets(numGlyphs * 2);
+	bool displaced = false;
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		const GlyphState& state = _glyphAnimator.getState(i);
+		offsets[i * 2] = state.offsetX;
+		offsets[i * 2 + 1] = state.offsetY;
+		displaced = displaced || state.offsetX != 0 || state.offsetY != 0;
+	}
+
+	if (!displaced || !prepareSprings() || _glyphAnimator.getGlyphCount() != numGlyphs)
+		return;
+
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		_springs.addOffset(i, offsets[i * 2], offsets[i * 2 + 1]);
+	}
+}
+
+void AnimatedLabel::springImpulse(int index, const cocos2d::Vec2& velocity)
+{
+	EffectLogScope effectLog(this, "springImpulse", { (double)index, velocity.x, velocity.y });
+
+	if (!prepareSprings())
+		return;
+
+	_springs.addVelocity(index, velocity.x, velocity.y);
+}
+
+void AnimatedLabel::springRipple(const cocos2d::Vec2& point, float strength, float radius)
+{
+	EffectLogScope effectLog(this, "springRipple", { point.x, point.y, strength, radius });
+
+	if (radius <= 0 || !prepareSprings())
+		return;
+
+	for (int i = 0, numGlyphs = _glyphAnimator.getGlyphCount(); i < numGlyphs; ++i)
+	{
+		const GlyphLayout& layout = _glyphAnimator.getLayout(i);
+		if (layout.atlasIndex < 0)
+			continue;
+
+		cocos2d::Vec2 away((layout.left + layout.right) * 0.5f - point.x, (layout.bottom + layout.top) * 0.5f - point.y);
+		const float distance = away.length();
+		if (distance >= radius)
+			continue;
+
+		//falls off linearly to nothing at the radius, letters right on the point go up
+		const float speed = strength * (1.f - distance / radius);
+		away = distance > 0.001f ? away / distance : cocos2d::Vec2(0, 1);
+		_springs.addVelocity(i, away.x * speed, away.y * speed);
+	}
+}
+
+void AnimatedLabel::springShake(float strength)
+{
+	EffectLogScope effectLog(this, "springShake", { strength });
+
+	if (!prepareSprings())
+		return;
+
+	for (int i = 0, numGlyphs = _glyphAnimator.getGlyphCount(); i < numGlyphs; ++i)
+	{
+		if (_glyphAnimator.getLayout(i).atlasIndex < 0)
+			continue;
+
+		_springs.addVelocity(i, _random.nextFloat(-strength, strength), _random.nextFloat(-strength, strength));
+	}
+}
+
+void AnimatedLabel::springStretch(float amount)
+{
+	EffectLogScope effectLog(this, "springStretch", { amount });
+
+	if (!prepareSprings())
+		return;
+
+	const float centreX = getContentSize().width/2;
+
+	for (int i = 0, numGlyphs = _glyphAnimator.getGlyphCount(); i < numGlyphs; ++i)
+	{
+		const GlyphLayout& layout = _glyphAnimator.getLayout(i);
+		if (layout.atlasIndex < 0)
+			continue;
+
+		_springs.addOffset(i, ((layout.left + layout.right) * 0.5f - centreX) * amount, 0);
+	}
+}
+
+//GOLDEN SAMPLES
+
+void AnimatedLabel::sampleGlyphs(std::vector<GlyphSample>& samples)
+{
+	layoutIfDirty();
+
+	//colours only reach the quads when drawn, so write them now
+	if (_colorAnimationRunning)
+	{
+		applyColorAnimation();
+	}
+
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
+	const bool compact = _glyphAnimator.getGlyphCount() == numChars;
+
+	samples.assign(numChars, GlyphSample());
+
+	for (int i = 0; i < numChars; ++i)
+	{
+		GlyphSample& sample = samples[i];
+
+		GlyphLayout layout;
+		if (compact)
+		{
+			layout = _glyphAnimator.getLayout(i);
+			if (layout.atlasIndex < 0)
+				continue;
+		}
+		else if (!getRestLayout(i, layout))
+		{
+			continue;
+		}
+
+		auto letter = _letters.find(i);
+		if (letter != _letters.end())
+		{
+			cocos2d::Sprite *sprite = letter->second;
+			sample.x = sprite->getPositionX();
+			sample.y = sprite->getPositionY();
+			sample.scaleX = sprite->getScaleX();
+			sample.scaleY = sprite->getScaleY();
+			sample.rotation = sprite->getRotation();
+			sample.r = sprite->getDisplayedColor().r;
+			sample.g = sprite->getDisplayedColor().g;
+			sample.b = sprite->getDisplayedColor().b;
+			sample.a = sprite->getDisplayedOpacity() * getCompactOpacity(i);
+		}
+		else
+		{
+			GlyphState state = { 0.f, 0.f, 0.f, 1.f, 0.f, 1.f };
+			sample.x = (layout.left + layout.right) * 0.5f;
+			sample.y = (layout.bottom + layout.top) * 0.5f;
+			if (compact)
+			{
+				_glyphAnimator.getComposedState(i, sample.x, sample.y, state);
+			}
+			if (compact && _springs.getCount() == numChars)
+			{
+				sample.x += _springs.getOffsetX(i);
+				sample.y += _springs.getOffsetY(i);
+			}
+			sample.scaleX = sample.scaleY = state.scale;
+			sample.rotation = state.rotation;
+			sample.r = _displayedColor.r;
+			sample.g = _displayedColor.g;
+			sample.b = _displayedColor.b;
+			sample.a = _displayedOpacity * getCompactOpacity(i);
+		}
+
+		if (_colorAnimationRunning)
+		{
+			cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(layout);
+			if (quad != nullptr)
+			{
+				sample.r = quad->bl.colors.r;
+				sample.g = quad->bl.colors.g;
+				sample.b = quad->bl.colors.b;
+				sample.a = quad->bl.colors.a;
+			}
+		}
+	}
+}
+
+GlyphRecording AnimatedLabel::recordEffect(const std::function<void(AnimatedLabel* label)>& startEffect, const std::vector<float>& timestamps, float dt /* = 1.f/60 */)
+{
+	GlyphRecording recording;
+
+	//paused nodes don't get their schedules or actions stepped
+	if (!isRunning())
+	{
+		cocos2d::log("AnimatedLabel::recordEffect: the label is not running in a scene");
+		return recording;
+	}
+
+	if (dt <= 0)
+	{
+		cocos2d::log("AnimatedLabel::recordEffect: dt must be positive");
+		return recording;
+	}
+
+	cocos2d::Scheduler *scheduler = cocos2d::Director::getInstance()->getScheduler();
+	std::vector<GlyphSample> samples;
+	float elapsed = 0.f;
+
+	//the effect may remove the label when it finishes
+	retain();
+
+	startEffect(this);
+
+	for (float time : timestamps)
+	{
+		while (elapsed + dt <= time)
+		{
+			scheduler->update(dt);
+			elapsed += dt;
+		}
+
+		//land exactly on timestamps that aren't a multiple of dt
+		if (time > elapsed)
+		{
+			scheduler->update(time - elapsed);
+			elapsed = time;
+		}
+
+		sampleGlyphs(samples);
+		recording.addFrame(time, samples);
+	}
+
+	release();
+
+	return recording;
+}
+
+//RANDOMNESS
+
+static GlyphRandom s_labelSeeds;
+
+unsigned int AnimatedLabel::nextLabelSeed()
+{
+	return s_labelSeeds.next();
+}
+
+void AnimatedLabel::setLabelSeedSequence(unsigned int seed)
+{
+	s_labelSeeds.setSeed(seed);
+}
+
+void AnimatedLabel::setRandomSeed(unsigned int seed)
+{
+	EffectLogScope effectLog(this, "setRandomSeed", { (double)seed });
+
+	_random.setSeed(seed);
+}
+
+//EFFECT LOG
+
+static bool s_effectLogRunning = false;
+static GlyphEffectLog s_effectLog;
+static float s_effectLogElapsed = 0.f;
+static std::unordered_map<const AnimatedLabel*, int> s_effectLogLabels;
+static int s_effectLogLabelCount = 0;
+static int s_effectLogDepth = 0; //effects running inside a logged call aren't logged again
+
+static bool isLoggedLabel(const AnimatedLabel* label)
+{
+	return s_effectLogLabels.find(label) != s_effectLogLabels.end();
+}
+
+static void forgetLoggedLabel(const AnimatedLabel* label)
+{
+	//a new label at the same address is a different label
+	s_effectLogLabels.erase(label);
+}
+
+AnimatedLabel::EffectLogScope::EffectLogScope(AnimatedLabel* label, const char* name, std::initializer_list<double> args, const std::string& text /* = std::string() */)
+{
+	if (s_effectLogRunning && s_effectLogDepth == 0 && label != nullptr)
+	{
+		label->logEffectCall(name, std::vector<double>(args), text);
+	}
+	s_effectLogDepth++;
+}
+
+AnimatedLabel::EffectLogScope::EffectLogScope(AnimatedLabel* label, const char* name, const std::vector<double>& args, const std::string& text /* = std::string() */)
+{
+	if (s_effectLogRunning && s_effectLogDepth == 0 && label != nullptr)
+	{
+		label->logEffectCall(name, args, text);
+	}
+	s_effectLogDepth++;
+}
+
+AnimatedLabel::EffectLogScope::~EffectLogScope()
+{
+	s_effectLogDepth--;
+}
+
+void AnimatedLabel::startEffectLog()
+{
+	s_effectLog.clear();
+	s_effectLogLabels.clear();
+	s_effectLogLabelCount = 0;
+	s_effectLogElapsed = 0.f;
+
+	if (!s_effectLogRunning)
+	{
+		cocos2d::Director::getInstance()->getScheduler()->schedule(&AnimatedLabel::tickEffectLog, &s_effectLog, 0, false, "tickEffectLog");
+	}
+	s_effectLogRunning = true;
+}
+
+GlyphEffectLog AnimatedLabel::stopEffectLog()
+{
+	if (s_effectLogRunning)
+	{
+		cocos2d::Director::getInstance()->getScheduler()->unschedule("tickEffectLog", &s_effectLog);
+	}
+	s_effectLogRunning = false;
+	s_effectLogLabels.clear();
+
+	GlyphEffectLog log;
+	std::swap(log, s_effectLog);
+	return log;
+}
+
+bool AnimatedLabel::isEffectLogRunning()
+{
+	return s_effectLogRunning;
+}
+
+void AnimatedLabel::tickEffectLog(float dt)
+{
+	s_effectLogElapsed += dt;
+}
+
+//The label's number in the log, logging it where it first appears
+int AnimatedLabel::getEffectLogIndex()
+{
+	auto logged = s_effectLogLabels.find(this);
+	if (logged != s_effectLogLabels.end())
+		return logged->second;
+
+	//a parent label first, so replay can add this one to it
+	AnimatedLabel *parentLabel = dynamic_cast<AnimatedLabel*>(getParent());
+	const int parent = parentLabel != nullptr ? parentLabel->getEffectLogIndex() : -1;
+
+	GlyphEffectLog::Call call;
+	call.time = s_effectLogElapsed;
+	call.label = s_effectLogLabelCount++;
+	s_effectLogLabels[this] = call.label;
+
+	//enough to make the label again: the font, then its size (0 for a BMFont), alignment,
+	//line width, position, compact flag, random state, scale, rotation, anchor point,
+	//dimensions, vertical alignment, BMFont image offset and parent (-1 for none), then
+	//its text
+	const bool ttf = _currentLabelType == LabelType::TTF;
+	call.name = "label";
+	call.text = ttf ? getTTFConfig().fontFilePath : getBMFontFilePath();
+	call.args = { ttf ? (double)getTTFConfig().fontSize : 0., (double)(int)getHorizontalAlignment(), getMaxLineWidth(),
+			getPositionX(), getPositionY(), _compactAnimation ? 1. : 0., (double)_random.getState(),
+			getScaleX(), getScaleY(), getRotationSkewX(), getRotationSkewY(), getAnchorPoint().x, getAnchorPoint().y,
+			getDimensions().width, getDimensions().height, (double)(int)getVerticalAlignment(),
+			_bmfontImageOffset.x, _bmfontImageOffset.y, (double)parent };
+	s_effectLog.addCall(call);
+
+	call.name = "setString";
+	call.args.clear();
+	call.text = _utf8Text;
+	s_effectLog.addCall(call);
+
+	return call.label;
+}
+
+void AnimatedLabel::logEffectCall(const char* name, const std::vector<double>& args, const std::string& text)
+{
+	GlyphEffectLog::Call call;
+	call.label = getEffectLogIndex();
+	call.time = s_effectLogElapsed;
+	call.name = name;
+	call.args = args;
+	call.text = text;
+	s_effectLog.addCall(call);
+}
+
+//fallback for an argument the call doesn't have, as in a log from an older version
+static float getCallArg(const GlyphEffectLog::Call& call, size_t index, float fallback = 0.f)
+{
+	return index < call.args.size() ? (float)call.args[index] : fallback;
+}
+
+void AnimatedLabel::replayEffectLog(const GlyphEffectLog& log, cocos2d::Node* parent, float dt /* = 1.f/60 */, float settleTime /* = 0.f */, const std::function<void(float time)>& onStep /* = nullptr */)
+{
+	//paused nodes don't get their schedules or actions stepped
+	if (parent == nullptr || !parent->isRunning())
+	{
+		cocos2d::log("AnimatedLabel::replayEffectLog: the parent is not running in a scene");
+		return;
+	}
+
+	if (dt <= 0)
+	{
+		cocos2d::log("AnimatedLabel::replayEffectLog: dt must be positive");
+		return;
+	}
+
+	cocos2d::Scheduler *scheduler = cocos2d::Director::getInstance()->getScheduler();
+	std::vector<AnimatedLabel*> labels(log.getLabelCount(), nullptr); //retained, effects may remove them
+	const float end = log.getDuration() + settleTime;
+	float elapsed = 0.f;
+	int next = 0;
+
+	while (true)
+	{
+		//each call lands on the step nearest to when it was made
+		for (; next < log.getCallCount() && log.getCall(next).time <= elapsed + dt * 0.5f; ++next)
+		{
+			replayEffectCall(log.getCall(next), parent, labels);
+		}
+
+		if (next >= log.getCallCount() && elapsed >= end)
+			break;
+
+		scheduler->update(dt);
+		elapsed += dt;
+
+		if (onStep)
+			onStep(elapsed);
+	}
+
+	for (auto&& label : labels)
+	{
+		CC_SAFE_RELEASE(label);
+	}
+}
+
+void AnimatedLabel::replayEffectCall(const GlyphEffectLog::Call& call, cocos2d::Node* parent, std::vector<AnimatedLabel*>& labels)
+{
+	if (call.label < 0 || call.label >= (int)labels.size())
+		return;
+
+	AnimatedLabel *&label = labels[call.label];
+
+	if (call.name == "label")
+	{
+		CC_SAFE_RELEASE(label);
+
+		const cocos2d::TextHAlignment alignment = (cocos2d::TextHAlignment)(int)getCallArg(call, 1);
+		const int maxLineWidth = (int)getCallArg(call, 2);
+		const cocos2d::Size dimensions(getCallArg(call, 13), getCallArg(call, 14));
+		const cocos2d::TextVAlignment vAlignment = (cocos2d::TextVAlignment)(int)getCallArg(call, 15);
+		if (getCallArg(call, 0) > 0)
+		{
+			label = createWithTTF("", call.text, getCallArg(call, 0), dimensions, alignment, vAlignment);
+			if (label != nullptr)
+				label->setMaxLineWidth(maxLineWidth);
+		}
+		else
+		{
+			label = createWithBMFont(call.text, "", alignment, maxLineWidth, cocos2d::Vec2(getCallArg(call, 16), getCallArg(call, 17)));
+			if (label != nullptr)
+			{
+				//createWithBMFont doesn't apply the alignment
+				label->setAlignment(alignment, vAlignment);
+				label->setDimensions(dimensions.width, dimensions.height);
+			}
+		}
+
+		if (label == nullptr)
+		{
+			cocos2d::log("AnimatedLabel::replayEffectLog: can't create a label with %s", call.text.c_str());
+			return;
+		}
+
+		label->retain();
+		label->setPosition(getCallArg(call, 3), getCallArg(call, 4));
+		label->_compactAnimation = getCallArg(call, 5) != 0;
+		label->_random.setState(call.args.size() > 6 ? (unsigned int)call.args[6] : 0);
+		label->setScaleX(getCallArg(call, 7, 1.f));
+		label->setScaleY(getCallArg(call, 8, 1.f));
+		label->setRotationSkewX(getCallArg(call, 9));
+		label->setRotationSkewY(getCallArg(call, 10));
+		label->setAnchorPoint(cocos2d::Vec2(getCallArg(call, 11, 0.5f), getCallArg(call, 12, 0.5f)));
+
+		//under its parent label when it was in one, which is logged before it
+		const int parentLabel = (int)getCallArg(call, 18, -1.f);
+		if (parentLabel >= 0 && parentLabel < (int)labels.size() && labels[parentLabel] != nullptr)
+			labels[parentLabel]->addChild(label);
+		else
+			parent->addChild(label);
+		return;
+	}
+
+	if (label == nullptr)
+		return;
+
+	if (call.name == kUnreplayableCall)
+	{
+		cocos2d::log("AnimatedLabel::replayEffectLog: %s on label %d at %.3fs can't be replayed, the run may differ from here on", call.text.c_str(), call.label, call.time);
+		return;
+	}
+
+	typedef void (*Replay)(AnimatedLabel* label, const GlyphEffectLog::Call& call);
+	static const std::unordered_map<std::string, Replay> replays = {
+		{ "setString", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->setString(c.text); } },
+		{ "setRandomSeed", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->setRandomSeed(c.args.empty() ? 0 : (unsigned int)c.args[0]); } },
+		{ "setCompactAnimation", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->setCompactAnimation(getCallArg(c, 0) != 0); } },
+		{ "flyPastAndRemove", [](AnimatedLabel* l, const GlyphEffectLog::Call&) { l->flyPastAndRemove(); } },
+		{ "animateWordsJump", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateWordsJump(getCallArg(c, 0), getCallArg(c, 1)); } },
+		{ "animateInLinesFlyInFromLeft", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInLinesFlyInFromLeft(getCallArg(c, 0)); } },
+		{ "animateInTypewriter", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInTypewriter(getCallArg(c, 0), getCallArg(c, 1)); } },
+		{ "animateInFlyInFromLeft", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInFlyInFromLeft(getCallArg(c, 0)); } },
+		{ "animateInFlyInFromRight", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInFlyInFromRight(getCallArg(c, 0)); } },
+		{ "animateInFlyInFromTop", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInFlyInFromTop(getCallArg(c, 0)); } },
+		{ "animateInFlyInFromBottom", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInFlyInFromBottom(getCallArg(c, 0)); } },
+		{ "animateInDropFromTop", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInDropFromTop(getCallArg(c, 0)); } },
+		{ "animateInSwell", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInSwell(getCallArg(c, 0)); } },
+		{ "animateInRevealFromLeft", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInRevealFromLeft(getCallArg(c, 0)); } },
+		{ "animateSwell", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateSwell(getCallArg(c, 0)); } },
+		{ "animateJump", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateJump(getCallArg(c, 0), getCallArg(c, 1)); } },
+		{ "animateStretchElastic", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateStretchElastic(getCallArg(c, 0), getCallArg(c, 1), getCallArg(c, 2)); } },
+		{ "animateInSpin", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInSpin(getCallArg(c, 0), (int)getCallArg(c, 1)); } },
+		{ "animateInVortex", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateInVortex(getCallArg(c, 0), (int)getCallArg(c, 1), getCallArg(c, 2) != 0, getCallArg(c, 3) != 0); } },
+		{ "animateRainbow", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateRainbow(getCallArg(c, 0)); } },
+		{ "animateColorsRainbow", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->animateColorsRainbow(getCallArg(c, 0), getCallArg(c, 1), getCallArg(c, 2) != 0, getCallArg(c, 3)); } },
+		{ "animateColorsGradient", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) {
+			std::vector<cocos2d::Color4B> palette;
+			for (size_t i = 5; i + 3 < c.args.size(); i += 4)
+			{
+				palette.push_back(cocos2d::Color4B((GLubyte)c.args[i], (GLubyte)c.args[i + 1], (GLubyte)c.args[i + 2], (GLubyte)c.args[i + 3]));
+			}
+			l->animateColorsGradient(palette, getCallArg(c, 0), getCallArg(c, 1), getCallArg(c, 2), getCallArg(c, 3) != 0, getCallArg(c, 4));
+		} },
+		{ "addWobbleLayer", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->addWobbleLayer(getCallArg(c, 0), getCallArg(c, 1)); } },
+		{ "addPulseLayer", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->addPulseLayer(getCallArg(c, 0), getCallArg(c, 1)); } },
+		{ "springImpulse", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->springImpulse((int)getCallArg(c, 0), cocos2d::Vec2(getCallArg(c, 1), getCallArg(c, 2))); } },
+		{ "springRipple", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->springRipple(cocos2d::Vec2(getCallArg(c, 0), getCallArg(c, 1)), getCallArg(c, 2), getCallArg(c, 3)); } },
+		{ "springShake", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->springShake(getCallArg(c, 0)); } },
+		{ "springStretch", [](AnimatedLabel* l, const GlyphEffectLog::Call& c) { l->springStretch(getCallArg(c, 0)); } },
+	};
+
+	auto replay = replays.find(call.name);
+	if (replay == replays.end())
+	{
+		cocos2d::log("AnimatedLabel::replayEffectLog: unknown call %s", call.name.c_str());
+		return;
+	}
+
+	replay->second(label, call);
+}
+
+//MEMORY
+
+AnimatedLabel::MemoryUsage AnimatedLabel::getMemoryUsage() const
+{
+	MemoryUsage usage = MemoryUsage();
+
+	usage.glyphState = _glyphAnimator.getStateBytes() + _springs.getBytes();
+
+	usage.actions = _glyphAnimator.getEffectBytes();
+	usage.actions += _colorLookup.capacity() * sizeof(cocos2d::Color4B);
+	//the staggered runs and pending letter setups live in the effect arena
+	usage.actions += _effectArena.getBytesReserved();
+	usage.actions += _staggerGlyphs.capacity() * sizeof(GlyphStagger::Glyph) + _staggerOffsets.capacity() * sizeof(float);
+
+	usage.layout = _glyphAnimator.getLayoutBytes();
+	usage.layout += _lettersInfo.capacity() * sizeof(LetterInfo);
+	for (auto&& batchNode : _batchNodes)
+	{
+		//a quad and its six indices per slot
+		usage.layout += batchNode->getTextureAtlas()->getCapacity() * (sizeof(cocos2d::V3F_C4B_T2F_Quad) + 6 * sizeof(GLushort));
+	}
+	usage.layout += _hitGrid.getBytes() + _hitGlyphs.capacity() * sizeof(GlyphStagger::Glyph);
+	usage.layout += _sharedGlyphs.capacity() * sizeof(AnimatedLabelAtlas::Glyph);
+	for (auto&& quads : _sharedQuads)
+	{
+		usage.layout += quads.capacity() * sizeof(cocos2d::V3F_C4B_T2F_Quad);
+	}
+
+	for (auto&& letter : _letters)
+	{
+		usage.letterSpriteCount++;
+		usage.letterActionCount += (int)letter.second->getNumberOfRunningActions();
+	}
+	usage.letterSprites = usage.letterSpriteCount * sizeof(cocos2d::Sprite);
+
+	return usage;
+}
+
+//LEVEL OF DETAIL
+
+static AnimatedLabel::LODPolicy s_lodPolicy;
+static int s_animatedGlyphCount = 0;
+
+void AnimatedLabel::setLODPolicy(const LODPolicy& policy)
+{
+	s_lodPolicy = policy;
+}
+
+const AnimatedLabel::LODPolicy& AnimatedLabel::getLODPolicy()
+{
+	return s_lodPolicy;
+}
+
+int AnimatedLabel::getAnimatedGlyphCount()
+{
+	return s_animatedGlyphCount;
+}
+
+bool AnimatedLabel::updateLOD()
+{
+	//measure the label as laid out, not part way through a collapsed effect
+	stopCollapsedEffect();
+
+	const int numChars = getStringLength();
+	const float hysteresis = s_lodPolicy.hysteresis;
+	const int othersAnimating = s_animatedGlyphCount - _registeredGlyphCount;
+
+	bool tooSmall = false;
+	if (s_lodPolicy.minScreenHeight > 0)
+	{
+		const cocos2d::Size& size = getContentSize();
+		cocos2d::Rect screenBounds = cocos2d::RectApplyTransform(cocos2d::Rect(0, 0, size.width, size.height), getNodeToWorldTransform());
+		float limit = s_lodPolicy.minScreenHeight * (_lodCollapsed ? 1 + hysteresis : 1);
+		tooSmall = screenBounds.size.height < limit;
+	}
+
+	bool overBudget = false;
+	if (s_lodPolicy.glyphBudget > 0)
+	{
+		float limit = s_lodPolicy.glyphBudget * (_lodCollapsed ? 1 - hysteresis : 1);
+		overBudget = othersAnimating + numChars > limit;
+	}
+
+	_lodCollapsed = tooSmall || overBudget;
+
+	if (!_lodCollapsed)
+	{
+		registerAnimatedGlyphs();
+	}
+
+	return _lodCollapsed;
+}
+
+void AnimatedLabel::registerAnimatedGlyphs()
+{
+	const int numChars = getStringLength();
+
+	s_animatedGlyphCount += numChars - _registeredGlyphCount;
+	_registeredGlyphCount = numChars;
+
+	if (!isScheduled(CC_SCHEDULE_SELECTOR(AnimatedLabel::checkAnimatedGlyphs)))
+	{
+		schedule(CC_SCHEDULE_SELECTOR(AnimatedLabel::checkAnimatedGlyphs), 0.25f);
+	}
+}
+
+void AnimatedLabel::unregisterAnimatedGlyphs()
+{
+	s_animatedGlyphCount -= _registeredGlyphCount;
+	_registeredGlyphCount = 0;
+
+	unschedule(CC_SCHEDULE_SELECTOR(AnimatedLabel::checkAnimatedGlyphs));
+}
+
+void AnimatedLabel::checkAnimatedGlyphs(float dt)
+{
+	if (!isAnimatingLetters())
+	{
+		unregisterAnimatedGlyphs();
+		releaseSettledLetters();
+	}
+}
+
+bool AnimatedLabel::isAnimatingLetters() const
+{
+	if (_glyphAnimator.isRunning() || _springs.isAwake() || !_staggeredRuns.empty() || !_pendingLetterSetups.empty())
+		return true;
+
+	for (auto&& letter : _letters)
+	{
+		if (letter.second->getNumberOfRunningActions() > 0)
+			return true;
+	}
+
+	return false;
+}
+
+void AnimatedLabel::startCollapsedEffect(const GlyphEffect& effect, float startOffset)
+{
+	_lodBasePosition = getPosition();
+	_lodBaseScaleX = getScaleX();
+	_lodBaseScaleY = getScaleY();
+	_lodBaseRotation = getRotation();
+	_lodBaseOpacity = getOpacity();
+
+	//one glyph covering the whole label
+	const cocos2d::Size& size = getContentSize();
+	_lodAnimator.reset(1);
+	GlyphLayout& layout = _lodAnimator.getLayout(0);
+	layout.left = 0;
+	layout.bottom = 0;
+	layout.right = size.width;
+	layout.top = size.height;
+	layout.atlasIndex = 0;
+
+	_lodAnimator.setStartOffsets(std::vector<float>(1, startOffset));
+	_lodAnimator.setEffect(effect);
+	_lodAnimator.start();
+	applyCollapsedEffect();
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCollapsedEffect));
+}
+
+void AnimatedLabel::updateCollapsedEffect(float dt)
+{
+	TRACE_LABEL("updateCollapsedEffect");
+
+	if (_lodAnimator.update(dt))
+	{
+		applyCollapsedEffect();
+	}
+	else
+	{
+		stopCollapsedEffect();
+	}
+}
+
+void AnimatedLabel::applyCollapsedEffect()
+{
+	const GlyphState& state = _lodAnimator.getState(0);
+
+	//offsets are in the label's own space, scale them into the parent's
+	setPosition(_lodBasePosition + cocos2d::Vec2(state.offsetX * _lodBaseScaleX, state.offsetY * _lodBaseScaleY));
+	setScaleX(_lodBaseScaleX * state.scale);
+	setScaleY(_lodBaseScaleY * state.scale);
+	setRotation(_lodBaseRotation + state.rotation);
+	setOpacity(_lodBaseOpacity * std::max(0.f, std::min(1.f, state.opacity)));
+}
+
+void AnimatedLabel::stopCollapsedEffect()
+{
+	if (_lodAnimator.getGlyphCount() == 0)
+		return;
+
+	setPosition(_lodBasePosition);
+	setScaleX(_lodBaseScaleX);
+	setScaleY(_lodBaseScaleY);
+	setRotation(_lodBaseRotation);
+	setOpacity(_lodBaseOpacity);
+
+	_lodAnimator.clear();
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateCollapsedEffect));
+}
+
+//STATIC BATCH
+
+cocos2d::Sprite* AnimatedLabel::getLetter(int letterIndex)
+{
+	const bool existed = _letters.find(letterIndex) != _letters.end();
+
+	cocos2d::Sprite *letter = cocos2d::Label::getLetter(letterIndex);
+
+	if (letter != nullptr && !existed)
+	{
+		LetterRest rest;
+		rest.position = letter->getPosition();
+		rest.scaleX = letter->getScaleX();
+		rest.scaleY = letter->getScaleY();
+		rest.rotation = letter->getRotation();
+		rest.opacity = letter->getOpacity();
+		rest.color = letter->getColor();
+		_letterRest[letterIndex] = rest;
+	}
+
+	return letter;
+}
+
+bool AnimatedLabel::areLettersAtRest() const
+{
+	//moves built from several MoveBy actions drift a little, the relayout snaps them back
+	const float positionTolerance = 0.5f;
+	const float tolerance = 0.001f;
+
+	for (auto&& letter : _letters)
+	{
+		auto rest = _letterRest.find(letter.first);
+		if (rest == _letterRest.end())
+			return false;
+
+		const cocos2d::Sprite *sprite = letter.second;
+
+		//the label holds the only reference unless someone kept the sprite
+		if (sprite->getReferenceCount() > 1)
+			return false;
+
+		float rotationDifference = fmodf(sprite->getRotation() - rest->second.rotation, 360.f);
+		if (fabsf(rotationDifference) > tolerance && fabsf(fabsf(rotationDifference) - 360.f) > tolerance)
+			return false;
+
+		if (fabsf(sprite->getPosition().x - rest->second.position.x) > positionTolerance ||
+				fabsf(sprite->getPosition().y - rest->second.position.y) > positionTolerance ||
+				fabsf(sprite->getScaleX() - rest->second.scaleX) > tolerance ||
+				fabsf(sprite->getScaleY() - rest->second.scaleY) > tolerance ||
+				sprite->getOpacity() != rest->second.opacity ||
+				sprite->getColor() != rest->second.color ||
+				!sprite->isVisible())
+			return false;
+	}
+
+	return true;
+}
+
+bool AnimatedLabel::releaseSettledLetters()
+{
+	if (!_releaseSettledLetters || _letters.empty() || !areLettersAtRest())
+		return false;
+
+	//Label::removeChild may erase from _letters, so work from a copy
+	auto letters = _letters;
+	_letters.clear();
+	_letterRest.clear();
+
+	for (auto&& letter : letters)
+	{
+		removeChild(letter.second, true);
+	}
+
+	//lay out again so the quads are written straight from the layout
+	_contentDirty = true;
+
+	_lettersReleasedCount++;
+	if (_lettersReleasedCallback)
+		_lettersReleasedCallback(this);
+
+	return true;
+}
+
+//DEFERRED STRINGS
+
+static std::vector<AnimatedLabel*> s_readyStrings; //retained, in the order they were laid out
+static int s_deferredLayoutBudget = 0;
+
+void AnimatedLabel::setDeferredLayoutBudget(int glyphsPerFrame)
+{
+	s_deferredLayoutBudget = std::max(glyphsPerFrame, 0);
+}
+
+int AnimatedLabel::getDeferredLayoutBudget()
+{
+	return s_deferredLayoutBudget;
+}
+
+//the letter as GlyphTextLayout needs it, false when the atlas has no valid one
+static bool getLayoutLetter(cocos2d::FontAtlas* atlas, char32_t character, GlyphTextLayout::Letter& letter)
+{
+	cocos2d::FontLetterDefinition definition;
+	if (!atlas->getLetterDefinitionForChar(character, definition))
+		return false;
+
+	letter.offsetX = definition.offsetX;
+	letter.offsetY = definition.offsetY;
+	letter.width = definition.width;
+	letter.height = definition.height;
+	letter.xAdvance = (float)definition.xAdvance;
+	letter.atlasIndex = definition.textureID;
+	return true;
+}
+
+static void getKernings(cocos2d::FontAtlas* atlas, const std::u32string& text, std::vector<int>& kernings)
+{
+	int numLetters = 0;
+	int *letterKernings = atlas->getFont()->getHorizontalKerningForTextUTF32(text, numLetters);
+	if (letterKernings == nullptr)
+		return;
+
+	kernings.assign(letterKernings, letterKernings + numLetters);
+	delete [] letterKernings;
+}
+
+void AnimatedLabel::setStringDeferred(const std::string& text)
+{
+	TRACE_LABEL("setStringDeferred");
+
+	std::shared_ptr<PendingString> pending = std::make_shared<PendingString>();
+	pending->utf8 = text;
+	_pendingString = pending;
+
+	//laid out with the settings of now, and only committed if they still hold then
+	if (canLayOutDeferred())
+	{
+		pending->layOut = true;
+		pending->atlas = _fontAtlas;
+		pending->settings = getTextLayoutSettings();
+	}
+
+	//bitmap and char map atlases are complete and never change, so the worker reads them
+	const bool readAtlas = pending->layOut && _currentLabelType != LabelType::TTF;
+	if (readAtlas)
+	{
+		pending->atlas->retain();
+	}
+
+	//held until the worker hands back, even if the label is removed meanwhile
+	retain();
+
+	cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_OTHER, [this, pending, readAtlas](void*) {
+
+		if (readAtlas)
+		{
+			pending->atlas->release();
+		}
+
+		//back on the main thread. A newer string may have replaced this one already.
+		if (_pendingString == pending)
+		{
+			if (pending->valid && pending->layOut && !readAtlas)
+				prepareDeferredLetters(pending);
+			else
+				queueStringCommit();
+		}
+
+		release();
+
+	}, nullptr, [pending, readAtlas]() {
+
+		GLYPH_TRACE_SCOPE("layOutString", nullptr, nullptr);
+		pending->valid = cocos2d::StringUtils::UTF8ToUTF32(pending->utf8, pending->utf32);
+
+		if (pending->valid && readAtlas && !pending->utf32.empty())
+		{
+			cocos2d::FontAtlas *atlas = pending->atlas;
+			getKernings(atlas, pending->utf32, pending->kernings);
+			pending->layout.layout(pending->utf32, pending->kernings, [atlas](char32_t character, GlyphTextLayout::Letter& letter) {
+				return getLayoutLetter(atlas, character, letter);
+			}, pending->settings);
+			pending->laidOut = pending->layout.isComplete();
+		}
+	});
+}
+
+void AnimatedLabel::prepareDeferredLetters(const std::shared_ptr<PendingString>& pending)
+{
+	TRACE_LABEL("prepareDeferredLetters");
+
+	//Label lays out an empty string, or one for a font changed meanwhile, when it lands
+	if (_fontAtlas != pending->atlas || pending->utf32.empty())
+	{
+		queueStringCommit();
+		return;
+	}
+
+	//what Label::alignText would render, a new page needs its batch node made by Label
+	_fontAtlas->prepareLetterDefinitions(pending->utf32);
+	if (_fontAtlas->getTextures().size() != _batchNodes.size())
+	{
+		queueStringCommit();
+		return;
+	}
+
+	for (char32_t character : pending->utf32)
+	{
+		GlyphTextLayout::Letter letter;
+		if (pending->letters.find(character) == pending->letters.end() && getLayoutLetter(_fontAtlas, character, letter))
+			pending->letters[character] = letter;
+	}
+	getKernings(_fontAtlas, pending->utf32, pending->kernings);
+
+	retain();
+
+	cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_OTHER, [this, pending](void*) {
+
+		if (_pendingString == pending)
+		{
+			queueStringCommit();
+		}
+
+		release();
+
+	}, nullptr, [pending]() {
+
+		GLYPH_TRACE_SCOPE("layOutString", nullptr, nullptr);
+		const std::unordered_map<char32_t, GlyphTextLayout::Letter>& letters = pending->letters;
+		pending->layout.layout(pending->utf32, pending->kernings, [&letters](char32_t character, GlyphTextLayout::Letter& letter) {
+			auto found = letters.find(character);
+			if (found == letters.end())
+				return false;
+
+			letter = found->second;
+			return true;
+		}, pending->settings);
+		pending->laidOut = pending->layout.isComplete();
+	});
+}
+
+void AnimatedLabel::queueStringCommit()
+{
+	_pendingString->ready = true;
+
+	if (s_readyStrings.empty())
+	{
+		cocos2d::Director::getInstance()->getScheduler()->schedule(&AnimatedLabel::commitReadyStrings, &s_readyStrings, 0, false, "commitReadyStrings");
+	}
+	retain();
+	s_readyStrings.push_back(this);
+}
+
+//A label laid out by Label::alignText with nothing GlyphTextLayout leaves out: an atlas
+//font, no overflow handling, fitted height or underline, and nothing waiting to lay out
+bool AnimatedLabel::canLayOutDeferred() const
+{
+	return !_contentDirty && _fontAtlas != nullptr && !_batchNodes.empty() && !_systemFontDirty
+			&& _currentLabelType != LabelType::STRING_TEXTURE && getOverflow() == Overflow::NONE
+			&& _labelHeight <= 0.f && _underlineNode == nullptr;
+}
+
+GlyphTextLayout::Settings AnimatedLabel::getTextLayoutSettings() const
+{
+	GlyphTextLayout::Settings settings;
+	settings.maxLineWidth = _maxLineWidth;
+	settings.enableWrap = _enableWrap;
+	settings.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+	settings.lineHeight = _lineHeight;
+	settings.lineSpacing = _lineSpacing;
+	settings.additionalKerning = _additionalKerning;
+	//as Label's last layout worked it out, which canLayOutDeferred makes sure is current
+	settings.fontScale = _bmfontScale;
+	settings.contentScaleFactor = cocos2d::Director::getInstance()->getContentScaleFactor();
+	settings.labelWidth = _labelWidth;
+	settings.labelHeight = _labelHeight;
+	//the alignments are in the same order as cocos2d's
+	settings.hAlignment = (GlyphTextLayout::HAlignment)_hAlignment;
+	settings.vAlignment = (GlyphTextLayout::VAlignment)_vAlignment;
+	return settings;
+}
+
+void AnimatedLabel::runWhenStringSet(const std::function<void(AnimatedLabel* label)>& startEffect)
+{
+	if (_pendingString != nullptr)
+	{
+		_queuedEffects.push_back(startEffect);
+		return;
+	}
+
+	startEffect(this);
+}
+
+void AnimatedLabel::commitReadyStrings(float dt)
+{
+	GLYPH_TRACE_SCOPE("commitReadyStrings", nullptr, nullptr);
+
+	//later strings wait for the next frame once the budget is spent
+	int glyphs = 0;
+	size_t committed = 0;
+	while (committed < s_readyStrings.size() && (s_deferredLayoutBudget == 0 || committed == 0 || glyphs < s_deferredLayoutBudget))
+	{
+		AnimatedLabel *label = s_readyStrings[committed++];
+		glyphs += label->commitPendingString();
+		label->release();
+	}
+	s_readyStrings.erase(s_readyStrings.begin(), s_readyStrings.begin() + committed);
+
+	if (s_readyStrings.empty())
+	{
+		cocos2d::Director::getInstance()->getScheduler()->unschedule("commitReadyStrings", &s_readyStrings);
+	}
+}
+
+int AnimatedLabel::commitPendingString()
+{
+	//replaced, or queued again after a newer string that is still being decoded
+	if (_pendingString == nullptr || !_pendingString->ready)
+		return 0;
+
+	TRACE_LABEL("commitPendingString");
+
+	std::shared_ptr<PendingString> pending = _pendingString;
+	_pendingString.reset();
+
+	if (!pending->valid)
+	{
+		cocos2d::log("AnimatedLabel::setStringDeferred - the string isn't valid UTF-8");
+	}
+	else if (pending->utf8 != _utf8Text)
+	{
+		//logged as the setString it amounts to, on the frame it lands
+		EffectLogScope effectLog(this, "setString", {}, pending->utf8);
+
+		//before beginNewString, which may dirty the label to write the quads again
+		const bool current = isPendingLayoutCurrent(*pending);
+		beginNewString();
+
+		if (current)
+		{
+			installPendingLayout(*pending);
+		}
+		else
+		{
+			//what Label::setString does
+			_utf8Text.swap(pending->utf8);
+			_utf32Text.swap(pending->utf32);
+			_contentDirty = true;
+
+			layoutIfDirty();
+		}
+	}
+
+	startQueuedEffects();
+	return (int)_utf32Text.size();
+}
+
+bool AnimatedLabel::isPendingLayoutCurrent(const PendingString& pending)
+{
+	if (!pending.laidOut || _fontAtlas != pending.atlas || !canLayOutDeferred() || getTextLayoutSettings() != pending.settings)
+		return false;
+
+	//as Label::alignText, a TTF atlas purged meanwhile renders its letters again
+	_fontAtlas->prepareLetterDefinitions(pending.utf32);
+	return _fontAtlas->getTextures().size() == _batchNodes.size();
+}
+
+//The rest of Label::updateContent, from the layout's results
+void AnimatedLabel::installPendingLayout(PendingString& pending)
+{
+	TRACE_LABEL("installLayout");
+
+	const GlyphTextLayout& layout = pending.layout;
+	const int numLetters = (int)pending.utf32.size();
+
+	_utf8Text.swap(pending.utf8);
+	_utf32Text.swap(pending.utf32);
+	_lengthOfString = numLetters;
+
+	delete [] _horizontalKernings;
+	_horizontalKernings = nullptr;
+	if (!pending.kernings.empty())
+	{
+		_horizontalKernings = new int[pending.kernings.size()];
+		std::copy(pending.kernings.begin(), pending.kernings.end(), _horizontalKernings);
+	}
+
+	//Label only ever grows its letters, and leaves all but a placeholder's character as it was
+	if ((int)_lettersInfo.size() < numLetters)
+	{
+		_lettersInfo.resize(numLetters, LetterInfo());
+	}
+	for (int i = 0; i < numLetters; ++i)
+	{
+		const GlyphTextLayout::LetterInfo& letter = layout.getLetters()[i];
+		LetterInfo& letterInfo = _lettersInfo[i];
+		letterInfo.utf32Char = letter.character;
+		letterInfo.valid = !letter.placeholder;
+
+		if (letter.placeholder)
+			continue;
+
+		letterInfo.positionX = letter.positionX;
+		letterInfo.positionY = letter.positionY;
+		letterInfo.atlasIndex = letter.atlasIndex;
+		letterInfo.lineIndex = letter.lineIndex;
+	}
+
+	_linesWidth = layout.getLinesWidth();
+	_linesOffsetX = layout.getLinesOffsetX();
+	_numberOfLines = layout.getNumberOfLines();
+	_textDesiredHeight = layout.getTextDesiredHeight();
+	_letterOffsetY = layout.getLetterOffsetY();
+	setContentSize(cocos2d::Size(layout.getWidth(), layout.getHeight()));
+
+	if (_batchNodes.size() == 1)
+	{
+		_batchNodes.at(0)->reserveCapacity(numLetters);
+	}
+	updateQuads();
+	updateLabelLetters();
+	updateColor();
+
+	_contentDirty = false;
+	_hitGridDirty = true;
+	_letterPagesDirty = true;
+}
+
+void AnimatedLabel::startQueuedEffects()
+{
+	//an effect may queue more behind a string of its own, those wait for that one
+	std::vector<std::function<void(AnimatedLabel* label)>> effects;
+	effects.swap(_queuedEffects);
+
+	for (size_t i = 0; i < effects.size(); ++i)
+	{
+		if (_pendingString != nullptr)
+		{
+			_queuedEffects.insert(_queuedEffects.begin(), effects.begin() + i, effects.end());
+			break;
+		}
+
+		effects[i](this);
+	}
+}
+
+//BAKED EFFECTS
+
+static GlyphBakeCache s_bakeCache;
+
+void AnimatedLabel::setBakeCacheLimit(size_t bytes)
+{
+	s_bakeCache.setByteLimit(bytes);
+}
+
+const GlyphBakeCache::Stats& AnimatedLabel::getBakeCacheStats()
+{
+	return s_bakeCache.getStats();
+}
+
+void AnimatedLabel::clearBakeCache()
+{
+	s_bakeCache.clear();
+}
+
+void AnimatedLabel::playBakedEffect(const std::string& name, float duration, const std::function<void(AnimatedLabel* label)>& startEffect, bool removeOnCompletion /* = false */)
+{
+	TRACE_LABEL("playBakedEffect");
+	EffectLogScope effectLog(this, kUnreplayableCall, {}, "playBakedEffect");
+
+	stopBakedEffect();
+
+	if (duration <= 0 || !prepareBakedGlyphs())
+	{
+		startEffect(this);
+		return;
+	}
+
+	_bakeKey = getBakeKey(name);
+	_bakeElapsed = 0.f;
+	_bakeDuration = duration;
+	_bakeRemoveOnCompletion = removeOnCompletion;
+
+	_bakedClip = s_bakeCache.find(_bakeKey);
+	if (_bakedClip != nullptr && _bakedClip->getGlyphCount() == (int)_bakedLayouts.size())
+	{
+		applyBakedFrame();
+	}
+	else
+	{
+		//captured as it's drawn, from this frame on
+		_bakedClip.reset();
+		_bakeCapture = std::make_shared<GlyphBakedClip>();
+		_bakeCapture->beginCapture((int)_bakedLayouts.size(), _bakedRest.data());
+
+		startEffect(this);
+	}
+
+	startTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateBakedEffect));
+}
+
+void AnimatedLabel::stopBakedEffect()
+{
+	if (_bakeCapture == nullptr && _bakedClip == nullptr && _bakeKey.empty())
+		return;
+
+	//only a clip that ran to the end is worth keeping
+	_bakeCapture.reset();
+
+	//the layout writes the quads back at rest
+	if (_bakedClip != nullptr)
+	{
+		_bakedClip.reset();
+		_contentDirty = true;
+	}
+
+	_bakeKey.clear();
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateBakedEffect));
+}
+
+bool AnimatedLabel::prepareBakedGlyphs()
+{
+	//the clip is the whole picture, so nothing else may be moving the glyphs
+	if (isAnimatingLetters() || _glyphAnimator.getGlyphCount() > 0 || _colorAnimationRunning || _lodCollapsed)
+		return false;
+
+	releaseSettledLetters();
+	if (!_letters.empty())
+		return false;
+
+	layoutIfDirty();
+
+	const int numChars = std::min(_lengthOfString, (int)_lettersInfo.size());
+	_bakedLayouts.resize(numChars);
+	_bakedRest.assign(numChars * 8, 0.f);
+
+	for (int i = 0; i < numChars; ++i)
+	{
+		GlyphLayout& layout = _bakedLayouts[i];
+		if (!getRestLayout(i, layout))
+		{
+			layout.atlasIndex = -1;
+			continue;
+		}
+
+		float *rest = &_bakedRest[i * 8];
+		rest[0] = rest[4] = layout.left;
+		rest[2] = rest[6] = layout.right;
+		rest[1] = rest[3] = layout.bottom;
+		rest[5] = rest[7] = layout.top;
+	}
+
+	return numChars > 0;
+}
+
+std::string AnimatedLabel::getBakeKey(const std::string& name) const
+{
+	//the text alone doesn't pin the quads down, the font, size and alignment do
+	size_t layoutKey = (size_t)_fontAtlas;
+	const std::hash<float> hashFloat;
+	for (auto&& rest : _bakedRest)
+	{
+		layoutKey = layoutKey * 31 + hashFloat(rest);
+	}
+	for (auto&& layout : _bakedLayouts)
+	{
+		layoutKey = layoutKey * 31 + (size_t)(layout.page + 1);
+	}
+
+	//captured colours already have the label's colour and opacity in them
+	char suffix[64];
+	snprintf(suffix, sizeof(suffix), "|%zx|%02x%02x%02x%02x", layoutKey, _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
+
+	return name + "|" + _utf8Text + suffix;
+}
+
+void AnimatedLabel::captureBakedFrame()
+{
+	TRACE_LABEL("captureBakedFrame");
+
+	const int numChars = (int)_bakedLayouts.size();
+	_bakeCorners.assign(numChars * 8, 0.f);
+	_bakeColors.assign(numChars * 16, 0);
+
+	for (int i = 0; i < numChars; ++i)
+	{
+		cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(_bakedLayouts[i]);
+		if (quad == nullptr)
+			continue;
+
+		float *corners = &_bakeCorners[i * 8];
+		corners[0] = quad->bl.vertices.x; corners[1] = quad->bl.vertices.y;
+		corners[2] = quad->br.vertices.x; corners[3] = quad->br.vertices.y;
+		corners[4] = quad->tl.vertices.x; corners[5] = quad->tl.vertices.y;
+		corners[6] = quad->tr.vertices.x; corners[7] = quad->tr.vertices.y;
+
+		unsigned char *colors = &_bakeColors[i * 16];
+		const cocos2d::Color4B *cornerColors[4] = { &quad->bl.colors, &quad->br.colors, &quad->tl.colors, &quad->tr.colors };
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			colors[corner * 4] = cornerColors[corner]->r;
+			colors[corner * 4 + 1] = cornerColors[corner]->g;
+			colors[corner * 4 + 2] = cornerColors[corner]->b;
+			colors[corner * 4 + 3] = cornerColors[corner]->a;
+		}
+	}
+
+	_bakeCapture->addFrame(_bakeElapsed, _bakeCorners.data(), _bakeColors.data());
+
+	if (_bakeElapsed >= _bakeDuration)
+	{
+		finishBakeCapture();
+	}
+}
+
+void AnimatedLabel::finishBakeCapture()
+{
+	TRACE_LABEL("finishBakeCapture");
+
+	if (_bakeCapture->finishCapture())
+	{
+		s_bakeCache.insert(_bakeKey, _bakeCapture);
+	}
+
+	_bakeCapture.reset();
+}
+
+void AnimatedLabel::updateBakedEffect(float dt)
+{
+	_bakeElapsed += dt;
+
+	if (_bakedClip != nullptr)
+	{
+		//another effect has taken the glyphs over, let it have them
+		if (!_letters.empty() || _glyphAnimator.getGlyphCount() > 0 || _colorAnimationRunning)
+		{
+			_bakeRemoveOnCompletion = false;
+		}
+		else
+		{
+			applyBakedFrame();
+			if (_bakeElapsed < _bakedClip->getDuration())
+				return;
+		}
+
+		//the quads keep the clip's last frame, which is where the effect left them
+		_bakedClip.reset();
+	}
+	else if (_bakeCapture != nullptr)
+	{
+		//the frame reaching the duration is captured once it has been drawn
+		return;
+	}
+
+	_bakeKey.clear();
+	stopTimeline(CC_SCHEDULE_SELECTOR(AnimatedLabel::updateBakedEffect));
+
+	if (_bakeRemoveOnCompletion)
+	{
+		removeFromParent();
+	}
+}
+
+void AnimatedLabel::applyBakedFrame()
+{
+	TRACE_LABEL("applyBakedFrame");
+
+	float blend;
+	const int keyframe = _bakedClip->findKeyframe(_bakeElapsed, blend);
+	const bool colors = _bakedClip->hasColors();
+	float corners[8];
+	unsigned char cornerColors[16];
+
+	for (int i = 0, numChars = (int)_bakedLayouts.size(); i < numChars; ++i)
+	{
+		cocos2d::V3F_C4B_T2F_Quad *quad = getGlyphQuad(_bakedLayouts[i]);
+		if (quad == nullptr)
+			continue;
+
+		_bakedClip->sampleGlyph(keyframe, blend, i, &_bakedRest[i * 8], corners, cornerColors);
+
+		quad->bl.vertices.x = corners[0]; quad->bl.vertices.y = corners[1];
+		quad->br.vertices.x = corners[2]; quad->br.vertices.y = corners[3];
+		quad->tl.vertices.x = corners[4]; quad->tl.vertices.y = corners[5];
+		quad->tr.vertices.x = corners[6]; quad->tr.vertices.y = corners[7];
+
+		if (colors)
+		{
+			quad->bl.colors = cocos2d::Color4B(cornerColors[0], cornerColors[1], cornerColors[2], cornerColors[3]);
+			quad->br.colors = cocos2d::Color4B(cornerColors[4], cornerColors[5], cornerColors[6], cornerColors[7]);
+			quad->tl.colors = cocos2d::Color4B(cornerColors[8], cornerColors[9], cornerColors[10], cornerColors[11]);
+			quad->tr.colors = cocos2d::Color4B(cornerColors[12], cornerColors[13], cornerColors[14], cornerColors[15]);
+		}
+	}
+
+	for (auto&& batchNode : _batchNodes)
+	{
+		batchNode->getTextureAtlas()->setDirty(true);
+	}
+}
+
+//IDLE DETECTION
+
+//What changed in one frame, across every AnimatedLabel
+struct FrameChanges
+{
+	unsigned int frame;
+	bool changed;
+	cocos2d::Rect dirtyRect;
+};
+
+//the frame being drawn and the one before it
+static FrameChanges s_frameChanges = { (unsigned int)-1, false, cocos2d::Rect::ZERO };
+static FrameChanges s_previousFrameChanges = { (unsigned int)-1, false, cocos2d::Rect::ZERO };
+
+static FrameChanges& getFrameChanges()
+{
+	const unsigned int frame = cocos2d::Director::getInstance()->getTotalFrames();
+	if (s_frameChanges.frame != frame)
+	{
+		s_previousFrameChanges = s_frameChanges;
+		s_frameChanges.frame = frame;
+		s_frameChanges.changed = false;
+		s_frameChanges.dirtyRect = cocos2d::Rect::ZERO;
+	}
+	return s_frameChanges;
+}
+
+//the total frame count moves on once a frame has been drawn, so the last frame drawn is
+//the one before it, whether or not the next one has started visiting labels
+static const FrameChanges* getLastDrawnFrameChanges()
+{
+	const unsigned int lastFrame = cocos2d::Director::getInstance()->getTotalFrames() - 1;
+	if (s_frameChanges.frame == lastFrame)
+		return &s_frameChanges;
+	if (s_previousFrameChanges.frame == lastFrame)
+		return &s_previousFrameChanges;
+	return nullptr;
+}
+
+static void addDirtyRect(cocos2d::Rect& dirtyRect, const cocos2d::Rect& rect)
+{
+	if (rect.equals(cocos2d::Rect::ZERO))
+		return;
+
+	dirtyRect = dirtyRect.equals(cocos2d::Rect::ZERO) ? rect : dirtyRect.unionWithRect(rect);
+}
+
+bool AnimatedLabel::isAnythingAnimating()
+{
+	const FrameChanges *changes = getLastDrawnFrameChanges();
+	return changes != nullptr && changes->changed;
+}
+
+cocos2d::Rect AnimatedLabel::getDirtyRect()
+{
+	const FrameChanges *changes = getLastDrawnFrameChanges();
+	return changes != nullptr ? changes->dirtyRect : cocos2d::Rect::ZERO;
+}
+
+void AnimatedLabel::onExit()
+{
+	//where the label was drawn needs drawing again without it
+	if (!_drawnRect.equals(cocos2d::Rect::ZERO))
+	{
+		FrameChanges& frameChanges = getFrameChanges();
+		frameChanges.changed = true;
+		addDirtyRect(frameChanges.dirtyRect, _drawnRect);
+		_drawnRect = cocos2d::Rect::ZERO;
+	}
+
+	//a capture cut short isn't kept
+	stopBakedEffect();
+
+	cocos2d::Label::onExit();
+}
+
+bool AnimatedLabel::hasChangesToDraw(uint32_t parentFlags) const
+{
+	//not drawn, so only going out of sight is a change
+	if (!isVisible())
+		return !_drawnRect.equals(cocos2d::Rect::ZERO);
+
+	if (_contentDirty || !_timelines.empty() || getNumberOfRunningActions() > 0)
+		return true;
+
+	//moved, scaled or rotated, itself or through a parent
+	if (!_drawnBefore || _transformUpdated || (parentFlags & FLAGS_DIRTY_MASK))
+		return true;
+
+	if (getDisplayedOpacity() != _drawnOpacity || getDisplayedColor() != _drawnColor)
+		return true;
+
+	if (isAnimatingLetters())
+		return true;
+
+	//letters moved by hand are dirty until the label has drawn them
+	for (auto&& letter : _letters)
+	{
+		if (letter.second->isDirty())
+			return true;
+	}
+
+	return false;
+}
+
+void AnimatedLabel::recordFrameChanges(bool changed)
+{
+	FrameChanges& frameChanges = getFrameChanges();
+
+	_idle = !changed;
+	if (!changed)
+		return;
+
+	TRACE_LABEL("recordFrameChanges");
+
+	const cocos2d::Rect drawnRect = isVisible() ? getDrawnRect() : cocos2d::Rect::ZERO;
+
+	frameChanges.changed = true;
+	addDirtyRect(frameChanges.dirtyRect, _drawnRect);
+	addDirtyRect(frameChanges.dirtyRect, drawnRect);
+
+	_drawnRect = drawnRect;
+	_drawnBefore = true;
+	_drawnOpacity = getDisplayedOpacity();
+	_drawnColor = getDisplayedColor();
+}
+
+cocos2d::Rect AnimatedLabel::getDrawnRect()
+{
+	//every quad the label draws, compact glyphs and letter sprites included, is in its atlases
+	float left = FLT_MAX, bottom = FLT_MAX, right = -FLT_MAX, top = -FLT_MAX;
+
+	for (auto&& batchNode : _batchNodes)
+	{
+		cocos2d::TextureAtlas *textureAtlas = batchNode->getTextureAtlas();
+		const cocos2d::V3F_C4B_T2F_Quad *quads = textureAtlas->getQuads();
+
+		for (ssize_t i = 0, numQuads = textureAtlas->getTotalQuads(); i < numQuads; ++i)
+		{
+			for (const cocos2d::V3F_C4B_T2F *corner : { &quads[i].bl, &quads[i].br, &quads[i].tl, &quads[i].tr })
+			{
+				left = std::min(left, corner->vertices.x);
+				right = std::max(right, corner->vertices.x);
+				bottom = std::min(bottom, corner->vertices.y);
+				top = std::max(top, corner->vertices.y);
+			}
+		}
+	}
+
+	if (left > right)
+		return cocos2d::Rect::ZERO;
+
+	return cocos2d::RectApplyTransform(cocos2d::Rect(left, bottom, right - left, top - bottom), getNodeToWorldTransform());
 }
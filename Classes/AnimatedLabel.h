@@ -21,7 +21,24 @@
 #define __AnimatedLabel_h__
 
 #include <stdio.h>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
 #include "cocos2d.h"
+#include "AnimatedLabelAtlas.h"
+#include "GlyphAnimator.h"
+#include "GlyphBake.h"
+#include "GlyphEffectLog.h"
+#include "GlyphHitGrid.h"
+#include "GlyphRandom.h"
+#include "GlyphRecording.h"
+#include "GlyphSprings.h"
+#include "GlyphStagger.h"
+#include "GlyphTextLayout.h"
+
+class AnimatedLabelBatch;
+class AnimatedLabelChoreographer;
 
 class AnimatedLabel : public cocos2d::Label
 {
@@ -53,6 +70,263 @@ class AnimatedLabel : public cocos2d::Label
 		//Note: if there's a need to add a delay to the, using a Node::scheduleOnce will suffice.
 		void runActionOnAllSpritesSequentially(cocos2d::FiniteTimeAction* action, float duration, float initialDelay = 0.f, bool removeOnCompletion = false, cocos2d::CallFunc *callFuncOnCompletion = nullptr);
 		void runActionOnAllSpritesSequentiallyReverse(cocos2d::FiniteTimeAction* action, float duration, float initialDelay = 0.f, bool removeOnCompletion = false, cocos2d::CallFunc *callFuncOnCompletion = nullptr);
+		//Same as above, but the stagger decides the order the letters start in.
+		//The sequential functions above are this with GlyphStagger::linear() and
+		//GlyphStagger::linearReverse(). Works with any number of letters.
+		void runActionOnAllSpritesStaggered(cocos2d::FiniteTimeAction* action, const GlyphStagger& stagger, float duration, float initialDelay = 0.f, bool removeOnCompletion = false, cocos2d::CallFunc *callFuncOnCompletion = nullptr);
+
+		//Overrides the start order of the built in sequential animations below,
+		//e.g. setEffectStagger(GlyphStagger::fromCenter()) before animateInSwell(2).
+		void setEffectStagger(const GlyphStagger& stagger);
+		void resetEffectStagger();
+
+		//SETUP BUDGET
+		//Spreads the per letter setup of an effect over several frames, spending at most
+		//budget seconds per frame (at least one letter is always set up). Letters are set up
+		//in start order just before they are due and fast forwarded by however late they
+		//are, so a long string starts moving straight away instead of hitching.
+		//A budget of 0 (the default) sets everything up in the frame the effect starts.
+		struct SetupStats
+		{
+			float lastFrameTime; //seconds spent setting up letters in the most recent frame
+			float totalTime; //seconds spent on the current (or last) effect
+			int frames; //frames the setup was spread over
+			int lettersSetUp;
+			int lettersPending;
+		};
+		void setSetupBudget(float budget) { _setupBudget = budget; }
+		float getSetupBudget() const { return _setupBudget; }
+		const SetupStats& getSetupStats() const { return _setupStats; }
+
+		//COMPACT ANIMATIONS
+		//When enabled, the built in effects that can be described as per letter tracks
+		//(fly ins, drop from top, typewriter without callbacks, swells, jump, stretch elastic,
+		//vortex, paths and the letters of animateInSpin) keep a few tens of bytes of state
+		//per letter in a single block owned by the label and write the letter quads directly,
+		//instead of creating a letter sprite and a cloned action tree for every character.
+		//The other effects and the custom action functions always use letter sprites.
+		void setCompactAnimation(bool enabled);
+		bool isCompactAnimation() const { return _compactAnimation; }
+		bool isCompactAnimationRunning() const { return _glyphAnimator.isRunning(); }
+		void stopCompactAnimation();
+
+		//WORD AND LINE GROUPS
+		//Words (runs of characters between white space) and lines of the layout can be
+		//animated as a whole: the effect is evaluated once per group and moves, scales and
+		//rotates the group around its centre, on top of whatever per letter compact effect
+		//is running. Group effects always use the compact state, whatever
+		//setCompactAnimation says. The stagger sees one entry per group, at its centre.
+		int getWordCount();
+		void runGroupEffect(GlyphAnimator::GroupLevel level, const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, float initialDelay = 0.f);
+
+		//ANIMATION LAYERS
+		//Compact effects blended on top of whatever per letter effect is running, so an
+		//idle wobble can keep going under an entrance or a hit reaction. Every layer adds
+		//its change from rest times its weight (0 to 1) to each letter. A layer that doesn't
+		//loop and ends at rest removes itself when it finishes, otherwise it holds its last
+		//values until removed. Removing a layer, faded or not, leaves the other layers and
+		//the main effect running where they are.
+		//Layers always use the compact state, whatever setCompactAnimation says, and a
+		//label collapsed by its level of detail policy doesn't take any: the add functions
+		//return 0 for it. Layer ids start at 1.
+		int addAnimationLayer(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, bool loop = false, float fadeIn = 0.f, float weight = 1.f);
+		void fadeAnimationLayer(int layer, float weight, float duration);
+		void removeAnimationLayer(int layer, float fadeOut = 0.f);
+		bool hasAnimationLayer(int layer) const { return _glyphAnimator.hasLayer(layer); }
+
+		//looping layers, amplitude in degrees and scale the peak size
+		int addWobbleLayer(float amplitude, float period);
+		int addPulseLayer(float scale, float period);
+
+		//LEVEL OF DETAIL
+		//Per letter motion on a tiny label, or on the hundredth label on screen, can't be
+		//seen but still costs full price. An effect started on a label shorter than
+		//minScreenHeight (in points, after every parent's scale) or while more than
+		//glyphBudget letters are already animating across all AnimatedLabels animates the
+		//label as a single node instead (whole label position, scale, rotation and opacity).
+		//A collapsed label only goes back to per letter animation once it is clear of both
+		//limits by the hysteresis fraction, so labels close to a limit don't flip back and
+		//forth. A limit of 0 is disabled, both are disabled by default.
+		struct LODPolicy
+		{
+			float minScreenHeight;
+			int glyphBudget;
+			float hysteresis;
+
+			LODPolicy() : minScreenHeight(0), glyphBudget(0), hysteresis(0.2f) {}
+		};
+		static void setLODPolicy(const LODPolicy& policy);
+		static const LODPolicy& getLODPolicy();
+		//letters of every AnimatedLabel currently animating one by one
+		static int getAnimatedGlyphCount();
+		bool isLODCollapsed() const { return _lodCollapsed; }
+
+		//STATIC BATCH
+		//Once no letter is animating any more and every letter sprite is back at the
+		//position, scale, rotation, opacity and colour it was created with, the sprites
+		//are released and the label goes back to drawing its quads as a single batch
+		//until the next effect creates them again. Letter sprites retained elsewhere
+		//keep the label on the letter sprite path. Enabled by default.
+		typedef std::function<void(AnimatedLabel* label)> LettersReleasedCallback;
+		void setReleaseSettledLetters(bool enabled) { _releaseSettledLetters = enabled; }
+		bool isReleaseSettledLetters() const { return _releaseSettledLetters; }
+		void setLettersReleasedCallback(const LettersReleasedCallback& callback) { _lettersReleasedCallback = callback; }
+		bool hasLetterSprites() const { return !_letters.empty(); }
+		//times this label has gone back to the static batch
+		int getLettersReleasedCount() const { return _lettersReleasedCount; }
+
+		//IDLE DETECTION
+		//A label is idle when nothing about how it draws changed the last time it was drawn:
+		//no timeline stepping, no action on the label or its letters, no letter moved, no
+		//new layout and no change of transform, colour or opacity, its own or a parent's.
+		//The statics cover every AnimatedLabel in the frame drawn last, so an app showing
+		//static text can lower its frame rate or skip drawing until something animates.
+		bool isIdle() const { return _idle; }
+		static bool isAnythingAnimating();
+		//world space bounds (points) of where changed labels were drawn before and are
+		//drawn now, labels that went away included. Empty when nothing changed.
+		static cocos2d::Rect getDirtyRect();
+
+		virtual cocos2d::Sprite* getLetter(int letterIndex) override;
+
+		//MEMORY
+		//Bytes owned by the label for animating its letters.
+		//letterSprites is a lower bound (sizeof(cocos2d::Sprite) per letter sprite) and the
+		//cocos2d actions running on letter sprites are only counted, not sized.
+		struct MemoryUsage
+		{
+			size_t glyphState; //compact per letter state, start offsets included
+			size_t actions; //effect descriptions, pending staggered runs and letter setups
+			size_t layout; //letter info, quads and index buffers of the label's atlases, compact layout
+			size_t letterSprites;
+			int letterSpriteCount;
+			int letterActionCount;
+
+			size_t getTotal() const { return glyphState + actions + layout + letterSprites; }
+		};
+		MemoryUsage getMemoryUsage() const;
+
+		//EFFECT ARENA
+		//What the label keeps while a staggered effect or a budgeted setup is starting its
+		//letters (start offsets, start order, pending letter setups) comes from a small
+		//arena owned by the label. It is reset in one go once every letter has started, or
+		//when the label gets a new string, so after the first few effects it has grown to
+		//what they need and starting another one makes no heap allocation for its state.
+		//The actions cloned onto the letter sprites are created by cocos2d and freed by
+		//reference counting, so they aren't part of it: compact animations avoid them.
+		struct EffectArenaStats
+		{
+			int allocations; //made from the arena since it was last reset
+			int chunkAllocations; //heap allocations made by the arena over the label's life
+			int resets;
+			size_t bytesUsed;
+			size_t bytesReserved;
+		};
+		EffectArenaStats getEffectArenaStats() const;
+
+		//CHOREOGRAPHER
+		//While the label is in an AnimatedLabelChoreographer, its per frame timelines
+		//(compact, group, spring, colour, collapsed effects, staggered starts and budgeted
+		//setup) are stepped by the choreographer's single update instead of scheduler
+		//entries of its own. nullptr when it isn't in one.
+		AnimatedLabelChoreographer* getChoreographer() const { return _choreographer; }
+
+		//SHARED ATLAS
+		//Draws the label's quads from the atlas' pages instead of its font's own texture,
+		//so labels with different fonts on the same page batch into one draw call (see
+		//AnimatedLabelAtlas). Labels with a shadow, outline, glow or distance field keep
+		//drawing from their font, and so does a label in the frame its glyphs are copied
+		//in when the atlas has already copied glyphs for another label that frame.
+		//Every AnimatedLabel reports the commands it draws with to the active
+		//GlyphDrawCounter, whether it uses a shared atlas or not.
+		void setSharedAtlas(AnimatedLabelAtlas* atlas);
+		AnimatedLabelAtlas* getSharedAtlas() const { return _sharedAtlas; }
+
+		//SPRINGS
+		//Every letter hangs on a damped spring around its place in the layout. Impulses
+		//add to the springs' current motion, so they can be retriggered mid flight and
+		//driven by input, and the springs sleep once every letter is back at rest, so
+		//they cost nothing on a label that isn't being poked. They move the compact
+		//quads, on top of any compact or group effect; letters that have a letter
+		//sprite follow the sprite instead. Positions are in the label's space.
+		void setSpringStiffness(float stiffness) { _springs.setStiffness(stiffness); }
+		void setSpringDamping(float damping) { _springs.setDamping(damping); }
+		void springImpulse(int index, const cocos2d::Vec2& velocity);
+		//pushes letters away from point, strength is the speed given at the point itself
+		void springRipple(const cocos2d::Vec2& point, float strength, float radius);
+		void springShake(float strength);
+		//pulls every letter away from the label's centre by amount times its distance, then lets go
+		void springStretch(float amount);
+		bool isSpringAwake() const { return _springs.isAwake(); }
+
+		//LINE BREAKS
+		//Index of the first character of every line the label lays out, wrapped to its max
+		//line width, so a caller can split text the way the label would
+		void getLineStarts(std::vector<int>& starts);
+
+		//HIT TESTING
+		//The character drawn under point (in the label's space) as it's drawn now, with
+		//every effect, spring and letter sprite applied, so a letter spinning or flying
+		//in is hit where it shows. The glyphs' quads are kept in a GlyphHitGrid that's
+		//only refreshed, at most once a frame, while letters are moving, so on a still
+		//label a test costs the same whatever the length of its text.
+		//index, word and line are -1 when nothing is hit. For a touch:
+		//  label->hitTestGlyph(label->convertToNodeSpace(touch->getLocation()))
+		struct GlyphHit
+		{
+			int index;
+			int word;
+			int line;
+		};
+		GlyphHit hitTestGlyph(const cocos2d::Vec2& point);
+
+		//GOLDEN SAMPLES
+		//Position (label space), scale, rotation, opacity and colour of every character as
+		//it would be drawn now, whether a letter sprite, the compact state or the plain
+		//layout is placing it. Characters without a glyph sample as all zeros.
+		//The colour is the bottom left corner's when a colour animation is running.
+		void sampleGlyphs(std::vector<GlyphSample>& samples);
+		//Starts an effect and samples every character at each timestamp (seconds after the
+		//start, ascending), stepping the Director's scheduler by dt in between, so the result
+		//can be compared against a stored golden GlyphRecording. The label must be running
+		//in the current scene. Give the label a seed first (setRandomSeed) so effects drawing
+		//random numbers match between runs. AnimatedLabelGoldens records every effect this way
+		//and checks the compact forms against the sprite ones; the compact engine alone is
+		//also checked headless, without a Director, by Tests/GlyphGoldenTests.
+		GlyphRecording recordEffect(const std::function<void(AnimatedLabel* label)>& startEffect, const std::vector<float>& timestamps, float dt = 1.f/60);
+
+		//RANDOMNESS
+		//Effects that vary letters at random (the vortex, springShake) draw from the label's
+		//own generator rather than cocos2d::random(). New labels are seeded one after another
+		//from a sequence, so a run creating the same labels in the same order plays the same;
+		//setRandomSeed pins a label down whatever order it was made in.
+		void setRandomSeed(unsigned int seed);
+		static void setLabelSeedSequence(unsigned int seed);
+
+		//EFFECT LOG
+		//While the log runs, calls made on any label from outside its own effects are logged
+		//with their arguments and the scheduler time they were made at: setString,
+		//setRandomSeed, setCompactAnimation, the named animations above, animateColorsRainbow,
+		//animateColorsGradient, the wobble and pulse layers and the spring kicks. A string
+		//set with setStringDeferred is logged as a setString on the frame it lands. Where a
+		//label first appears its font, size or BMFont image offset, alignments, line width,
+		//dimensions, position, scale, rotation, anchor point, compact flag and random state
+		//are logged, and the label it was added to, logged before it, if it's in one.
+		//Replay adds the others to the parent it's given. Calls taking actions, GlyphEffects,
+		//paths or callbacks (the runAction
+		//functions, animateInAlongPath, animateColors, runGroupEffect, addAnimationLayer and
+		//playBakedEffect) are logged as unreplayable by name only, and replayEffectLog warns
+		//when it reaches one. animateInTypewriter is logged without its callbacks.
+		static void startEffectLog();
+		static GlyphEffectLog stopEffectLog();
+		static bool isEffectLogRunning();
+		//Creates the log's labels under parent, which must be running in the current scene,
+		//and makes its calls at their times while stepping the Director's scheduler by dt as
+		//recordEffect does. The calls land on the same steps however long the frames took
+		//when they were logged, so a hitch replays the same way every time. onStep runs
+		//after each step, to sample, draw or time the labels. Returns once the last call has
+		//been made and the labels have run settleTime more.
+		static void replayEffectLog(const GlyphEffectLog& log, cocos2d::Node* parent, float dt = 1.f/60, float settleTime = 0.f, const std::function<void(float time)>& onStep = nullptr);
 
 		//ANIMATIONS
 
@@ -69,13 +343,353 @@ class AnimatedLabel : public cocos2d::Label
 		void animateInRevealFromLeft(float duration);
 		void animateInSpin(float duration, int spins);
 		void animateInVortex(float duration, int spins, bool removeOnCompletion = false, bool createGhosts = true);
+		//letters travel along path at a constant speed (before easing), each offset so the
+		//path ends where the letter rests, started one after the other over staggerDuration
+		void animateInAlongPath(const GlyphPath& path, float pathDuration, float staggerDuration, GlyphEffect::Ease ease = GlyphEffect::Ease::SINE_OUT);
 
 		//misc animations
 		void animateSwell(float duration);
+		//In compact mode, jump and stretch elastic retriggered mid flight hand the letters'
+		//current offsets to the springs (see SPRINGS), which carry them back to rest on top
+		//of the new effect, so the letters don't snap back to the layout first
 		void animateJump(float duration, float height);
 		void animateStretchElastic(float stretchDuration, float releaseDuration, float stretchAmount);
 		void animateRainbow(float duration);
 		void flyPastAndRemove();
+
+		//word and line animations
+		void animateWordsJump(float duration, float height);
+		void animateInLinesFlyInFromLeft(float duration);
+
+		//PER-VERTEX COLOUR ANIMATIONS
+		//These write colours straight into the label's quads once per frame instead
+		//of running TintTo actions on every letter sprite.
+		//Each glyph (or each glyph corner when perCorner is set) samples the palette at
+		//  elapsed/cycleDuration + spreadX * x/labelWidth + spreadY * y/labelHeight
+		//so a spread of 1 fits the whole palette across the label once.
+		//A duration of 0 keeps the animation running until stopColorAnimation().
+		//The corners passed to a ColorFunction are ordered bottom left, bottom right,
+		//top left, top right.
+		typedef std::function<void(int index, float elapsed, cocos2d::Color4B* corners)> ColorFunction;
+		void animateColorsRainbow(float cycleDuration, float spread = 1.f, bool perCorner = false, float duration = 0.f);
+		void animateColorsGradient(const std::vector<cocos2d::Color4B>& palette, float cycleDuration, float spreadX = 1.f, float spreadY = 0.f, bool perCorner = false, float duration = 0.f);
+		void animateColors(const ColorFunction& colorFunction, float duration = 0.f);
+		void stopColorAnimation();
+		bool isColorAnimationRunning() const { return _colorAnimationRunning; }
+
+		virtual void setString(const std::string& text) override;
+		//remembers the image offset, for the effect log
+		virtual bool setBMFontFilePath(const std::string& bmfontFilePath, const cocos2d::Vec2& imageOffset = cocos2d::Vec2::ZERO, float fontSize = 0) override;
+
+		//DEFERRED STRINGS
+		//setStringDeferred decodes the text and breaks it into lines and letter positions on a
+		//worker thread (GlyphTextLayout), and the layout lands at the start of a later frame,
+		//where it is copied into the label and its quads in one pass over the glyphs.
+		//Bitmap and char map fonts are read on the worker, their atlases never change. A TTF
+		//font's letters are rendered into its atlas and copied on the main thread in between,
+		//as FreeType and the atlas can't leave it, so a TTF string takes a frame longer.
+		//Label lays the string out itself when it lands if the worker can't: system fonts,
+		//overflow, a fixed height, underlines, \b in the text, a letter needing a new atlas
+		//page, or the font or layout settings changed since the call. With the budget
+		//(glyphs per frame, 0 for no limit, the default) many large strings, say on a screen
+		//transition, land over several frames, at least one string a frame. setString or
+		//another setStringDeferred replaces a string still on its way.
+		void setStringDeferred(const std::string& text);
+		bool isStringPending() const { return _pendingString != nullptr; }
+		//Starts the effect once the pending string has been laid out, or straight away when
+		//there is none. Queued effects start in order, on whichever string is set next.
+		void runWhenStringSet(const std::function<void(AnimatedLabel* label)>& startEffect);
+		static void setDeferredLayoutBudget(int glyphsPerFrame);
+		static int getDeferredLayoutBudget();
+
+		//BAKED EFFECTS
+		//Plays an effect from a clip of the label's quads baked the first time it ran on a
+		//label with the same name, text, layout, colour and opacity. On a miss startEffect
+		//runs as usual and its first duration seconds are captured as they are drawn; a hit
+		//replays the keyframes straight into the quads without building or stepping any
+		//actions. The label has to be at rest without letter sprites to bake or replay,
+		//otherwise startEffect just runs. Only the label's own glyphs are captured, not
+		//callbacks, ghost labels or a level of detail collapse, so bake effects that move,
+		//scale, rotate and colour the glyphs. removeOnCompletion removes the label once the
+		//clip has been captured or played.
+		void playBakedEffect(const std::string& name, float duration, const std::function<void(AnimatedLabel* label)>& startEffect, bool removeOnCompletion = false);
+		bool isPlayingBakedEffect() const { return _bakedClip != nullptr; }
+		//drops a capture in progress, or puts the glyphs back at rest
+		void stopBakedEffect();
+		//clips are shared by every label, least recently used go first past the limit (1MB)
+		static void setBakeCacheLimit(size_t bytes);
+		static const GlyphBakeCache::Stats& getBakeCacheStats();
+		static void clearBakeCache();
+
+	protected:
+
+		virtual ~AnimatedLabel();
+
+		virtual void visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTransform, uint32_t parentFlags) override;
+		virtual void draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags) override;
+		virtual void onExit() override;
+
+	private:
+
+		//containers of the effect state kept while letters are being started, see EFFECT ARENA
+		template <class T> using EffectVector = std::vector<T, GlyphArenaAllocator<T>>;
+
+		void recycleEffectArena();
+
+		//declared before the containers it backs, so it outlives their elements
+		GlyphArena _effectArena{2 * 1024};
+		int _effectArenaResets = 0;
+		int _effectArenaHolds = 0; //runs being set up outside _staggeredRuns, the arena isn't recycled under them
+		std::vector<GlyphStagger::Glyph> _staggerGlyphs; //scratch, keeps its capacity between effects
+		std::vector<float> _staggerOffsets; //scratch, keeps its capacity between effects
+
+		//A sequential action waiting for its letters' start offsets
+		struct StaggeredRun
+		{
+			cocos2d::FiniteTimeAction *action; //retained, cloned onto each letter
+			cocos2d::Vector<cocos2d::FiniteTimeAction*> completion; //appended to the last letter to start
+			EffectVector<float> offsets; //start offset of every character
+			EffectVector<int> order; //indices of the characters with a letter sprite, by start offset
+			int next;
+			float elapsed;
+
+			explicit StaggeredRun(GlyphArena* arena) : action(nullptr), offsets(arena), order(arena), next(0), elapsed(0) {}
+
+			//a cleared vector still holds its buffer, swap the buffers out before the arena is recycled
+			void releaseBuffers()
+			{
+				EffectVector<float>(offsets.get_allocator()).swap(offsets);
+				EffectVector<int>(order.get_allocator()).swap(order);
+			}
+		};
+
+		//Builds the action for one letter, called as late as the setup budget allows
+		typedef std::function<cocos2d::FiniteTimeAction*(cocos2d::Sprite* letter)> LetterActionBuilder;
+
+		struct PendingLetterSetup
+		{
+			int index;
+			float startTime; //on the setup clock
+			LetterActionBuilder builder;
+		};
+
+		void queueLetterSetup(int index, float startOffset, const LetterActionBuilder& builder);
+		void flushLetterSetup();
+		void processLetterSetup();
+		void updateLetterSetup(float dt);
+		void clearLetterSetup();
+		void startLetterAction(cocos2d::Sprite* letter, cocos2d::FiniteTimeAction* action, float lateBy);
+		void recordSetupTime(float seconds, int lettersSetUp);
+
+		EffectVector<PendingLetterSetup> _pendingLetterSetups = EffectVector<PendingLetterSetup>(&_effectArena);
+		size_t _nextLetterSetup = 0;
+		float _setupElapsed = 0.f;
+		float _setupBudget = 0.f;
+		SetupStats _setupStats = SetupStats();
+
+		bool useGlyphEffect();
+		//variants picks the effect's variant keys per letter (see GlyphAnimator::setVariants)
+		void startGlyphEffect(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, float initialDelay = 0.f, const std::vector<unsigned char>& variants = std::vector<unsigned char>());
+		void snapshotGlyphLayout();
+		bool getRestLayout(int index, GlyphLayout& layout);
+		//the batch node (font atlas page) holding the character's quad, -1 if there's none
+		int getLetterPage(int index) const;
+		//getLetterPage for every character, cached until the label is laid out again
+		const std::vector<int>& getLetterPages();
+		//lays the label out now rather than on its next visit
+		void layoutIfDirty();
+		void updateCompactAnimation(float dt);
+		void applyCompactAnimation(bool atRest);
+		float getCompactOpacity(int index) const;
+		cocos2d::V3F_C4B_T2F_Quad* getGlyphQuad(const GlyphLayout& layout);
+
+		//declared first so it outlives the animator's block when the label goes
+		std::shared_ptr<GlyphArena> _arena;
+		GlyphAnimator _glyphAnimator;
+		bool _compactAnimation = false;
+		std::vector<int> _letterPages;
+		bool _letterPagesDirty = true;
+
+		//made by AnimatedLabelBatch: storage sized for numGlyphs before the layout
+		friend class AnimatedLabelBatch;
+		void prepareForBatch(const std::shared_ptr<GlyphArena>& arena, int numGlyphs);
+
+		//per frame updates, on the scheduler or stepped by the choreographer
+		friend class AnimatedLabelChoreographer;
+		void startTimeline(cocos2d::SEL_SCHEDULE selector);
+		void stopTimeline(cocos2d::SEL_SCHEDULE selector);
+		void tickTimelines(float dt);
+		void setChoreographer(AnimatedLabelChoreographer* choreographer);
+		void setActionsPaused(bool paused);
+
+		std::vector<cocos2d::SEL_SCHEDULE> _timelines;
+		AnimatedLabelChoreographer *_choreographer = nullptr;
+
+		bool prepareSprings();
+		void updateSprings(float dt);
+		//Hands the offsets of a compact effect cut short to the springs, see animateJump
+		void handOverToSprings();
+
+		GlyphSprings _springs;
+
+		void refreshHitGrid();
+		size_t getHitGridLayoutKey() const;
+
+		GlyphHitGrid _hitGrid;
+		std::vector<GlyphStagger::Glyph> _hitGlyphs; //words and lines of the grid's glyphs
+		unsigned int _hitGridFrame = (unsigned int)-1;
+		size_t _hitGridLayout = 0;
+		bool _hitGridDirty = true;
+		bool _hitGridMoving = false; //letters were moving at the last refresh
+
+		//A string decoded and laid out on a worker, waiting to be committed. The worker
+		//writes it, the main thread reads it once the worker has handed back.
+		struct PendingString
+		{
+			std::string utf8;
+			std::u32string utf32;
+			bool valid = false;
+			bool ready = false; //queued for a commit
+			bool layOut = false; //the label's layout can be done on the worker
+			bool laidOut = false;
+			cocos2d::FontAtlas *atlas = nullptr;
+			GlyphTextLayout::Settings settings;
+			std::unordered_map<char32_t, GlyphTextLayout::Letter> letters; //a TTF font's, copied on the main thread
+			std::vector<int> kernings;
+			GlyphTextLayout layout;
+		};
+
+		void beginNewString();
+		bool canLayOutDeferred() const;
+		GlyphTextLayout::Settings getTextLayoutSettings() const;
+		void prepareDeferredLetters(const std::shared_ptr<PendingString>& pending);
+		void queueStringCommit();
+		bool isPendingLayoutCurrent(const PendingString& pending);
+		void installPendingLayout(PendingString& pending);
+		int commitPendingString();
+		void startQueuedEffects();
+		static void commitReadyStrings(float dt);
+
+		std::shared_ptr<PendingString> _pendingString;
+		std::vector<std::function<void(AnimatedLabel* label)>> _queuedEffects;
+
+		bool prepareBakedGlyphs();
+		std::string getBakeKey(const std::string& name) const;
+		void captureBakedFrame();
+		void finishBakeCapture();
+		void updateBakedEffect(float dt);
+		void applyBakedFrame();
+
+		std::shared_ptr<GlyphBakedClip> _bakeCapture; //being captured
+		std::shared_ptr<const GlyphBakedClip> _bakedClip; //being played
+		std::string _bakeKey;
+		std::vector<GlyphLayout> _bakedLayouts; //per character, atlasIndex -1 without a quad
+		std::vector<float> _bakedRest; //8 corners per character
+		std::vector<float> _bakeCorners; //scratch for one frame
+		std::vector<unsigned char> _bakeColors; //scratch for one frame
+		float _bakeElapsed = 0.f;
+		float _bakeDuration = 0.f;
+		bool _bakeRemoveOnCompletion = false;
+
+		//Logs a call made from outside the label's own effects, see EFFECT LOG
+		class EffectLogScope
+		{
+			public:
+				//a null label isn't logged, but still keeps the calls inside the scope out of the log
+				EffectLogScope(AnimatedLabel* label, const char* name, std::initializer_list<double> args, const std::string& text = std::string());
+				EffectLogScope(AnimatedLabel* label, const char* name, const std::vector<double>& args, const std::string& text = std::string());
+				~EffectLogScope();
+		};
+
+		static unsigned int nextLabelSeed();
+		static void tickEffectLog(float dt);
+		static void replayEffectCall(const GlyphEffectLog::Call& call, cocos2d::Node* parent, std::vector<AnimatedLabel*>& labels);
+		int getEffectLogIndex();
+		void logEffectCall(const char* name, const std::vector<double>& args, const std::string& text);
+
+		GlyphRandom _random = GlyphRandom(nextLabelSeed());
+		cocos2d::Vec2 _bmfontImageOffset;
+
+		bool hasChangesToDraw(uint32_t parentFlags) const;
+		void recordFrameChanges(bool changed);
+		cocos2d::Rect getDrawnRect();
+
+		bool _idle = false;
+		cocos2d::Rect _drawnRect; //world space, empty while the label isn't drawn
+		bool _drawnBefore = false;
+		GLubyte _drawnOpacity = 0;
+		cocos2d::Color3B _drawnColor;
+
+		bool drawFromSharedAtlas(cocos2d::Renderer* renderer, const cocos2d::Mat4& transform, uint32_t flags);
+		void countDraw();
+
+		AnimatedLabelAtlas *_sharedAtlas = nullptr;
+		std::vector<AnimatedLabelAtlas::Glyph> _sharedGlyphs; //per character, page -1 without a quad
+		std::vector<std::vector<cocos2d::V3F_C4B_T2F_Quad>> _sharedQuads; //per atlas page
+		std::vector<std::unique_ptr<cocos2d::QuadCommand>> _sharedCommands; //per atlas page, they own index buffers so can't be copied
+
+		bool updateLOD();
+		void registerAnimatedGlyphs();
+		void unregisterAnimatedGlyphs();
+		void checkAnimatedGlyphs(float dt);
+		bool isAnimatingLetters() const;
+		void startCollapsedEffect(const GlyphEffect& effect, float startOffset);
+		void updateCollapsedEffect(float dt);
+		void applyCollapsedEffect();
+		void stopCollapsedEffect();
+
+		//what a letter sprite looked like when it was created
+		struct LetterRest
+		{
+			cocos2d::Vec2 position;
+			float scaleX;
+			float scaleY;
+			float rotation;
+			GLubyte opacity;
+			cocos2d::Color3B color;
+		};
+
+		bool areLettersAtRest() const;
+		bool releaseSettledLetters();
+
+		std::unordered_map<int, LetterRest> _letterRest;
+		bool _releaseSettledLetters = true;
+		int _lettersReleasedCount = 0;
+		LettersReleasedCallback _lettersReleasedCallback;
+
+		bool _lodCollapsed = false;
+		int _registeredGlyphCount = 0;
+		GlyphAnimator _lodAnimator;
+		cocos2d::Vec2 _lodBasePosition;
+		float _lodBaseScaleX = 1.f;
+		float _lodBaseScaleY = 1.f;
+		float _lodBaseRotation = 0.f;
+		GLubyte _lodBaseOpacity = 255;
+
+		GlyphStagger getEffectStagger(bool reverse) const;
+		void runEffectStaggered(cocos2d::FiniteTimeAction* action, float duration, bool reverse, float initialDelay = 0.f, bool removeOnCompletion = false, cocos2d::CallFunc *callFuncOnCompletion = nullptr);
+		void collectStaggerGlyphs(std::vector<GlyphStagger::Glyph>& glyphs);
+		bool advanceStaggeredRun(StaggeredRun& run);
+		void updateStaggeredRuns(float dt);
+		void clearStaggeredRuns();
+
+		EffectVector<StaggeredRun> _staggeredRuns = EffectVector<StaggeredRun>(&_effectArena);
+		GlyphStagger _effectStagger;
+		bool _hasEffectStagger = false;
+
+		void updateColorAnimation(float dt);
+		void applyColorAnimation();
+		void startColorAnimation(float duration);
+
+		bool _colorAnimationRunning = false;
+		float _colorAnimationElapsed = 0.f;
+		float _colorAnimationDuration = 0.f;
+		float _colorCycleDuration = 1.f;
+		float _colorSpreadX = 0.f;
+		float _colorSpreadY = 0.f;
+		bool _colorPerCorner = false;
+		std::vector<cocos2d::Color4B> _colorLookup; //palette resampled to a fixed size, indexed by phase
+		ColorFunction _colorFunction;
 };
 
 #endif /* __AnimatedLabel_h__ */
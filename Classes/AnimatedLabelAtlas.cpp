@@ -0,0 +1,241 @@
+//
+//  AnimatedLabelAtlas.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AnimatedLabelAtlas.h"
+
+#include <float.h>
+#include <math.h>
+
+//Copies a TTF page's alpha as premultiplied white, the label's colour is applied when
+//it draws
+static const char* kAlphaCopyFrag =
+	"#ifdef GL_ES\n"
+	"precision lowp float;\n"
+	"#endif\n"
+	"varying vec4 v_fragmentColor;\n"
+	"varying vec2 v_texCoord;\n"
+	"void main()\n"
+	"{\n"
+	"    float alpha = texture2D(CC_Texture0, v_texCoord).a;\n"
+	"    gl_FragColor = vec4(alpha, alpha, alpha, alpha);\n"
+	"}\n";
+
+//Copies a BMFont page that wasn't premultiplied when it was loaded
+static const char* kPremultiplyCopyFrag =
+	"#ifdef GL_ES\n"
+	"precision lowp float;\n"
+	"#endif\n"
+	"varying vec4 v_fragmentColor;\n"
+	"varying vec2 v_texCoord;\n"
+	"void main()\n"
+	"{\n"
+	"    vec4 texel = texture2D(CC_Texture0, v_texCoord);\n"
+	"    gl_FragColor = vec4(texel.rgb * texel.a, texel.a);\n"
+	"}\n";
+
+//CREATE FUNCTIONS
+
+AnimatedLabelAtlas* AnimatedLabelAtlas::create(int pageWidth /* = 1024 */, int pageHeight /* = 1024 */)
+{
+	auto ret = new (std::nothrow) AnimatedLabelAtlas(pageWidth, pageHeight);
+
+	if (ret)
+	{
+		ret->autorelease();
+		return ret;
+	}
+
+	return nullptr;
+}
+
+AnimatedLabelAtlas::AnimatedLabelAtlas(int pageWidth, int pageHeight)
+: _packer(pageWidth, pageHeight)
+, _flushedFrame((unsigned int)-1)
+{
+	_drawState = cocos2d::GLProgramState::getOrCreateWithGLProgramName(cocos2d::GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+	_drawState->retain();
+
+	_alphaCopyState = cocos2d::GLProgramState::create(cocos2d::GLProgram::createWithByteArrays(cocos2d::ccPositionTextureColor_noMVP_vert, kAlphaCopyFrag));
+	_alphaCopyState->retain();
+
+	_premultiplyCopyState = cocos2d::GLProgramState::create(cocos2d::GLProgram::createWithByteArrays(cocos2d::ccPositionTextureColor_noMVP_vert, kPremultiplyCopyFrag));
+	_premultiplyCopyState->retain();
+}
+
+AnimatedLabelAtlas::~AnimatedLabelAtlas()
+{
+	for (cocos2d::FontAtlas *fontAtlas : _fonts)
+	{
+		fontAtlas->release();
+	}
+
+	for (Copy& copy : _pendingCopies)
+	{
+		copy.sprite->release();
+	}
+
+	_drawState->release();
+	_alphaCopyState->release();
+	_premultiplyCopyState->release();
+}
+
+//GLYPHS
+
+bool AnimatedLabelAtlas::getGlyph(cocos2d::FontAtlas* fontAtlas, char32_t utf32Char, Glyph& glyph)
+{
+	if (fontAtlas == nullptr)
+		return false;
+
+	cocos2d::FontLetterDefinition letterDef;
+	if (!fontAtlas->getLetterDefinitionForChar(utf32Char, letterDef) || !letterDef.validDefinition || letterDef.rotated)
+		return false;
+
+	//letter definitions are in points, the pages in pixels
+	const float scale = CC_CONTENT_SCALE_FACTOR();
+	const uint64_t key = GlyphAtlasPacker::makeKey(getFontId(fontAtlas), utf32Char);
+
+	GlyphAtlasPacker::Region region;
+	if (!_packer.find(key, region))
+	{
+		region = _packer.pack(key, (int)ceilf(letterDef.width * scale), (int)ceilf(letterDef.height * scale));
+		if (region.page < 0)
+			return false;
+
+		while (region.page >= (int)_pages.size())
+		{
+			addPage();
+		}
+
+		cocos2d::Texture2D *texture = fontAtlas->getTexture(letterDef.textureID);
+		cocos2d::Sprite *sprite = cocos2d::Sprite::createWithTexture(texture, cocos2d::Rect(letterDef.U, letterDef.V, letterDef.width, letterDef.height));
+		sprite->setAnchorPoint(cocos2d::Vec2::ZERO);
+		sprite->setPosition(region.x / scale, region.y / scale);
+		sprite->setBlendFunc(cocos2d::BlendFunc::DISABLE);
+		sprite->setGLProgramState(getCopyState(texture));
+		sprite->retain();
+
+		Copy copy;
+		copy.sprite = sprite;
+		copy.page = region.page;
+		_pendingCopies.push_back(copy);
+	}
+
+	//a render texture's rows go from the bottom up
+	const float pageWidth = (float)_packer.getPageWidth();
+	const float pageHeight = (float)_packer.getPageHeight();
+	glyph.page = region.page;
+	glyph.bottomLeft.u = region.x / pageWidth;
+	glyph.bottomLeft.v = region.y / pageHeight;
+	glyph.topRight.u = (region.x + letterDef.width * scale) / pageWidth;
+	glyph.topRight.v = (region.y + letterDef.height * scale) / pageHeight;
+	return true;
+}
+
+bool AnimatedLabelAtlas::flush()
+{
+	if (_pendingCopies.empty())
+		return true;
+
+	const unsigned int frame = cocos2d::Director::getInstance()->getTotalFrames();
+	if (frame == _flushedFrame)
+		return false;
+
+	_flushedFrame = frame;
+
+	//the copies queued by the last flush have been rendered by now
+	_queuedCopies.clear();
+
+	for (int page = 0, numPages = (int)_pages.size(); page < numPages; ++page)
+	{
+		cocos2d::RenderTexture *renderTexture = nullptr;
+
+		for (Copy& copy : _pendingCopies)
+		{
+			if (copy.page != page)
+				continue;
+
+			if (renderTexture == nullptr)
+			{
+				renderTexture = _pages.at(page);
+				renderTexture->begin();
+			}
+
+			copy.sprite->visit();
+			_queuedCopies.pushBack(copy.sprite);
+		}
+
+		if (renderTexture != nullptr)
+		{
+			renderTexture->end();
+		}
+	}
+
+	for (Copy& copy : _pendingCopies)
+	{
+		copy.sprite->release();
+	}
+	_pendingCopies.clear();
+
+	return true;
+}
+
+cocos2d::Texture2D* AnimatedLabelAtlas::getPageTexture(int page) const
+{
+	if (page < 0 || page >= (int)_pages.size())
+		return nullptr;
+
+	return _pages.at(page)->getSprite()->getTexture();
+}
+
+size_t AnimatedLabelAtlas::getTextureBytes() const
+{
+	return _pages.size() * (size_t)_packer.getPageWidth() * _packer.getPageHeight() * 4;
+}
+
+int AnimatedLabelAtlas::getFontId(cocos2d::FontAtlas* fontAtlas)
+{
+	for (int font = 0, numFonts = (int)_fonts.size(); font < numFonts; ++font)
+	{
+		if (_fonts[font] == fontAtlas)
+			return font;
+	}
+
+	fontAtlas->retain();
+	_fonts.push_back(fontAtlas);
+	return (int)_fonts.size() - 1;
+}
+
+cocos2d::GLProgramState* AnimatedLabelAtlas::getCopyState(cocos2d::Texture2D* texture)
+{
+	if (texture->getPixelFormat() == cocos2d::Texture2D::PixelFormat::A8)
+		return _alphaCopyState;
+
+	if (!texture->hasPremultipliedAlpha())
+		return _premultiplyCopyState;
+
+	return _drawState;
+}
+
+void AnimatedLabelAtlas::addPage()
+{
+	const float scale = CC_CONTENT_SCALE_FACTOR();
+
+	cocos2d::RenderTexture *renderTexture = cocos2d::RenderTexture::create(_packer.getPageWidth() / scale, _packer.getPageHeight() / scale, cocos2d::Texture2D::PixelFormat::RGBA8888);
+	//copies go ahead of everything else in the frame, whatever the labels' global z order
+	renderTexture->setGlobalZOrder(-FLT_MAX);
+	renderTexture->getSprite()->getTexture()->setAntiAliasTexParameters();
+	_pages.pushBack(renderTexture);
+}
@@ -0,0 +1,94 @@
+//
+//  AnimatedLabelAtlas.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __AnimatedLabelAtlas_h__
+#define __AnimatedLabelAtlas_h__
+
+#include <vector>
+#include "cocos2d.h"
+#include "GlyphAtlasPacker.h"
+
+//Texture pages shared by every label drawing from them, whatever BMFont or TTF config
+//they use. A label given an atlas copies each glyph it shows into the pages the first
+//time it's needed (on the GPU, through a RenderTexture) and then draws its quads with
+//the page's texture and one shared shader and blend function, so consecutive labels
+//on the same page batch into a single draw call instead of one (or, for TTF labels,
+//one per font page) each.
+//Pages hold premultiplied RGBA. Font atlases with glyphs in the pages are retained, so
+//a glyph is never copied twice and a font atlas freed and another allocated at the
+//same address can't be mistaken for it.
+//  AnimatedLabelAtlas *atlas = AnimatedLabelAtlas::create();
+//  hudScore->setSharedAtlas(atlas);
+//  hudTitle->setSharedAtlas(atlas);
+class AnimatedLabelAtlas : public cocos2d::Ref
+{
+	public:
+
+		//page size in pixels
+		static AnimatedLabelAtlas* create(int pageWidth = 1024, int pageHeight = 1024);
+
+		struct Glyph
+		{
+			int page;
+			cocos2d::Tex2F bottomLeft; //texture coordinates of the glyph's corners
+			cocos2d::Tex2F topRight;
+		};
+
+		//Where the font atlas' glyph is in the pages, queueing its copy when it isn't yet.
+		//false for glyphs that can't be shared (rotated in their font page, or larger
+		//than a page).
+		bool getGlyph(cocos2d::FontAtlas* fontAtlas, char32_t utf32Char, Glyph& glyph);
+		//Adds the copies queued since the last flush to the render queue, ahead of any
+		//label. The pages' render commands can only be queued once a frame, so a glyph
+		//first needed after that waits for the next one: false while copies are waiting.
+		bool flush();
+
+		int getPageCount() const { return (int)_pages.size(); }
+		cocos2d::Texture2D* getPageTexture(int page) const;
+		int getGlyphCount() const { return _packer.getGlyphCount(); }
+		//the shader every label drawing from the atlas uses, shared so their commands batch
+		cocos2d::GLProgramState* getDrawState() const { return _drawState; }
+		size_t getTextureBytes() const;
+
+	protected:
+
+		AnimatedLabelAtlas(int pageWidth, int pageHeight);
+		virtual ~AnimatedLabelAtlas();
+
+	private:
+
+		struct Copy
+		{
+			cocos2d::Sprite *sprite;
+			int page;
+		};
+
+		int getFontId(cocos2d::FontAtlas* fontAtlas);
+		cocos2d::GLProgramState* getCopyState(cocos2d::Texture2D* texture);
+		void addPage();
+
+		GlyphAtlasPacker _packer;
+		cocos2d::Vector<cocos2d::RenderTexture*> _pages;
+		std::vector<cocos2d::FontAtlas*> _fonts; //retained, the index is the font's id
+		std::vector<Copy> _pendingCopies;
+		cocos2d::Vector<cocos2d::Sprite*> _queuedCopies; //kept until the frame they were queued in is rendered
+		unsigned int _flushedFrame;
+		cocos2d::GLProgramState *_drawState;
+		cocos2d::GLProgramState *_alphaCopyState;
+		cocos2d::GLProgramState *_premultiplyCopyState;
+};
+
+#endif /* __AnimatedLabelAtlas_h__ */
@@ -0,0 +1,189 @@
+//
+//  AnimatedLabelBatch.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AnimatedLabelBatch.h"
+#include "GlyphTrace.h"
+
+#include <algorithm>
+#include <chrono>
+
+//CREATE FUNCTIONS
+
+AnimatedLabelBatch* AnimatedLabelBatch::create(const std::vector<Entry>& entries)
+{
+	auto ret = new (std::nothrow) AnimatedLabelBatch();
+
+	if (ret && ret->init(entries))
+	{
+		ret->autorelease();
+		return ret;
+	}
+
+	delete ret;
+	return nullptr;
+}
+
+AnimatedLabelBatch::AnimatedLabelBatch()
+: _arena(std::make_shared<GlyphArena>())
+, _createSeconds(0)
+{
+}
+
+AnimatedLabelBatch::~AnimatedLabelBatch()
+{
+	for (AnimatedLabel *label : _labels)
+	{
+		CC_SAFE_RELEASE(label);
+	}
+}
+
+bool AnimatedLabelBatch::init(const std::vector<Entry>& entries)
+{
+	GLYPH_TRACE_SCOPE("createBatch", this, nullptr);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<std::u32string> texts(entries.size());
+	size_t numGlyphs = 0;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		cocos2d::StringUtils::UTF8ToUTF32(entries[i].text, texts[i]);
+		numGlyphs += texts[i].size();
+	}
+
+	std::vector<int> fontOfEntry;
+	loadFonts(entries, texts, fontOfEntry);
+
+	//every label's glyph block in one chunk
+	_arena->reserve(numGlyphs * GlyphAnimator::getBytesPerGlyph());
+
+	_labels.reserve(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const Entry& entry = entries[i];
+		const Font& font = _fonts[fontOfEntry[i]];
+		AnimatedLabel *label = nullptr;
+
+		if (font.atlas != nullptr)
+		{
+			label = new (std::nothrow) AnimatedLabel();
+
+			bool fontSet = false;
+			if (label != nullptr)
+			{
+				if (entry.fontSize > 0)
+					fontSet = label->setTTFConfig(cocos2d::TTFConfig(entry.fontFile.c_str(), entry.fontSize, cocos2d::GlyphCollection::DYNAMIC));
+				else
+					fontSet = label->setBMFontFilePath(entry.fontFile);
+			}
+
+			if (fontSet)
+			{
+				label->prepareForBatch(_arena, (int)texts[i].size());
+				label->setMaxLineWidth(entry.maxLineWidth);
+				label->setAlignment(entry.alignment, cocos2d::TextVAlignment::TOP);
+				label->setString(entry.text);
+
+				//lay out now, while the font's letters are hot, rather than on the first visit
+				label->layoutIfDirty();
+			}
+			else
+			{
+				delete label;
+				label = nullptr;
+			}
+		}
+
+		if (label == nullptr)
+		{
+			cocos2d::log("AnimatedLabelBatch - Could not create a label with font %s", entry.fontFile.c_str());
+		}
+
+		//created with a reference already, no autorelease needed
+		_labels.push_back(label);
+	}
+
+	for (Font& font : _fonts)
+	{
+		if (font.atlas != nullptr)
+		{
+			cocos2d::FontAtlasCache::releaseFontAtlas(font.atlas);
+		}
+	}
+	std::vector<Font>().swap(_fonts);
+
+	_createSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+void AnimatedLabelBatch::loadFonts(const std::vector<Entry>& entries, const std::vector<std::u32string>& texts, std::vector<int>& fontOfEntry)
+{
+	fontOfEntry.resize(entries.size());
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const Entry& entry = entries[i];
+		const float size = std::max(entry.fontSize, 0.f);
+
+		//a screen uses a handful of fonts, a linear search beats a map
+		int fontIndex = -1;
+		for (int font = 0; font < (int)_fonts.size(); ++font)
+		{
+			if (_fonts[font].size == size && _fonts[font].file == entry.fontFile)
+			{
+				fontIndex = font;
+				break;
+			}
+		}
+
+		if (fontIndex < 0)
+		{
+			Font font;
+			font.file = entry.fontFile;
+			font.size = size;
+
+			if (size > 0)
+			{
+				cocos2d::TTFConfig ttfConfig(entry.fontFile.c_str(), size, cocos2d::GlyphCollection::DYNAMIC);
+				font.atlas = cocos2d::FileUtils::getInstance()->isFileExist(entry.fontFile) ? cocos2d::FontAtlasCache::getFontAtlasTTF(&ttfConfig) : nullptr;
+			}
+			else
+			{
+				font.atlas = cocos2d::FontAtlasCache::getFontAtlasFNT(entry.fontFile);
+			}
+
+			_fonts.push_back(font);
+			fontIndex = (int)_fonts.size() - 1;
+		}
+
+		fontOfEntry[i] = fontIndex;
+		if (size > 0)
+		{
+			_fonts[fontIndex].glyphs += texts[i];
+		}
+	}
+
+	//each TTF font renders everything the batch needs in one go
+	for (Font& font : _fonts)
+	{
+		if (font.atlas == nullptr || font.glyphs.empty())
+			continue;
+
+		std::sort(font.glyphs.begin(), font.glyphs.end());
+		font.glyphs.erase(std::unique(font.glyphs.begin(), font.glyphs.end()), font.glyphs.end());
+		font.atlas->prepareLetterDefinitions(font.glyphs);
+	}
+}
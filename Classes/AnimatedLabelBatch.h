@@ -0,0 +1,93 @@
+//
+//  AnimatedLabelBatch.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __AnimatedLabelBatch_h__
+#define __AnimatedLabelBatch_h__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "AnimatedLabel.h"
+#include "GlyphArena.h"
+
+//Makes the labels of a whole screen (a menu, a results table) in one go, instead of
+//one create call each. Every font is looked up once, TTF fonts render the glyphs of
+//every entry into their atlas in one pass (one texture upload instead of one per
+//label), every label is laid out straight away with its letter storage sized up front,
+//and their compact glyph blocks all come from one arena, released with the last of
+//the batch's labels. Only those blocks share the arena: each label's letter info
+//(_lettersInfo) and the quads of its batch nodes are still heap allocated per label
+//by cocos2d::Label, sized up front but not shared. Text layout stays on the main
+//thread, font atlases and their textures can't be touched from anywhere else.
+//AnimatedLabelBenchmark::runBatchCreation times a batch against one create call
+//per entry.
+//  std::vector<AnimatedLabelBatch::Entry> entries;
+//  entries.push_back(AnimatedLabelBatch::Entry("Play", "fonts/NBFont1.fnt"));
+//  entries.push_back(AnimatedLabelBatch::Entry("Best: 1200", "fonts/arial.ttf", 30));
+//  AnimatedLabelBatch *batch = AnimatedLabelBatch::create(entries);
+//  menu->addChild(batch->getLabel(0));
+class AnimatedLabelBatch : public cocos2d::Ref
+{
+	public:
+
+		struct Entry
+		{
+			std::string text;
+			std::string fontFile;
+			float fontSize; //0 for a BMFont, otherwise the TTF size
+			float maxLineWidth; //0 for no wrapping
+			cocos2d::TextHAlignment alignment;
+
+			Entry(const std::string& t, const std::string& font, float size = 0.f, float lineWidth = 0.f, cocos2d::TextHAlignment align = cocos2d::TextHAlignment::LEFT)
+			: text(t), fontFile(font), fontSize(size), maxLineWidth(lineWidth), alignment(align) {}
+		};
+
+		static AnimatedLabelBatch* create(const std::vector<Entry>& entries);
+
+		int getLabelCount() const { return (int)_labels.size(); }
+		//in the order of the entries, nullptr when the entry's font couldn't be loaded
+		AnimatedLabel* getLabel(int index) const { return _labels[index]; }
+
+		//wall time create() took, fonts and layout included
+		float getCreateSeconds() const { return _createSeconds; }
+		const GlyphArena& getArena() const { return *_arena; }
+
+	protected:
+
+		AnimatedLabelBatch();
+		virtual ~AnimatedLabelBatch();
+
+	private:
+
+		struct Font
+		{
+			std::string file;
+			float size;
+			cocos2d::FontAtlas *atlas; //held while the batch is made
+			std::u32string glyphs; //every character the batch needs, TTF only
+		};
+
+		bool init(const std::vector<Entry>& entries);
+		void loadFonts(const std::vector<Entry>& entries, const std::vector<std::u32string>& texts, std::vector<int>& fontOfEntry);
+
+		std::vector<AnimatedLabel*> _labels; //retained
+		std::vector<Font> _fonts;
+		std::shared_ptr<GlyphArena> _arena;
+		float _createSeconds;
+};
+
+#endif /* __AnimatedLabelBatch_h__ */
@@ -0,0 +1,244 @@
+//
+//  AnimatedLabelBenchmark.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "AnimatedLabelBenchmark.h"
+#include "AnimatedLabel.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+//HEAP ALLOCATION COUNTING
+//Replacing operator new is program wide, so it's only compiled into benchmark builds.
+//Only the thread that asked for counting is counted.
+
+#ifdef ANIMATED_LABEL_BENCHMARKS
+
+static thread_local bool s_countAllocations = false;
+static thread_local int s_allocations = 0;
+
+void* operator new(size_t size)
+{
+	if (s_countAllocations)
+		++s_allocations;
+
+	void *pointer = malloc(size > 0 ? size : 1);
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	if (s_countAllocations)
+		++s_allocations;
+
+	return malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+//heap allocations made by work on this thread, -1 when they can't be counted
+static int countAllocations(const std::function<void()>& work)
+{
+	s_allocations = 0;
+	s_countAllocations = true;
+	work();
+	s_countAllocations = false;
+	return s_allocations;
+}
+
+#else
+
+static int countAllocations(const std::function<void()>& work)
+{
+	work();
+	return -1;
+}
+
+#endif
+
+static float secondsSince(const BenchmarkClock::time_point& start)
+{
+	return std::chrono::duration<float>(BenchmarkClock::now() - start).count();
+}
+
+//BATCH CREATION
+
+std::vector<AnimatedLabelBatch::Entry> AnimatedLabelBenchmark::makeResultsTable(int rows, const std::string& bmfontFile, const std::string& ttfFile, float ttfSize)
+{
+	std::vector<AnimatedLabelBatch::Entry> entries;
+	entries.reserve(rows * 2);
+
+	for (int row = 0; row < rows; ++row)
+	{
+		entries.push_back(AnimatedLabelBatch::Entry(cocos2d::StringUtils::format("%d. Player %d", row + 1, row * 7 + 3), bmfontFile));
+		entries.push_back(AnimatedLabelBatch::Entry(cocos2d::StringUtils::format("%d", 100000 - row * 1234), ttfFile, ttfSize, 0.f, cocos2d::TextHAlignment::RIGHT));
+	}
+
+	return entries;
+}
+
+//one create call per entry, as a table would be made without the batch
+static void createPerCall(const std::vector<AnimatedLabelBatch::Entry>& entries, cocos2d::Vector<AnimatedLabel*>& labels)
+{
+	for (const AnimatedLabelBatch::Entry& entry : entries)
+	{
+		AnimatedLabel *label = nullptr;
+		if (entry.fontSize > 0)
+			label = AnimatedLabel::createWithTTF(entry.text, entry.fontFile, entry.fontSize, cocos2d::Size(entry.maxLineWidth, 0), entry.alignment);
+		else
+			label = AnimatedLabel::createWithBMFont(entry.fontFile, entry.text, entry.alignment, (int)entry.maxLineWidth);
+
+		if (label == nullptr)
+			continue;
+
+		//lays the label out, as the batch does before it returns
+		label->getContentSize();
+		labels.pushBack(label);
+	}
+}
+
+AnimatedLabelBenchmark::BatchTimes AnimatedLabelBenchmark::runBatchCreation(const std::vector<AnimatedLabelBatch::Entry>& entries, int repeats /* = 10 */)
+{
+	BatchTimes times = BatchTimes();
+	times.labels = (int)entries.size();
+	times.repeats = std::max(repeats, 1);
+
+	//the labels are kept until the round is timed, so freeing them isn't counted
+	cocos2d::Vector<AnimatedLabel*> labels;
+	labels.reserve(entries.size());
+
+	for (int round = -1; round < times.repeats; ++round)
+	{
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		AnimatedLabelBatch *batch = AnimatedLabelBatch::create(entries);
+		const float batchSeconds = secondsSince(start);
+		CC_SAFE_RETAIN(batch);
+
+		start = BenchmarkClock::now();
+		createPerCall(entries, labels);
+		const float perCallSeconds = secondsSince(start);
+
+		CC_SAFE_RELEASE(batch);
+		labels.clear();
+
+		//round -1 warms the font caches up
+		if (round >= 0)
+		{
+			times.batchSeconds += batchSeconds / times.repeats;
+			times.perCallSeconds += perCallSeconds / times.repeats;
+		}
+	}
+
+	cocos2d::log("AnimatedLabelBenchmark: %d labels, average of %d runs: batch %.3fms, one create call each %.3fms (%.2fx)",
+			times.labels, times.repeats, times.batchSeconds * 1000, times.perCallSeconds * 1000,
+			times.batchSeconds > 0 ? times.perCallSeconds / times.batchSeconds : 0.f);
+
+	return times;
+}
+
+//EFFECT ALLOCATIONS
+
+struct BenchmarkEffect
+{
+	const char *name;
+	std::function<void(AnimatedLabel* label)> start;
+};
+
+//heap allocations of the first call, and the average heap and arena allocations of the rest
+static void countEffectAllocations(cocos2d::Node* parent, const std::string& bmfontFile, bool compact, const BenchmarkEffect& effect, int repeats, int& first, int& steady, int& arena)
+{
+	AnimatedLabel *label = AnimatedLabel::createWithBMFont(bmfontFile, "Animated Label", cocos2d::TextHAlignment::CENTER);
+	if (label == nullptr)
+	{
+		first = steady = arena = -1;
+		return;
+	}
+
+	label->setCompactAnimation(compact);
+	label->setPosition(cocos2d::Vec2(parent->getContentSize().width/2, parent->getContentSize().height/2));
+	parent->addChild(label);
+
+	first = countAllocations([&]() { effect.start(label); });
+
+	steady = 0;
+	arena = 0;
+	for (int i = 0; i < repeats; ++i)
+	{
+		label->stopActionsOnAllSprites();
+		label->stopCompactAnimation();
+		label->stopAllActions();
+
+		steady += countAllocations([&]() { effect.start(label); });
+		arena += label->getEffectArenaStats().allocations;
+	}
+	steady = first < 0 ? -1 : steady / repeats;
+	arena /= repeats;
+
+	label->removeFromParent();
+}
+
+std::vector<AnimatedLabelBenchmark::EffectAllocations> AnimatedLabelBenchmark::runEffectAllocations(cocos2d::Node* parent, const std::string& bmfontFile, int repeats /* = 5 */)
+{
+	std::vector<EffectAllocations> results;
+	if (parent == nullptr)
+		return results;
+
+	repeats = std::max(repeats, 1);
+
+	//every animate* with both a sprite and a compact form
+	std::vector<BenchmarkEffect> effects;
+	effects.push_back({ "animateInFlyInFromLeft", [](AnimatedLabel* label) { label->animateInFlyInFromLeft(1); } });
+	effects.push_back({ "animateInFlyInFromRight", [](AnimatedLabel* label) { label->animateInFlyInFromRight(1); } });
+	effects.push_back({ "animateInFlyInFromTop", [](AnimatedLabel* label) { label->animateInFlyInFromTop(1); } });
+	effects.push_back({ "animateInFlyInFromBottom", [](AnimatedLabel* label) { label->animateInFlyInFromBottom(1); } });
+	effects.push_back({ "animateInDropFromTop", [](AnimatedLabel* label) { label->animateInDropFromTop(1); } });
+	effects.push_back({ "animateInTypewriter", [](AnimatedLabel* label) { label->animateInTypewriter(1); } });
+	effects.push_back({ "animateInSwell", [](AnimatedLabel* label) { label->animateInSwell(1); } });
+	effects.push_back({ "animateSwell", [](AnimatedLabel* label) { label->animateSwell(1); } });
+	effects.push_back({ "animateJump", [](AnimatedLabel* label) { label->animateJump(1, 30); } });
+	effects.push_back({ "animateStretchElastic", [](AnimatedLabel* label) { label->animateStretchElastic(0.3, 1, 1.5); } });
+	effects.push_back({ "animateInSpin", [](AnimatedLabel* label) { label->animateInSpin(1, 2); } });
+	effects.push_back({ "animateInVortex", [](AnimatedLabel* label) { label->animateInVortex(1, 2, false, false); } });
+
+	for (const BenchmarkEffect& effect : effects)
+	{
+		EffectAllocations result;
+		result.effect = effect.name;
+		countEffectAllocations(parent, bmfontFile, false, effect, repeats, result.spriteFirst, result.spriteSteady, result.spriteArena);
+		countEffectAllocations(parent, bmfontFile, true, effect, repeats, result.compactFirst, result.compactSteady, result.compactArena);
+		results.push_back(result);
+
+		cocos2d::log("AnimatedLabelBenchmark: %s heap allocations per call: sprites %d first, then %d (%d without the effect arena); compact %d first, then %d (%d without the effect arena)",
+				effect.name, result.spriteFirst, result.spriteSteady, result.spriteSteady + result.spriteArena,
+				result.compactFirst, result.compactSteady, result.compactSteady + result.compactArena);
+	}
+
+	return results;
+}
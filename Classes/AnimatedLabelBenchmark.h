@@ -0,0 +1,75 @@
+//
+//  AnimatedLabelBenchmark.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __AnimatedLabelBenchmark_h__
+#define __AnimatedLabelBenchmark_h__
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "AnimatedLabelBatch.h"
+
+//Measures what the label's performance work buys, against the plain way of doing the
+//same thing, and logs the numbers with cocos2d::log. Fonts and layout need a running
+//Director, so these run inside the app: the demo runs them on start when it's built
+//with ANIMATED_LABEL_BENCHMARKS.
+class AnimatedLabelBenchmark
+{
+	public:
+
+		//BATCH CREATION
+		struct BatchTimes
+		{
+			int labels;
+			int repeats;
+			float batchSeconds; //average for the whole table
+			float perCallSeconds;
+		};
+		//Creates the labels of entries with AnimatedLabelBatch, then with one create call
+		//per entry laid out straight away as the batch lays them out, repeats times each,
+		//after one warm up round of both so font loading isn't counted
+		static BatchTimes runBatchCreation(const std::vector<AnimatedLabelBatch::Entry>& entries, int repeats = 10);
+		//A results table, a name and a score per row, the names in bmfontFile and the
+		//scores in ttfFile
+		static std::vector<AnimatedLabelBatch::Entry> makeResultsTable(int rows, const std::string& bmfontFile, const std::string& ttfFile, float ttfSize);
+
+		//EFFECT ALLOCATIONS
+		//Heap allocations made by one animate* call, on a label using letter sprites and on
+		//one using compact animation. The first call on a label pays for its letter sprites
+		//or glyph block and grows its effect arena; later calls show the steady state,
+		//where the arena serves the effect's start offsets, start order and pending setups.
+		//Without the arena each of those would be a heap allocation, so the count before
+		//it is the steady heap count plus what the arena served. Counting replaces the
+		//global operator new, only in builds with ANIMATED_LABEL_BENCHMARKS; without it
+		//the heap counts read -1.
+		struct EffectAllocations
+		{
+			std::string effect;
+			int spriteFirst; //heap allocations of the first call
+			int spriteSteady; //average heap allocations of the later calls
+			int spriteArena; //average allocations the arena served the later calls
+			int compactFirst;
+			int compactSteady;
+			int compactArena;
+		};
+		//Creates its labels under parent, which should be running in the current scene,
+		//and calls every effect repeats times on each, stopping it in between
+		static std::vector<EffectAllocations> runEffectAllocations(cocos2d::Node* parent, const std::string& bmfontFile, int repeats = 5);
+};
+
+#endif /* __AnimatedLabelBenchmark_h__ */
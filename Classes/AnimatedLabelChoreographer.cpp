@@ -0,0 +1,277 @@
+//
+//  AnimatedLabelChoreographer.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AnimatedLabelChoreographer.h"
+
+#include <algorithm>
+
+static const char* kUpdateKey = "AnimatedLabelChoreographer";
+
+//CREATE FUNCTIONS
+
+AnimatedLabelChoreographer* AnimatedLabelChoreographer::create()
+{
+	auto ret = new (std::nothrow) AnimatedLabelChoreographer();
+
+	if (ret)
+	{
+		ret->autorelease();
+		return ret;
+	}
+
+	return nullptr;
+}
+
+AnimatedLabelChoreographer::AnimatedLabelChoreographer()
+: _updating(false)
+, _entriesRemoved(false)
+{
+	cocos2d::Director::getInstance()->getScheduler()->schedule([this](float dt) { update(dt); }, this, 0, false, kUpdateKey);
+}
+
+AnimatedLabelChoreographer::~AnimatedLabelChoreographer()
+{
+	cocos2d::Director::getInstance()->getScheduler()->unschedule(kUpdateKey, this);
+}
+
+//LABELS
+
+void AnimatedLabelChoreographer::addLabel(AnimatedLabel* label, int group /* = 0 */)
+{
+	if (label == nullptr)
+		return;
+
+	const int groupIndex = getGroupIndex(group);
+
+	const int entry = findEntry(label);
+	if (entry >= 0)
+	{
+		_entries[entry].group = groupIndex;
+		return;
+	}
+
+	if (label->getChoreographer() != nullptr)
+	{
+		label->getChoreographer()->removeLabel(label);
+	}
+
+	Entry newEntry = { label, groupIndex };
+	_entries.push_back(newEntry);
+
+	label->setChoreographer(this);
+
+	if (_groups[groupIndex].paused)
+	{
+		label->setActionsPaused(true);
+	}
+}
+
+void AnimatedLabelChoreographer::removeLabel(AnimatedLabel* label)
+{
+	const int entry = findEntry(label);
+	if (entry < 0)
+		return;
+
+	if (_groups[_entries[entry].group].paused)
+	{
+		label->setActionsPaused(false);
+	}
+
+	forgetLabel(label);
+
+	//last, the label may be holding the only reference to this choreographer
+	label->setChoreographer(nullptr);
+}
+
+void AnimatedLabelChoreographer::forgetLabel(AnimatedLabel* label)
+{
+	const int entry = findEntry(label);
+	if (entry < 0)
+		return;
+
+	//the update pass walks the list by index, so it's compacted once the pass is over
+	if (_updating)
+	{
+		_entries[entry].label = nullptr;
+		_entriesRemoved = true;
+	}
+	else
+	{
+		_entries.erase(_entries.begin() + entry);
+	}
+}
+
+int AnimatedLabelChoreographer::getLabelGroup(AnimatedLabel* label) const
+{
+	const int entry = findEntry(label);
+	return entry >= 0 ? _groups[_entries[entry].group].id : -1;
+}
+
+int AnimatedLabelChoreographer::getLabelCount() const
+{
+	int count = 0;
+	for (auto&& entry : _entries)
+	{
+		if (entry.label != nullptr)
+			++count;
+	}
+	return count;
+}
+
+int AnimatedLabelChoreographer::findEntry(AnimatedLabel* label) const
+{
+	for (int i = 0, numEntries = (int)_entries.size(); i < numEntries; ++i)
+	{
+		if (_entries[i].label == label)
+			return i;
+	}
+	return -1;
+}
+
+//GROUPS
+
+const AnimatedLabelChoreographer::Group* AnimatedLabelChoreographer::findGroup(int group) const
+{
+	for (auto&& existing : _groups)
+	{
+		if (existing.id == group)
+			return &existing;
+	}
+	return nullptr;
+}
+
+int AnimatedLabelChoreographer::getGroupIndex(int group)
+{
+	for (int i = 0, numGroups = (int)_groups.size(); i < numGroups; ++i)
+	{
+		if (_groups[i].id == group)
+			return i;
+	}
+
+	Group newGroup = { group, false, 1.f };
+	_groups.push_back(newGroup);
+	return (int)_groups.size() - 1;
+}
+
+void AnimatedLabelChoreographer::startGroup(int group, const std::function<void(AnimatedLabel* label)>& startEffect)
+{
+	const Group* existing = findGroup(group);
+	if (existing == nullptr)
+		return;
+
+	const int groupIndex = (int)(existing - _groups.data());
+
+	//starting an effect can add labels (vortex ghosts), only the current ones are started
+	std::vector<AnimatedLabel*> labels;
+	for (auto&& entry : _entries)
+	{
+		if (entry.label != nullptr && entry.group == groupIndex)
+			labels.push_back(entry.label);
+	}
+
+	retain();
+	for (AnimatedLabel *label : labels)
+	{
+		startEffect(label);
+	}
+	release();
+}
+
+void AnimatedLabelChoreographer::pauseGroup(int group)
+{
+	const int groupIndex = getGroupIndex(group);
+	if (_groups[groupIndex].paused)
+		return;
+
+	_groups[groupIndex].paused = true;
+
+	for (auto&& entry : _entries)
+	{
+		if (entry.label != nullptr && entry.group == groupIndex)
+			entry.label->setActionsPaused(true);
+	}
+}
+
+void AnimatedLabelChoreographer::resumeGroup(int group)
+{
+	const int groupIndex = getGroupIndex(group);
+	if (!_groups[groupIndex].paused)
+		return;
+
+	_groups[groupIndex].paused = false;
+
+	for (auto&& entry : _entries)
+	{
+		if (entry.label != nullptr && entry.group == groupIndex)
+			entry.label->setActionsPaused(false);
+	}
+}
+
+bool AnimatedLabelChoreographer::isGroupPaused(int group) const
+{
+	const Group* existing = findGroup(group);
+	return existing != nullptr && existing->paused;
+}
+
+void AnimatedLabelChoreographer::setGroupTimeScale(int group, float timeScale)
+{
+	_groups[getGroupIndex(group)].timeScale = std::max(0.f, timeScale);
+}
+
+float AnimatedLabelChoreographer::getGroupTimeScale(int group) const
+{
+	const Group* existing = findGroup(group);
+	return existing != nullptr ? existing->timeScale : 1.f;
+}
+
+//UPDATE
+
+void AnimatedLabelChoreographer::update(float dt)
+{
+	if (_entries.empty())
+		return;
+
+	//a label leaving during the pass may hold the last reference to this
+	retain();
+	_updating = true;
+
+	//by index, effects can add labels during the pass
+	for (size_t i = 0; i < _entries.size(); ++i)
+	{
+		AnimatedLabel *label = _entries[i].label;
+		if (label == nullptr || !label->isRunning())
+			continue;
+
+		const Group& group = _groups[_entries[i].group];
+		if (group.paused)
+			continue;
+
+		//a timeline that finishes an effect with removeOnCompletion can free the label
+		label->retain();
+		label->tickTimelines(dt * group.timeScale);
+		label->release();
+	}
+
+	_updating = false;
+
+	if (_entriesRemoved)
+	{
+		_entries.erase(std::remove_if(_entries.begin(), _entries.end(), [](const Entry& entry) { return entry.label == nullptr; }), _entries.end());
+		_entriesRemoved = false;
+	}
+
+	release();
+}
@@ -0,0 +1,93 @@
+//
+//  AnimatedLabelChoreographer.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __AnimatedLabelChoreographer_h__
+#define __AnimatedLabelChoreographer_h__
+
+#include <functional>
+#include <vector>
+#include "cocos2d.h"
+#include "AnimatedLabel.h"
+
+//Steps the timelines of every label added to it from a single scheduler entry, one
+//pass over a flat list of labels per frame, instead of each label registering its own
+//updates. Labels are put in groups (0 by default) that can be started together,
+//paused, resumed and slowed down or sped up as one.
+//Labels aren't retained, a label keeps the choreographer alive while it's in it.
+class AnimatedLabelChoreographer : public cocos2d::Ref
+{
+	public:
+
+		static AnimatedLabelChoreographer* create();
+
+		//LABELS
+		//Moves the label out of any other choreographer
+		void addLabel(AnimatedLabel* label, int group = 0);
+		void removeLabel(AnimatedLabel* label);
+		//-1 for labels that aren't in this choreographer
+		int getLabelGroup(AnimatedLabel* label) const;
+		int getLabelCount() const;
+
+		//GROUPS
+		//Runs startEffect on every label of the group in the same frame, so their
+		//timelines all start from the same moment, e.g.
+		//  choreographer->startGroup(1, [](AnimatedLabel* label){ label->animateInDropFromTop(1); });
+		void startGroup(int group, const std::function<void(AnimatedLabel* label)>& startEffect);
+		//Pausing also pauses the actions of the group's labels and their letter sprites
+		void pauseGroup(int group);
+		void resumeGroup(int group);
+		bool isGroupPaused(int group) const;
+		//Scales the time of the group's timelines. Actions on letter sprites, which the
+		//sprite based effects use, keep running at the Director's speed.
+		void setGroupTimeScale(int group, float timeScale);
+		float getGroupTimeScale(int group) const;
+
+	protected:
+
+		AnimatedLabelChoreographer();
+		virtual ~AnimatedLabelChoreographer();
+
+	private:
+
+		friend class AnimatedLabel;
+
+		struct Entry
+		{
+			AnimatedLabel *label; //nullptr once removed during an update
+			int group; //index into _groups
+		};
+
+		struct Group
+		{
+			int id;
+			bool paused;
+			float timeScale;
+		};
+
+		void update(float dt);
+		//the label is being destroyed, only drop its entry
+		void forgetLabel(AnimatedLabel* label);
+		int findEntry(AnimatedLabel* label) const;
+		const Group* findGroup(int group) const;
+		int getGroupIndex(int group);
+
+		std::vector<Entry> _entries;
+		std::vector<Group> _groups;
+		bool _updating;
+		bool _entriesRemoved;
+};
+
+#endif /* __AnimatedLabelChoreographer_h__ */
@@ -0,0 +1,202 @@
+//
+//  AnimatedLabelGoldens.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AnimatedLabelGoldens.h"
+#include "AnimatedLabel.h"
+#include "GlyphPath.h"
+#include "GlyphStagger.h"
+
+#include <algorithm>
+#include <functional>
+
+//the layout GlyphGoldenTests lays out by hand, two lines with a space in the first
+static const char* const kGoldenText = "Go on\nup";
+static const unsigned int kGoldenSeed = 7;
+
+struct GoldenEffect
+{
+	const char *name;
+	float length; //seconds sampled
+	bool compact; //has a compact form, checked against the sprite golden
+	std::function<void(AnimatedLabel* label)> start;
+};
+
+//a MoveBy standing in for whatever action a game hands the action functions
+static cocos2d::MoveBy* referenceMove()
+{
+	return cocos2d::MoveBy::create(0.5, cocos2d::Vec2(0, 20));
+}
+
+static std::vector<GoldenEffect> goldenEffects()
+{
+	std::vector<GoldenEffect> effects;
+
+	effects.push_back({ "animateInFlyInFromLeft", 2.f, true, [](AnimatedLabel* label) { label->animateInFlyInFromLeft(1); } });
+	effects.push_back({ "animateInFlyInFromRight", 2.f, true, [](AnimatedLabel* label) { label->animateInFlyInFromRight(1); } });
+	effects.push_back({ "animateInFlyInFromTop", 2.f, true, [](AnimatedLabel* label) { label->animateInFlyInFromTop(1); } });
+	effects.push_back({ "animateInFlyInFromBottom", 2.f, true, [](AnimatedLabel* label) { label->animateInFlyInFromBottom(1); } });
+	effects.push_back({ "animateInDropFromTop", 2.f, true, [](AnimatedLabel* label) { label->animateInDropFromTop(1); } });
+	effects.push_back({ "animateInTypewriter", 1.5f, true, [](AnimatedLabel* label) { label->animateInTypewriter(1, 0.25); } });
+	effects.push_back({ "animateInSwell", 1.5f, true, [](AnimatedLabel* label) { label->animateInSwell(1); } });
+	effects.push_back({ "animateInRevealFromLeft", 1.5f, false, [](AnimatedLabel* label) { label->animateInRevealFromLeft(1); } });
+	effects.push_back({ "animateSwell", 1.5f, true, [](AnimatedLabel* label) { label->animateSwell(1); } });
+	effects.push_back({ "animateJump", 1.5f, true, [](AnimatedLabel* label) { label->animateJump(1, 30); } });
+	effects.push_back({ "animateStretchElastic", 1.5f, true, [](AnimatedLabel* label) { label->animateStretchElastic(0.25, 1, 1.5); } });
+	effects.push_back({ "animateInSpin", 1.5f, true, [](AnimatedLabel* label) { label->animateInSpin(1, 2); } });
+	effects.push_back({ "animateInVortex", 3.f, true, [](AnimatedLabel* label) { label->animateInVortex(2, 2); } });
+	effects.push_back({ "animateInAlongPath", 2.f, true, [](AnimatedLabel* label) {
+		label->animateInAlongPath(GlyphPath::bezier(GlyphPath::Point(-200, 100), GlyphPath::Point(-100, 200), GlyphPath::Point(0, -50), GlyphPath::Point(0, 0)), 1, 0.5);
+	} });
+	effects.push_back({ "flyPastAndRemove", 2.5f, false, [](AnimatedLabel* label) { label->flyPastAndRemove(); } });
+
+	//colours, sampled at each letter's bottom left corner
+	effects.push_back({ "animateRainbow", 1.5f, false, [](AnimatedLabel* label) { label->animateRainbow(1); } });
+	effects.push_back({ "animateColorsRainbow", 1.5f, false, [](AnimatedLabel* label) { label->animateColorsRainbow(1, 1, false, 1); } });
+	effects.push_back({ "animateColorsGradient", 1.5f, false, [](AnimatedLabel* label) {
+		std::vector<cocos2d::Color4B> palette;
+		palette.push_back(cocos2d::Color4B(255, 0, 0, 255));
+		palette.push_back(cocos2d::Color4B(0, 0, 255, 255));
+		label->animateColorsGradient(palette, 1, 1, 0.5, true, 1);
+	} });
+	effects.push_back({ "animateColors", 1.f, false, [](AnimatedLabel* label) {
+		label->animateColors([](int index, float elapsed, cocos2d::Color4B* corners) {
+			const GLubyte fade = (GLubyte)(255 * std::min(1.f, elapsed + index * 0.1f));
+			for (int corner = 0; corner < 4; ++corner)
+			{
+				corners[corner] = cocos2d::Color4B(255, fade, fade, 255);
+			}
+		}, 1);
+	} });
+
+	//the action functions, with the action a game would hand them
+	effects.push_back({ "runActionOnAllSprites", 1.f, false, [](AnimatedLabel* label) {
+		label->runActionOnAllSprites(referenceMove());
+	} });
+	effects.push_back({ "runActionOnAllSpritesSequentially", 2.f, false, [](AnimatedLabel* label) {
+		label->runActionOnAllSpritesSequentially(referenceMove(), 1, 0.25);
+	} });
+	effects.push_back({ "runActionOnAllSpritesSequentiallyReverse", 2.f, false, [](AnimatedLabel* label) {
+		label->runActionOnAllSpritesSequentiallyReverse(referenceMove(), 1, 0.25);
+	} });
+	effects.push_back({ "runActionOnAllSpritesStaggered", 2.f, false, [](AnimatedLabel* label) {
+		label->runActionOnAllSpritesStaggered(referenceMove(), GlyphStagger::fromCenter(), 1);
+	} });
+
+	return effects;
+}
+
+static GlyphRecording recordGoldenEffect(cocos2d::Node* parent, const std::string& bmfontFile, const GoldenEffect& effect, bool compact)
+{
+	AnimatedLabel *label = AnimatedLabel::createWithBMFont(bmfontFile, kGoldenText);
+	if (label == nullptr)
+	{
+		cocos2d::log("AnimatedLabelGoldens: can't create a label with %s", bmfontFile.c_str());
+		return GlyphRecording();
+	}
+
+	label->setPosition(cocos2d::Vec2(parent->getContentSize().width/2, parent->getContentSize().height/2));
+	label->setRandomSeed(kGoldenSeed);
+	label->setCompactAnimation(compact);
+	parent->addChild(label);
+
+	//an eighth of a second apart, as in GlyphGoldenTests
+	std::vector<float> timestamps;
+	for (int frame = 0; frame * 0.125f <= effect.length; ++frame)
+	{
+		timestamps.push_back(frame * 0.125f);
+	}
+
+	const GlyphRecording recording = label->recordEffect(effect.start, timestamps);
+
+	//flyPastAndRemove has removed it already
+	label->removeFromParent();
+	return recording;
+}
+
+GlyphRecording::Tolerance AnimatedLabelGoldens::getCompactTolerance()
+{
+	GlyphRecording::Tolerance tolerance;
+	tolerance.position = 0.5f;
+	tolerance.scale = 0.01f;
+	tolerance.rotation = 0.5f;
+	tolerance.color = 2;
+	return tolerance;
+}
+
+int AnimatedLabelGoldens::run(cocos2d::Node* parent, const std::string& bmfontFile, const std::string& directory, std::vector<Result>* results /* = nullptr */)
+{
+	if (parent == nullptr || !parent->isRunning())
+	{
+		cocos2d::log("AnimatedLabelGoldens: the parent is not running in a scene");
+		return 0;
+	}
+
+	cocos2d::FileUtils *files = cocos2d::FileUtils::getInstance();
+	files->createDirectory(directory);
+
+	int failures = 0;
+
+	for (const GoldenEffect& effect : goldenEffects())
+	{
+		Result result;
+		result.effect = effect.name;
+		result.recorded = false;
+		result.spriteMatches = true;
+		result.compactMatches = -1;
+
+		const std::string path = directory + "/" + effect.name + ".txt";
+		const GlyphRecording sprite = recordGoldenEffect(parent, bmfontFile, effect, false);
+		GlyphRecording golden;
+		std::string report;
+
+		if (!files->isFileExist(path))
+		{
+			result.recorded = files->writeStringToFile(sprite.toString(), path);
+			golden = sprite;
+			cocos2d::log("AnimatedLabelGoldens: %s: recorded %s", effect.name, path.c_str());
+		}
+		else if (!golden.fromString(files->getStringFromFile(path)))
+		{
+			cocos2d::log("AnimatedLabelGoldens: %s: %s is not a recording", effect.name, path.c_str());
+			result.spriteMatches = false;
+		}
+		else if (!sprite.matches(golden, GlyphRecording::Tolerance(), &report))
+		{
+			cocos2d::log("AnimatedLabelGoldens: %s: the sprite effect doesn't match its golden recording\n%s", effect.name, report.c_str());
+			result.spriteMatches = false;
+		}
+
+		if (effect.compact && golden.getFrameCount() > 0)
+		{
+			report.clear();
+			const GlyphRecording compact = recordGoldenEffect(parent, bmfontFile, effect, true);
+			result.compactMatches = compact.matches(golden, getCompactTolerance(), &report) ? 1 : 0;
+			if (result.compactMatches == 0)
+			{
+				cocos2d::log("AnimatedLabelGoldens: %s: the compact effect doesn't match the sprite golden\n%s", effect.name, report.c_str());
+			}
+		}
+
+		if (!result.spriteMatches || result.compactMatches == 0)
+			failures++;
+
+		if (results != nullptr)
+			results->push_back(result);
+	}
+
+	cocos2d::log("AnimatedLabelGoldens: %d effects failed", failures);
+	return failures;
+}
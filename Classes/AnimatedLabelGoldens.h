@@ -0,0 +1,55 @@
+//
+//  AnimatedLabelGoldens.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __AnimatedLabelGoldens_h__
+#define __AnimatedLabelGoldens_h__
+
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "GlyphRecording.h"
+
+//Golden recordings of the effects as AnimatedLabel has always run them, on letter
+//sprites with cocos2d actions, and the check that each compact effect moves its letters
+//the same way. Every effect is recorded on a sprite label and checked against its
+//golden in directory; an effect with a compact form is then recorded in compact mode
+//and checked against the same golden, within getCompactTolerance. A golden that doesn't
+//exist yet is written from the sprite recording, so delete one to record it again after
+//an intended change. Fonts, actions and the scheduler need a running Director, so this
+//runs inside the app: the demo runs it on start when built with ANIMATED_LABEL_GOLDENS.
+//GlyphGoldenTests checks the compact engine alone, headless.
+class AnimatedLabelGoldens
+{
+	public:
+
+		struct Result
+		{
+			std::string effect;
+			bool recorded; //no golden yet, the sprite recording was written as one
+			bool spriteMatches;
+			int compactMatches; //1 or 0, -1 for an effect without a compact form
+		};
+
+		//Creates its labels under parent, which must be running in the current scene, and
+		//logs every mismatch. Returns the number of effects that failed.
+		static int run(cocos2d::Node* parent, const std::string& bmfontFile, const std::string& directory, std::vector<Result>* results = nullptr);
+
+		//The compact engine eases and sums in a different order than the action tree, so it
+		//is allowed a little more than a recording is against its own golden
+		static GlyphRecording::Tolerance getCompactTolerance();
+};
+
+#endif /* __AnimatedLabelGoldens_h__ */
@@ -0,0 +1,390 @@
+//
+//  AnimatedTextWindow.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AnimatedTextWindow.h"
+
+#include <algorithm>
+#include <math.h>
+
+//CREATE FUNCTIONS
+
+AnimatedTextWindow* AnimatedTextWindow::createWithBMFont(const std::string& bmfontFilePath, const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment /* = TextHAlignment::LEFT */)
+{
+	auto ret = new (std::nothrow) AnimatedTextWindow();
+
+	if (ret && ret->init(size, lineHeight, alignment))
+	{
+		ret->_bmfontFilePath = bmfontFilePath;
+		ret->autorelease();
+
+		return ret;
+	}
+
+	delete ret;
+	return nullptr;
+}
+
+AnimatedTextWindow* AnimatedTextWindow::createWithTTF(const std::string& fontFile, float fontSize, const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment /* = TextHAlignment::LEFT */)
+{
+	auto ret = new (std::nothrow) AnimatedTextWindow();
+
+	if (ret && cocos2d::FileUtils::getInstance()->isFileExist(fontFile) && ret->init(size, lineHeight, alignment))
+	{
+		ret->_ttfFile = fontFile;
+		ret->_fontSize = fontSize;
+		ret->autorelease();
+
+		return ret;
+	}
+
+	delete ret;
+	return nullptr;
+}
+
+AnimatedTextWindow::AnimatedTextWindow()
+: _measureLabel(nullptr)
+, _fontSize(0.f)
+, _lineHeight(0.f)
+, _alignment(cocos2d::TextHAlignment::LEFT)
+, _scrollOffset(0.f)
+, _marginLines(2)
+{
+}
+
+AnimatedTextWindow::~AnimatedTextWindow()
+{
+	//the labels still in the window go with its children
+	for (auto&& live : _liveLines)
+	{
+		live.second.label->release();
+	}
+
+	CC_SAFE_RELEASE(_measureLabel);
+}
+
+bool AnimatedTextWindow::init(const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment)
+{
+	if (!cocos2d::Node::init())
+		return false;
+
+	if (lineHeight <= 0)
+	{
+		cocos2d::log("AnimatedTextWindow: the line height must be positive");
+		return false;
+	}
+
+	setContentSize(size);
+	_lineHeight = lineHeight;
+	_alignment = alignment;
+
+	return true;
+}
+
+//TEXT
+
+void AnimatedTextWindow::setText(const std::string& text)
+{
+	clearLines();
+
+	_text = text;
+	_lines.clear();
+
+	if (!_text.empty())
+	{
+		splitLines(0);
+	}
+
+	_scrollOffset = std::min(_scrollOffset, getMaxScrollOffset());
+	updateWindow();
+}
+
+void AnimatedTextWindow::appendLine(const std::string& line)
+{
+	if (!_lines.empty())
+	{
+		_text += '\n';
+	}
+
+	const size_t start = _text.size();
+	_text += line;
+	splitLines(start);
+
+	updateWindow();
+}
+
+std::string AnimatedTextWindow::getLine(int line) const
+{
+	if (line < 0 || line >= getLineCount())
+		return std::string();
+
+	return _text.substr(_lines[line].start, _lines[line].end - _lines[line].start);
+}
+
+//byte offset of the character chars UTF-8 characters after from, at most end
+static size_t advanceUTF8(const std::string& text, size_t from, size_t end, int chars)
+{
+	for (; from < end && chars > 0; --chars)
+	{
+		++from;
+		while (from < end && ((unsigned char)text[from] & 0xC0) == 0x80)
+			++from;
+	}
+	return from;
+}
+
+void AnimatedTextWindow::splitLines(size_t from)
+{
+	for (size_t start = from;;)
+	{
+		size_t end = _text.find('\n', start);
+		if (end == std::string::npos)
+			end = _text.size();
+
+		wrapLine(start, end);
+
+		if (end == _text.size())
+			break;
+		start = end + 1;
+	}
+}
+
+void AnimatedTextWindow::wrapLine(size_t start, size_t end)
+{
+	const float width = getContentSize().width;
+
+	if (_measureLabel == nullptr && end > start && width > 0)
+	{
+		_measureLabel = createLineLabel(std::string());
+		CC_SAFE_RETAIN(_measureLabel);
+	}
+
+	if (_measureLabel == nullptr || end == start || width <= 0)
+	{
+		LineRange range = { start, end };
+		_lines.push_back(range);
+		return;
+	}
+
+	_measureLabel->setMaxLineWidth(width);
+	_measureLabel->setString(_text.substr(start, end - start));
+
+	std::vector<int> starts;
+	_measureLabel->getLineStarts(starts);
+
+	//the spaces a line was broken at don't show on either side of the break
+	size_t lineStart = start;
+	int lineChar = 0;
+	for (size_t i = 1; i <= starts.size(); ++i)
+	{
+		const bool last = i == starts.size();
+		const size_t lineEnd = last ? end : advanceUTF8(_text, lineStart, end, starts[i] - lineChar);
+
+		LineRange range = { lineStart, lineEnd };
+		while (range.start > start && range.start < range.end && _text[range.start] == ' ')
+			++range.start;
+		while (!last && range.end > range.start && _text[range.end - 1] == ' ')
+			--range.end;
+		_lines.push_back(range);
+
+		if (!last)
+		{
+			lineStart = lineEnd;
+			lineChar = starts[i];
+		}
+	}
+
+	//a line the label lays out as nothing is still a line
+	if (starts.empty())
+	{
+		LineRange range = { start, end };
+		_lines.push_back(range);
+	}
+}
+
+//SCROLLING
+
+void AnimatedTextWindow::setScrollOffset(float offset)
+{
+	offset = std::max(0.f, std::min(offset, getMaxScrollOffset()));
+	if (offset == _scrollOffset)
+		return;
+
+	_scrollOffset = offset;
+	updateWindow();
+}
+
+void AnimatedTextWindow::setContentSize(const cocos2d::Size& size)
+{
+	const bool rewrap = size.width != getContentSize().width;
+	cocos2d::Node::setContentSize(size);
+
+	if (!rewrap || _text.empty())
+		return;
+
+	clearLines();
+	_lines.clear();
+	splitLines(0);
+
+	_scrollOffset = std::min(_scrollOffset, getMaxScrollOffset());
+	updateWindow();
+}
+
+float AnimatedTextWindow::getMaxScrollOffset() const
+{
+	return std::max(0.f, getLineCount() * _lineHeight - getContentSize().height);
+}
+
+void AnimatedTextWindow::setMarginLines(int lines)
+{
+	_marginLines = std::max(0, lines);
+	updateWindow();
+}
+
+float AnimatedTextWindow::getLineTop(int line) const
+{
+	return getContentSize().height - line * _lineHeight + _scrollOffset;
+}
+
+AnimatedLabel* AnimatedTextWindow::getLabelForLine(int line) const
+{
+	auto live = _liveLines.find(line);
+	return live != _liveLines.end() ? live->second.label : nullptr;
+}
+
+//LINE LABELS
+
+AnimatedLabel* AnimatedTextWindow::createLineLabel(const std::string& text)
+{
+	AnimatedLabel *label = nullptr;
+
+	if (!_bmfontFilePath.empty())
+	{
+		label = AnimatedLabel::createWithBMFont(_bmfontFilePath, text, _alignment);
+	}
+	else
+	{
+		label = AnimatedLabel::createWithTTF(text, _ttfFile, _fontSize, cocos2d::Size::ZERO, _alignment);
+	}
+
+	if (label == nullptr)
+		return nullptr;
+
+	switch (_alignment)
+	{
+		case cocos2d::TextHAlignment::CENTER:
+			label->setAnchorPoint(cocos2d::Vec2(0.5f, 1.f));
+			label->setPositionX(getContentSize().width/2);
+			break;
+		case cocos2d::TextHAlignment::RIGHT:
+			label->setAnchorPoint(cocos2d::Vec2(1.f, 1.f));
+			label->setPositionX(getContentSize().width);
+			break;
+		default:
+			label->setAnchorPoint(cocos2d::Vec2(0.f, 1.f));
+			label->setPositionX(0);
+			break;
+	}
+
+	return label;
+}
+
+void AnimatedTextWindow::updateWindow()
+{
+	const int lineCount = getLineCount();
+	const float height = getContentSize().height;
+
+	const int firstVisible = (int)floorf(_scrollOffset / _lineHeight);
+	const int lastVisible = (int)ceilf((_scrollOffset + height) / _lineHeight) - 1;
+	const int firstLive = std::max(0, firstVisible - _marginLines);
+	const int lastLive = std::min(lineCount - 1, lastVisible + _marginLines);
+
+	//lines past the margin go first, so their labels are freed before new ones are made.
+	//Labels an effect took out of the window go too, and are made again if still needed.
+	for (auto live = _liveLines.begin(); live != _liveLines.end();)
+	{
+		const bool inWindow = live->second.label->getParent() == this;
+		if (inWindow && live->first >= firstLive && live->first <= lastLive)
+		{
+			++live;
+			continue;
+		}
+
+		if (inWindow && live->second.visible && _lineLeaveCallback)
+		{
+			_lineLeaveCallback(live->second.label, live->first);
+		}
+
+		releaseLine(live->second);
+		live = _liveLines.erase(live);
+	}
+
+	for (int line = firstLive; line <= lastLive; ++line)
+	{
+		auto live = _liveLines.find(line);
+		if (live == _liveLines.end())
+		{
+			AnimatedLabel *label = createLineLabel(getLine(line));
+			if (label == nullptr)
+			{
+				cocos2d::log("AnimatedTextWindow: couldn't create the label for line %d", line);
+				continue;
+			}
+
+			addChild(label);
+			label->retain();
+
+			LiveLine liveLine = { label, false };
+			live = _liveLines.insert(std::make_pair(line, liveLine)).first;
+		}
+
+		LiveLine& liveLine = live->second;
+		liveLine.label->setPositionY(getLineTop(line));
+
+		const bool visible = line >= firstVisible && line <= lastVisible;
+		if (visible == liveLine.visible)
+			continue;
+
+		liveLine.visible = visible;
+
+		if (visible && _lineEnterCallback)
+		{
+			_lineEnterCallback(liveLine.label, line);
+		}
+		else if (!visible && _lineLeaveCallback)
+		{
+			_lineLeaveCallback(liveLine.label, line);
+		}
+	}
+}
+
+void AnimatedTextWindow::releaseLine(LiveLine& liveLine)
+{
+	if (liveLine.label->getParent() == this)
+	{
+		liveLine.label->removeFromParent();
+	}
+	liveLine.label->release();
+	liveLine.label = nullptr;
+}
+
+void AnimatedTextWindow::clearLines()
+{
+	for (auto&& live : _liveLines)
+	{
+		releaseLine(live.second);
+	}
+	_liveLines.clear();
+}
@@ -0,0 +1,128 @@
+//
+//  AnimatedTextWindow.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __AnimatedTextWindow_h__
+#define __AnimatedTextWindow_h__
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cocos2d.h"
+#include "AnimatedLabel.h"
+
+//Shows a window onto a long text (credits, logs, dialogue history), one AnimatedLabel
+//per line, creating labels only for the lines in the window plus a margin of lines
+//above and below. The text itself is kept as a single string, so glyph layout,
+//letter sprites and animation state are bounded by what is on screen, not by the
+//length of the text.
+//Lines are split at '\n' and wrapped to the window's width the way the label would wrap
+//them, and line numbers count the wrapped lines. Wrapping lays out every line once when
+//it's set, without letter sprites. The window doesn't clip, put it in a
+//cocos2d::ClippingRectangleNode if lines mustn't show outside it.
+class AnimatedTextWindow : public cocos2d::Node
+{
+	public:
+
+		static AnimatedTextWindow* createWithBMFont(const std::string& bmfontFilePath, const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment = cocos2d::TextHAlignment::LEFT);
+		static AnimatedTextWindow* createWithTTF(const std::string& fontFile, float fontSize, const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment = cocos2d::TextHAlignment::LEFT);
+
+		//TEXT
+		void setText(const std::string& text);
+		void appendLine(const std::string& line);
+		int getLineCount() const { return (int)_lines.size(); }
+		std::string getLine(int line) const;
+
+		//SCROLLING
+		//The offset is how far the text has scrolled up, 0 shows the first line at the top
+		void setScrollOffset(float offset);
+		float getScrollOffset() const { return _scrollOffset; }
+		void scrollBy(float distance) { setScrollOffset(_scrollOffset + distance); }
+		void scrollToLine(int line) { setScrollOffset(line * _lineHeight); }
+		float getMaxScrollOffset() const;
+		//lines kept alive above and below the window, so short scrolls don't create labels
+		void setMarginLines(int lines);
+		int getMarginLines() const { return _marginLines; }
+
+		//LINE ANIMATIONS
+		//Called when a line scrolls into view and when it scrolls out of view. The label
+		//is still alive while it is in the margin, so an effect started on leaving gets
+		//to run until the line is further than the margin, e.g.
+		//  window->setLineEnterCallback([](AnimatedLabel* label, int){ label->animateInTypewriter(0.5f); });
+		typedef std::function<void(AnimatedLabel* label, int line)> LineCallback;
+		void setLineEnterCallback(const LineCallback& callback) { _lineEnterCallback = callback; }
+		void setLineLeaveCallback(const LineCallback& callback) { _lineLeaveCallback = callback; }
+
+		//Rewraps the text when the width changes
+		virtual void setContentSize(const cocos2d::Size& size) override;
+
+		//STATS
+		int getLiveLabelCount() const { return (int)_liveLines.size(); }
+		//nullptr for lines that have no label right now
+		AnimatedLabel* getLabelForLine(int line) const;
+
+	protected:
+
+		AnimatedTextWindow();
+		virtual ~AnimatedTextWindow();
+
+		bool init(const cocos2d::Size& size, float lineHeight, cocos2d::TextHAlignment alignment);
+
+	private:
+
+		//a wrapped line, as byte offsets in _text
+		struct LineRange
+		{
+			size_t start;
+			size_t end;
+		};
+
+		//the label is retained, an effect removing it from the window leaves it alive
+		//until updateWindow drops the line
+		struct LiveLine
+		{
+			AnimatedLabel *label;
+			bool visible;
+		};
+
+		AnimatedLabel* createLineLabel(const std::string& text);
+		//Wraps the '\n' separated lines of _text from byte offset from on
+		void splitLines(size_t from);
+		void wrapLine(size_t start, size_t end);
+		void releaseLine(LiveLine& liveLine);
+		void updateWindow();
+		void clearLines();
+		float getLineTop(int line) const;
+
+		std::string _text;
+		std::vector<LineRange> _lines;
+		AnimatedLabel *_measureLabel; //lays lines out to find where they wrap, never drawn
+
+		std::string _bmfontFilePath;
+		std::string _ttfFile;
+		float _fontSize;
+		float _lineHeight;
+		cocos2d::TextHAlignment _alignment;
+
+		float _scrollOffset;
+		int _marginLines;
+		std::unordered_map<int, LiveLine> _liveLines;
+
+		LineCallback _lineEnterCallback;
+		LineCallback _lineLeaveCallback;
+};
+
+#endif /* __AnimatedTextWindow_h__ */
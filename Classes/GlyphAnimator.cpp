@@ -0,0 +1,827 @@
+//
+//  GlyphAnimator.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphAnimator.h"
+
+#include <math.h>
+#include <algorithm>
+
+static const float kPi = 3.14159265358979f;
+
+static const GlyphState kRestState = { 0.f, 0.f, 0.f, 1.f, 0.f, 1.f };
+
+//GLYPH EFFECT
+
+GlyphEffect::GlyphEffect()
+: _length(0)
+{
+}
+
+void GlyphEffect::addKey(Channel channel, float start, float duration, const Value& from, const Value& to, Ease ease /* = Ease::LINEAR */, unsigned char variant /* = 0 */)
+{
+	Key key;
+	key.start = start;
+	key.duration = duration;
+	key.from = from;
+	key.to = to;
+	key.channel = channel;
+	key.ease = ease;
+	key.variant = variant;
+	key.path = -1;
+	_keys.push_back(key);
+
+	_length = fmaxf(_length, start + duration);
+}
+
+void GlyphEffect::addPathKey(const GlyphPath& path, float start, float duration, const Value& scale, float anchor /* = 0.f */, Ease ease /* = Ease::LINEAR */, unsigned char variant /* = 0 */)
+{
+	Key key;
+	key.start = start;
+	key.duration = duration;
+	key.from = scale;
+	key.to = scale;
+	key.channel = Channel::OFFSET_X;
+	key.ease = ease;
+	key.variant = variant;
+	key.path = (int)_paths.size();
+	key.rest = path.getPoint(anchor);
+	_keys.push_back(key);
+	_paths.push_back(std::make_shared<GlyphPath>(path));
+
+	_length = fmaxf(_length, start + duration);
+}
+
+void GlyphEffect::clear()
+{
+	_keys.clear();
+	_paths.clear();
+	_length = 0;
+}
+
+void GlyphEffect::evaluate(float localTime, float glyphX, GlyphState& state, unsigned char variant /* = 0 */) const
+{
+	//bit per channel, set once the channel's first key has been seen
+	unsigned int seen = 0;
+	const unsigned int pathBit = 1u << 31;
+	float pathX = 0;
+	float pathY = 0;
+
+	for (const Key& key : _keys)
+	{
+		if (key.variant != 0 && key.variant != variant)
+			continue;
+
+		if (key.path >= 0)
+		{
+			if (localTime < key.start && (seen & pathBit))
+				continue;
+
+			float t = key.duration > 0 ? (localTime - key.start) / key.duration : 1.f;
+			t = fminf(fmaxf(t, 0.f), 1.f);
+			const float fraction = t < 1.f ? ease(key.ease, t) : (key.ease == Ease::ARC ? 0.f : 1.f);
+
+			const GlyphPath::Point point = _paths[key.path]->getPoint(fraction);
+			const float scale = key.from.base + key.from.perX * glyphX;
+			pathX = (point.x - key.rest.x) * scale;
+			pathY = (point.y - key.rest.y) * scale;
+
+			seen |= pathBit;
+			continue;
+		}
+
+		const unsigned int channelBit = 1u << (unsigned int)key.channel;
+		float value;
+
+		if (localTime < key.start)
+		{
+			if (seen & channelBit)
+				continue;
+			value = key.from.base + key.from.perX * glyphX;
+		}
+		else
+		{
+			float from = key.from.base + key.from.perX * glyphX;
+			float to = key.to.base + key.to.perX * glyphX;
+			float t = key.duration > 0 ? (localTime - key.start) / key.duration : 1.f;
+			if (t < 1.f)
+				value = from + (to - from) * ease(key.ease, t);
+			else
+				value = key.ease == Ease::ARC ? from : to; //an arc lands where it started
+		}
+
+		seen |= channelBit;
+
+		switch (key.channel)
+		{
+			case Channel::OFFSET_X: state.offsetX = value; break;
+			case Channel::OFFSET_Y: state.offsetY = value; break;
+			case Channel::SCALE: state.scale = value; break;
+			case Channel::ROTATION: state.rotation = value; break;
+			case Channel::OPACITY: state.opacity = value; break;
+		}
+	}
+
+	state.offsetX += pathX;
+	state.offsetY += pathY;
+}
+
+float GlyphEffect::ease(Ease ease, float t)
+{
+	switch (ease)
+	{
+		case Ease::LINEAR:
+			return t;
+
+		case Ease::SINE_IN:
+			return -cosf(t * kPi * 0.5f) + 1;
+
+		case Ease::SINE_OUT:
+			return sinf(t * kPi * 0.5f);
+
+		case Ease::EXPONENTIAL_OUT:
+			return t == 1 ? 1 : -powf(2, -10 * t) + 1;
+
+		case Ease::EXPONENTIAL_IN_OUT:
+			if (t == 0 || t == 1)
+				return t;
+			if (t < 0.5f)
+				return 0.5f * powf(2, 10 * (t * 2 - 1));
+			return 0.5f * (-powf(2, -10 * (t * 2 - 1)) + 2);
+
+		case Ease::BOUNCE_OUT:
+			if (t < 1 / 2.75f)
+				return 7.5625f * t * t;
+			if (t < 2 / 2.75f)
+			{
+				t -= 1.5f / 2.75f;
+				return 7.5625f * t * t + 0.75f;
+			}
+			if (t < 2.5f / 2.75f)
+			{
+				t -= 2.25f / 2.75f;
+				return 7.5625f * t * t + 0.9375f;
+			}
+			t -= 2.625f / 2.75f;
+			return 7.5625f * t * t + 0.984375f;
+
+		case Ease::ELASTIC_OUT:
+		{
+			if (t == 0 || t == 1)
+				return t;
+			const float period = 0.3f;
+			const float s = period / 4;
+			return powf(2, -10 * t) * sinf((t - s) * kPi * 2 / period) + 1;
+		}
+
+		case Ease::ARC:
+			return 4 * t * (1 - t);
+	}
+
+	return t;
+}
+
+size_t GlyphEffect::getBytes() const
+{
+	size_t bytes = _keys.capacity() * sizeof(Key) + _paths.capacity() * sizeof(std::shared_ptr<const GlyphPath>);
+	for (auto&& path : _paths)
+	{
+		bytes += sizeof(GlyphPath) + path->getBytes();
+	}
+	return bytes;
+}
+
+//GLYPH ANIMATOR
+
+GlyphAnimator::GlyphAnimator()
+: _elapsed(0)
+, _endTime(0)
+, _running(false)
+, _nextLayerId(1)
+{
+	clearGroups();
+}
+
+void GlyphAnimator::reset(int numGlyphs)
+{
+	Glyph rest;
+	rest.layout.left = rest.layout.bottom = rest.layout.right = rest.layout.top = 0;
+	rest.layout.page = 0;
+	rest.layout.atlasIndex = -1;
+	rest.state = kRestState;
+	rest.variant = 0;
+
+	_glyphs.assign(numGlyphs, rest);
+	_elapsed = 0;
+	_endTime = 0;
+	_running = false;
+
+	_layers.clear();
+	clearGroups();
+}
+
+void GlyphAnimator::clear()
+{
+	//memory given back to an arena isn't reused until it's reset
+	if (getArena() != nullptr)
+		_glyphs.clear();
+	else
+		std::vector<Glyph, GlyphArenaAllocator<Glyph>>().swap(_glyphs);
+	_effect.clear();
+	_elapsed = 0;
+	_endTime = 0;
+	_running = false;
+
+	_layers.clear();
+	clearGroups();
+}
+
+void GlyphAnimator::setArena(GlyphArena* arena)
+{
+	clear();
+	_glyphs = std::vector<Glyph, GlyphArenaAllocator<Glyph>>(GlyphArenaAllocator<Glyph>(arena));
+}
+
+void GlyphAnimator::clearGroups()
+{
+	for (GroupLayer& layer : _groupLayers)
+	{
+		std::vector<int>().swap(layer.groupOf);
+		std::vector<Group>().swap(layer.groups);
+		layer.effect.clear();
+		layer.elapsed = 0;
+		layer.endTime = 0;
+		layer.running = false;
+		layer.active = false;
+	}
+}
+
+void GlyphAnimator::setStartOffsets(const std::vector<float>& offsets)
+{
+	const size_t numGlyphs = _glyphs.size();
+
+	for (size_t i = 0; i < numGlyphs; ++i)
+	{
+		_glyphs[i].state.startTime = i < offsets.size() ? offsets[i] : 0.f;
+	}
+}
+
+void GlyphAnimator::setVariants(const std::vector<unsigned char>& variants)
+{
+	const size_t numGlyphs = _glyphs.size();
+
+	for (size_t i = 0; i < numGlyphs; ++i)
+	{
+		_glyphs[i].variant = i < variants.size() ? variants[i] : 0;
+	}
+}
+
+void GlyphAnimator::setEffect(const GlyphEffect& effect)
+{
+	_effect = effect;
+}
+
+void GlyphAnimator::start()
+{
+	float lastStart = 0;
+	for (const Glyph& glyph : _glyphs)
+	{
+		lastStart = fmaxf(lastStart, glyph.state.startTime);
+	}
+
+	_elapsed = 0;
+	_endTime = lastStart + _effect.getLength();
+	_running = true;
+
+	evaluate();
+}
+
+void GlyphAnimator::stop()
+{
+	_running = false;
+
+	for (GroupLayer& layer : _groupLayers)
+	{
+		layer.running = false;
+	}
+}
+
+bool GlyphAnimator::isRunning() const
+{
+	return _running || !_layers.empty() || _groupLayers[0].running || _groupLayers[1].running;
+}
+
+bool GlyphAnimator::update(float dt)
+{
+	bool moving = _running;
+
+	if (_running)
+	{
+		_elapsed += dt;
+
+		if (_elapsed >= _endTime)
+		{
+			_running = false;
+		}
+	}
+
+	if (!_layers.empty() && updateLayers(dt))
+	{
+		moving = true;
+	}
+
+	//layers holding still leave the glyphs as they are
+	if (moving)
+	{
+		evaluate();
+	}
+
+	for (GroupLayer& layer : _groupLayers)
+	{
+		if (!layer.running)
+			continue;
+
+		layer.elapsed += dt;
+		evaluateGroups(layer);
+
+		if (layer.elapsed >= layer.endTime)
+		{
+			layer.running = false;
+		}
+	}
+
+	return isRunning();
+}
+
+void GlyphAnimator::evaluate()
+{
+	for (int i = 0, numGlyphs = (int)_glyphs.size(); i < numGlyphs; ++i)
+	{
+		Glyph& glyph = _glyphs[i];
+		if (glyph.layout.atlasIndex < 0)
+			continue;
+
+		GlyphState& state = glyph.state;
+		const float startTime = state.startTime;
+		state = kRestState;
+		state.startTime = startTime;
+
+		_effect.evaluate(_elapsed - startTime, (glyph.layout.left + glyph.layout.right) * 0.5f, state, glyph.variant);
+
+		if (!_layers.empty())
+		{
+			blendLayers(i, state);
+		}
+	}
+}
+
+//LAYERS
+
+int GlyphAnimator::addLayer(const GlyphEffect& effect, const std::vector<float>& startOffsets, float weight /* = 1.f */, bool loop /* = false */)
+{
+	Layer layer;
+	layer.id = _nextLayerId++;
+	layer.effect = effect;
+	layer.startOffsets.assign(_glyphs.size(), 0.f);
+	layer.elapsed = 0;
+	layer.weight = layer.targetWeight = weight;
+	layer.fadeSpeed = 0;
+	layer.loop = loop;
+	layer.removeWhenFaded = false;
+
+	float lastStart = 0;
+	for (size_t i = 0; i < layer.startOffsets.size() && i < startOffsets.size(); ++i)
+	{
+		layer.startOffsets[i] = startOffsets[i];
+		lastStart = fmaxf(lastStart, startOffsets[i]);
+	}
+	layer.endTime = lastStart + effect.getLength();
+
+	//perX values differ per glyph, so check two glyphs far apart
+	GlyphState near = kRestState, far = kRestState;
+	effect.evaluate(effect.getLength(), 0.f, near);
+	effect.evaluate(effect.getLength(), 1000.f, far);
+	layer.endsAtRest = true;
+	for (const GlyphState* end : { &near, &far })
+	{
+		if (end->offsetX != 0 || end->offsetY != 0 || end->scale != 1 || end->rotation != 0 || end->opacity != 1)
+			layer.endsAtRest = false;
+	}
+
+	_layers.push_back(layer);
+
+	evaluate();
+	return layer.id;
+}
+
+void GlyphAnimator::fadeLayer(int layer, float weight, float duration)
+{
+	const int index = findLayer(layer);
+	if (index < 0)
+		return;
+
+	Layer& faded = _layers[index];
+	faded.targetWeight = weight;
+	faded.fadeSpeed = duration > 0 ? fabsf(weight - faded.weight) / duration : 0.f;
+	if (duration <= 0)
+	{
+		faded.weight = weight;
+		evaluate();
+	}
+}
+
+void GlyphAnimator::removeLayer(int layer, float fadeOut /* = 0.f */)
+{
+	const int index = findLayer(layer);
+	if (index < 0)
+		return;
+
+	if (fadeOut > 0)
+	{
+		fadeLayer(layer, 0.f, fadeOut);
+		_layers[index].removeWhenFaded = true;
+		return;
+	}
+
+	//swap with the last one, the order of additive layers doesn't matter
+	if (index != (int)_layers.size() - 1)
+	{
+		std::swap(_layers[index], _layers.back());
+	}
+	_layers.pop_back();
+
+	evaluate();
+}
+
+int GlyphAnimator::findLayer(int layer) const
+{
+	for (int i = 0, numLayers = (int)_layers.size(); i < numLayers; ++i)
+	{
+		if (_layers[i].id == layer)
+			return i;
+	}
+	return -1;
+}
+
+bool GlyphAnimator::updateLayers(float dt)
+{
+	bool changing = false;
+
+	for (size_t i = 0; i < _layers.size();)
+	{
+		Layer& layer = _layers[i];
+		const bool playing = layer.loop || layer.elapsed < layer.endTime;
+		layer.elapsed += dt;
+
+		if (layer.weight != layer.targetWeight)
+		{
+			const float step = layer.fadeSpeed * dt;
+			if (fabsf(layer.targetWeight - layer.weight) <= step)
+				layer.weight = layer.targetWeight;
+			else
+				layer.weight += layer.targetWeight > layer.weight ? step : -step;
+			changing = true;
+		}
+
+		const bool finished = !layer.loop && layer.elapsed >= layer.endTime && layer.endsAtRest;
+		const bool faded = layer.removeWhenFaded && layer.weight == 0;
+
+		if (finished || faded)
+		{
+			std::swap(_layers[i], _layers.back());
+			_layers.pop_back();
+			changing = true;
+			continue;
+		}
+
+		if (playing)
+			changing = true;
+
+		++i;
+	}
+
+	return changing;
+}
+
+void GlyphAnimator::blendLayers(int index, GlyphState& state) const
+{
+	const GlyphLayout& layout = _glyphs[index].layout;
+	const float glyphX = (layout.left + layout.right) * 0.5f;
+
+	for (const Layer& layer : _layers)
+	{
+		if (layer.weight == 0)
+			continue;
+
+		float localTime = layer.elapsed - layer.startOffsets[index];
+		if (layer.loop && localTime > 0 && layer.effect.getLength() > 0)
+		{
+			localTime = fmodf(localTime, layer.effect.getLength());
+		}
+
+		GlyphState layerState = kRestState;
+		layer.effect.evaluate(localTime, glyphX, layerState);
+
+		const float weight = layer.weight;
+		state.offsetX += layerState.offsetX * weight;
+		state.offsetY += layerState.offsetY * weight;
+		state.rotation += layerState.rotation * weight;
+		state.scale *= 1.f + (layerState.scale - 1.f) * weight;
+		state.opacity *= 1.f + (layerState.opacity - 1.f) * weight;
+	}
+}
+
+//GROUPS
+
+void GlyphAnimator::setGroups(const std::vector<int>& words, const std::vector<int>& lines)
+{
+	const std::vector<int>* groupOf[2] = { &words, &lines };
+	const int numGlyphs = getGlyphCount();
+
+	for (int level = 0; level < 2; ++level)
+	{
+		GroupLayer& layer = _groupLayers[level];
+		layer.groupOf.assign(numGlyphs, -1);
+		layer.groups.clear();
+
+		//bounding box of every group, the groups' centres are the middle of them
+		std::vector<float> bounds;
+		std::vector<bool> seen;
+
+		for (int i = 0; i < numGlyphs && i < (int)groupOf[level]->size(); ++i)
+		{
+			const int group = (*groupOf[level])[i];
+			const GlyphLayout& layout = _glyphs[i].layout;
+			if (group < 0 || layout.atlasIndex < 0)
+				continue;
+
+			if (group >= (int)layer.groups.size())
+			{
+				layer.groups.resize(group + 1);
+				bounds.resize((group + 1) * 4, 0.f);
+				seen.resize(group + 1, false);
+			}
+
+			float* box = &bounds[group * 4];
+			if (!seen[group])
+			{
+				seen[group] = true;
+				box[0] = layout.left; box[1] = layout.bottom;
+				box[2] = layout.right; box[3] = layout.top;
+			}
+			else
+			{
+				box[0] = fminf(box[0], layout.left); box[1] = fminf(box[1], layout.bottom);
+				box[2] = fmaxf(box[2], layout.right); box[3] = fmaxf(box[3], layout.top);
+			}
+
+			layer.groupOf[i] = group;
+		}
+
+		for (int group = 0; group < (int)layer.groups.size(); ++group)
+		{
+			const float* box = &bounds[group * 4];
+			layer.groups[group].centreX = (box[0] + box[2]) * 0.5f;
+			layer.groups[group].centreY = (box[1] + box[3]) * 0.5f;
+			layer.groups[group].state = kRestState;
+		}
+	}
+}
+
+void GlyphAnimator::startGroupEffect(GroupLevel level, const GlyphEffect& effect, const std::vector<float>& startOffsets)
+{
+	GroupLayer& layer = _groupLayers[(int)level];
+
+	float lastStart = 0;
+	for (int group = 0; group < (int)layer.groups.size(); ++group)
+	{
+		layer.groups[group].state.startTime = group < (int)startOffsets.size() ? startOffsets[group] : 0.f;
+		lastStart = fmaxf(lastStart, layer.groups[group].state.startTime);
+	}
+
+	layer.effect = effect;
+	layer.elapsed = 0;
+	layer.endTime = lastStart + effect.getLength();
+	layer.running = true;
+	layer.active = true;
+
+	evaluateGroups(layer);
+}
+
+//STAGGERED STARTS
+
+void GlyphAnimator::setGroups(const std::vector<GlyphStagger::Glyph>& glyphs)
+{
+	const int numGlyphs = getGlyphCount();
+	std::vector<int> words(numGlyphs, -1), lines(numGlyphs, -1);
+	for (int i = 0; i < numGlyphs && i < (int)glyphs.size(); ++i)
+	{
+		words[i] = glyphs[i].word;
+		lines[i] = glyphs[i].line;
+	}
+	setGroups(words, lines);
+}
+
+void GlyphAnimator::startStaggered(const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, float initialDelay, const std::vector<unsigned char>& variants, std::vector<float>& offsets)
+{
+	stagger.computeOffsets(glyphs, staggerDuration, initialDelay, offsets);
+
+	setStartOffsets(offsets);
+	setVariants(variants);
+	setEffect(effect);
+	start();
+}
+
+void GlyphAnimator::getGroupStaggerGlyphs(GroupLevel level, const std::vector<GlyphStagger::Glyph>& glyphs, std::vector<GlyphStagger::Glyph>& groups) const
+{
+	const int numGroups = getGroupCount(level);
+	groups.resize(numGroups);
+	for (int group = 0; group < numGroups; ++group)
+	{
+		groups[group].x = getGroupCentreX(level, group);
+		groups[group].y = getGroupCentreY(level, group);
+		groups[group].word = level == GroupLevel::WORD ? group : 0;
+		groups[group].line = level == GroupLevel::LINE ? group : 0;
+	}
+
+	if (level == GroupLevel::WORD)
+	{
+		//backwards, so the first letter of a word has the last say
+		for (int i = (int)glyphs.size() - 1; i >= 0; --i)
+		{
+			if (glyphs[i].word >= 0 && glyphs[i].word < numGroups)
+				groups[glyphs[i].word].line = glyphs[i].line;
+		}
+	}
+}
+
+void GlyphAnimator::startStaggeredGroupEffect(GroupLevel level, const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, float initialDelay)
+{
+	std::vector<GlyphStagger::Glyph> groups;
+	getGroupStaggerGlyphs(level, glyphs, groups);
+
+	std::vector<float> offsets;
+	stagger.computeOffsets(groups, staggerDuration, initialDelay, offsets);
+	startGroupEffect(level, effect, offsets);
+}
+
+int GlyphAnimator::addStaggeredLayer(const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, bool loop, float fadeIn, float weight)
+{
+	std::vector<float> offsets;
+	stagger.computeOffsets(glyphs, staggerDuration, 0, offsets);
+
+	const int layer = addLayer(effect, offsets, fadeIn > 0 ? 0.f : weight, loop);
+	if (fadeIn > 0)
+	{
+		fadeLayer(layer, weight, fadeIn);
+	}
+	return layer;
+}
+
+void GlyphAnimator::evaluateGroups(GroupLayer& layer)
+{
+	for (Group& group : layer.groups)
+	{
+		const float startTime = group.state.startTime;
+		group.state = kRestState;
+		group.state.startTime = startTime;
+
+		layer.effect.evaluate(layer.elapsed - startTime, group.centreX, group.state);
+	}
+}
+
+void GlyphAnimator::applyGroup(const GroupLayer& layer, int index, float& centreX, float& centreY, GlyphState& state) const
+{
+	if (!layer.active || index >= (int)layer.groupOf.size())
+		return;
+
+	const int groupIndex = layer.groupOf[index];
+	if (groupIndex < 0)
+		return;
+
+	const Group& group = layer.groups[groupIndex];
+	const GlyphState& groupState = group.state;
+
+	//scale and rotate the glyph's centre around the group's, then move it
+	float x = (centreX - group.centreX) * groupState.scale;
+	float y = (centreY - group.centreY) * groupState.scale;
+	if (groupState.rotation != 0)
+	{
+		const float radians = groupState.rotation * kPi / 180.f;
+		const float c = cosf(radians);
+		const float s = sinf(radians);
+		const float rotatedX = x * c + y * s;
+		y = -x * s + y * c;
+		x = rotatedX;
+	}
+
+	centreX = group.centreX + groupState.offsetX + x;
+	centreY = group.centreY + groupState.offsetY + y;
+	state.scale *= groupState.scale;
+	state.rotation += groupState.rotation;
+	state.opacity *= groupState.opacity;
+}
+
+void GlyphAnimator::getComposedState(int index, float& centreX, float& centreY, GlyphState& state) const
+{
+	const GlyphLayout& layout = _glyphs[index].layout;
+	state = _glyphs[index].state;
+
+	centreX = (layout.left + layout.right) * 0.5f + state.offsetX;
+	centreY = (layout.bottom + layout.top) * 0.5f + state.offsetY;
+
+	applyGroup(_groupLayers[(int)GroupLevel::WORD], index, centreX, centreY, state);
+	applyGroup(_groupLayers[(int)GroupLevel::LINE], index, centreX, centreY, state);
+}
+
+float GlyphAnimator::getOpacity(int index) const
+{
+	float opacity = _glyphs[index].state.opacity;
+
+	for (const GroupLayer& layer : _groupLayers)
+	{
+		if (layer.active && index < (int)layer.groupOf.size() && layer.groupOf[index] >= 0)
+		{
+			opacity *= layer.groups[layer.groupOf[index]].state.opacity;
+		}
+	}
+
+	return opacity;
+}
+
+size_t GlyphAnimator::getStateBytes() const
+{
+	size_t bytes = _glyphs.capacity() * sizeof(GlyphState);
+
+	for (const Layer& layer : _layers)
+	{
+		bytes += layer.startOffsets.capacity() * sizeof(float);
+	}
+
+	for (const GroupLayer& layer : _groupLayers)
+	{
+		bytes += layer.groupOf.capacity() * sizeof(int) + layer.groups.capacity() * sizeof(Group);
+	}
+
+	return bytes;
+}
+
+size_t GlyphAnimator::getEffectBytes() const
+{
+	size_t bytes = _effect.getBytes() + _groupLayers[0].effect.getBytes() + _groupLayers[1].effect.getBytes();
+
+	bytes += _layers.capacity() * sizeof(Layer);
+	for (const Layer& layer : _layers)
+	{
+		bytes += layer.effect.getBytes();
+	}
+
+	return bytes;
+}
+
+void GlyphAnimator::getCorners(int index, float* corners) const
+{
+	const GlyphLayout& layout = _glyphs[index].layout;
+
+	//the groups keep the quad a scaled and rotated rectangle, so they fold into one state
+	float centreX, centreY;
+	GlyphState state;
+	getComposedState(index, centreX, centreY, state);
+
+	const float halfWidth = (layout.right - layout.left) * 0.5f * state.scale;
+	const float halfHeight = (layout.top - layout.bottom) * 0.5f * state.scale;
+
+	if (state.rotation == 0)
+	{
+		corners[0] = centreX - halfWidth; corners[1] = centreY - halfHeight;
+		corners[2] = centreX + halfWidth; corners[3] = centreY - halfHeight;
+		corners[4] = centreX - halfWidth; corners[5] = centreY + halfHeight;
+		corners[6] = centreX + halfWidth; corners[7] = centreY + halfHeight;
+		return;
+	}
+
+	//clockwise rotation: (x, y) -> (x cos + y sin, -x sin + y cos)
+	const float radians = state.rotation * kPi / 180.f;
+	const float c = cosf(radians);
+	const float s = sinf(radians);
+
+	const float wx = halfWidth * c, wy = -halfWidth * s; //rotated (halfWidth, 0)
+	const float hx = halfHeight * s, hy = halfHeight * c; //rotated (0, halfHeight)
+
+	corners[0] = centreX - wx - hx; corners[1] = centreY - wy - hy;
+	corners[2] = centreX + wx - hx; corners[3] = centreY + wy - hy;
+	corners[4] = centreX - wx + hx; corners[5] = centreY - wy + hy;
+	corners[6] = centreX + wx + hx; corners[7] = centreY + wy + hy;
+}
@@ -0,0 +1,299 @@
+//
+//  GlyphAnimator.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphAnimator_h__
+#define __GlyphAnimator_h__
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include "GlyphArena.h"
+#include "GlyphPath.h"
+#include "GlyphStagger.h"
+
+//Where a glyph's quad sits once the label has been laid out, in label space
+struct GlyphLayout
+{
+	float left;
+	float bottom;
+	float right;
+	float top;
+	int page; //font atlas page (batch node) the quad lives in
+	int atlasIndex; //-1 for characters without a quad (spaces, new lines)
+};
+
+//Animated state of a glyph, applied on top of its layout
+struct GlyphState
+{
+	float startTime; //when the glyph's tracks start, from the stagger
+	float offsetX;
+	float offsetY;
+	float scale;
+	float rotation; //degrees, clockwise like cocos2d::Node
+	float opacity; //0 to 1, multiplies the label's opacity
+};
+
+//A per glyph animation described once for every glyph: a list of keys, each one
+//easing a single channel between two values. Keys of the same channel must be added
+//in time order. Before its first key a channel holds that key's from value, between
+//and after keys it holds the last to value, and channels without keys stay at rest.
+class GlyphEffect
+{
+	public:
+
+		enum class Channel : unsigned char
+		{
+			OFFSET_X,
+			OFFSET_Y,
+			SCALE,
+			ROTATION,
+			OPACITY
+		};
+
+		//Same curves as the cocos2d ease actions the sprite based effects use
+		enum class Ease : unsigned char
+		{
+			LINEAR,
+			SINE_IN,
+			SINE_OUT,
+			EXPONENTIAL_OUT,
+			EXPONENTIAL_IN_OUT,
+			BOUNCE_OUT,
+			ELASTIC_OUT,
+			ARC //0 -> 1 -> 0, a single JumpBy
+		};
+
+		//base + perX * the glyph's centre x, so one key can move every glyph to its own target
+		struct Value
+		{
+			float base;
+			float perX;
+
+			Value(float b = 0.f, float p = 0.f) : base(b), perX(p) {}
+		};
+
+		GlyphEffect();
+
+		//A key with a variant other than 0 only applies to the glyphs given that variant
+		//(see GlyphAnimator::setVariants), so glyphs can take different routes in one effect
+		void addKey(Channel channel, float start, float duration, const Value& from, const Value& to, Ease ease = Ease::LINEAR, unsigned char variant = 0);
+		//Moves the glyph along path, on top of what the offset keys do: at a fraction f of
+		//the key (after easing) the glyph is offset by scale * (the path's point at f minus
+		//its point at anchor), so the glyph rests where the path is at anchor. A negative
+		//scale turns the path around. Path keys follow the rules of a channel among
+		//themselves. The path is copied once and shared by every copy of the effect.
+		void addPathKey(const GlyphPath& path, float start, float duration, const Value& scale, float anchor = 0.f, Ease ease = Ease::LINEAR, unsigned char variant = 0);
+		void clear();
+		bool empty() const { return _keys.empty(); }
+
+		//time from a glyph's start until every key has finished
+		float getLength() const { return _length; }
+
+		void evaluate(float localTime, float glyphX, GlyphState& state, unsigned char variant = 0) const;
+
+		static float ease(Ease ease, float t);
+
+		size_t getBytes() const;
+
+	private:
+
+		struct Key
+		{
+			float start;
+			float duration;
+			Value from;
+			Value to;
+			Channel channel;
+			Ease ease;
+			unsigned char variant; //0 for every glyph
+			int path; //index in _paths for a path key (from is its scale), -1 otherwise
+			GlyphPath::Point rest; //the path's point at the key's anchor
+		};
+
+		std::vector<Key> _keys;
+		std::vector<std::shared_ptr<const GlyphPath>> _paths;
+		float _length;
+};
+
+//Runs one GlyphEffect over every glyph of a label, and optionally one over its words
+//and one over its lines. Layout and state for each glyph
+//sit side by side in a single block, tens of bytes per glyph, and the animator turns
+//them into quad corners without any cocos2d objects, so the label can write its
+//vertices directly.
+class GlyphAnimator
+{
+	public:
+
+		//Levels of glyph groups, a group is transformed as a whole around its centre
+		enum class GroupLevel : unsigned char
+		{
+			WORD,
+			LINE
+		};
+
+		GlyphAnimator();
+
+		//Allocates the block for numGlyphs glyphs, with every glyph at rest
+		void reset(int numGlyphs);
+		//Releases the block, or keeps it for the next reset() when it's in an arena
+		void clear();
+
+		//The glyph block comes from arena from now on (nullptr for the heap), which must
+		//outlive the animator. Clears the animator.
+		void setArena(GlyphArena* arena);
+		GlyphArena* getArena() const { return _glyphs.get_allocator().getArena(); }
+		//Allocates the block up front, so a reset() for up to numGlyphs doesn't allocate
+		void reserve(int numGlyphs) { _glyphs.reserve(numGlyphs); }
+		static size_t getBytesPerGlyph() { return sizeof(Glyph); }
+
+		int getGlyphCount() const { return (int)_glyphs.size(); }
+		GlyphLayout& getLayout(int index) { return _glyphs[index].layout; }
+		const GlyphLayout& getLayout(int index) const { return _glyphs[index].layout; }
+		const GlyphState& getState(int index) const { return _glyphs[index].state; }
+
+		void setStartOffsets(const std::vector<float>& offsets);
+		void setEffect(const GlyphEffect& effect);
+		//Variant of every glyph for the effect's variant keys, 0 past the end of variants.
+		//reset() puts every glyph back to 0.
+		void setVariants(const std::vector<unsigned char>& variants);
+
+		//Restarts the effect from time 0 and evaluates the first frame
+		void start();
+		void stop();
+		//true while the glyph effect, any layer or any group effect is running
+		bool isRunning() const;
+		float getElapsed() const { return _elapsed; }
+
+		//Advances the effects and evaluates every glyph and group. Returns false once
+		//everything has finished, which is then left on the effects' final values.
+		bool update(float dt);
+
+		//GROUPS
+		//Assigns every glyph to a word and a line (-1 for none) and works out each
+		//group's centre from the layouts, which must be set first. reset() removes them.
+		void setGroups(const std::vector<int>& words, const std::vector<int>& lines);
+		int getGroupCount(GroupLevel level) const { return (int)_groupLayers[(int)level].groups.size(); }
+		float getGroupCentreX(GroupLevel level, int group) const { return _groupLayers[(int)level].groups[group].centreX; }
+		float getGroupCentreY(GroupLevel level, int group) const { return _groupLayers[(int)level].groups[group].centreY; }
+		const GlyphState& getGroupState(GroupLevel level, int group) const { return _groupLayers[(int)level].groups[group].state; }
+		//Runs an effect once per group of the level, with a start offset per group, on its
+		//own clock. Its transform goes on top of the glyph effect's: glyph first, then
+		//word, then line. perX values use the group's centre.
+		void startGroupEffect(GroupLevel level, const GlyphEffect& effect, const std::vector<float>& startOffsets);
+
+		//STAGGERED STARTS
+		//How a label starts its effects, from the stagger entry of every glyph (word and
+		//line included) as the label lays them out. offsets is scratch the caller can keep
+		//between effects so a restart doesn't allocate.
+		void setGroups(const std::vector<GlyphStagger::Glyph>& glyphs);
+		void startStaggered(const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, float initialDelay, const std::vector<unsigned char>& variants, std::vector<float>& offsets);
+		//The stagger sees one entry per group, at its centre. A word sits on the line of its
+		//first letter.
+		void getGroupStaggerGlyphs(GroupLevel level, const std::vector<GlyphStagger::Glyph>& glyphs, std::vector<GlyphStagger::Glyph>& groups) const;
+		void startStaggeredGroupEffect(GroupLevel level, const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, float initialDelay);
+		//Fades the layer in from 0 to weight over fadeIn seconds when fadeIn is more than 0
+		int addStaggeredLayer(const GlyphEffect& effect, const GlyphStagger& stagger, const std::vector<GlyphStagger::Glyph>& glyphs, float staggerDuration, bool loop, float fadeIn, float weight);
+
+		//LAYERS
+		//Effects blended on top of the main one. Each layer adds its change from rest,
+		//times its weight, to every glyph: offsets and rotation add, scale and opacity
+		//changes multiply in. A layer that doesn't loop holds its final values, unless
+		//they are at rest, in which case it removes itself once it finishes.
+		//Layer ids are never reused. Removing a layer only drops its description and
+		//start offsets; the glyphs blend smoothly to whatever is left.
+		int addLayer(const GlyphEffect& effect, const std::vector<float>& startOffsets, float weight = 1.f, bool loop = false);
+		//Moves the layer's weight linearly to weight over duration seconds
+		void fadeLayer(int layer, float weight, float duration);
+		//Fades the layer out first when fadeOut is more than 0
+		void removeLayer(int layer, float fadeOut = 0.f);
+		bool hasLayer(int layer) const { return findLayer(layer) >= 0; }
+		int getLayerCount() const { return (int)_layers.size(); }
+
+		//The glyph's centre, scale, rotation and opacity with its word and line applied
+		void getComposedState(int index, float& centreX, float& centreY, GlyphState& state) const;
+		float getOpacity(int index) const;
+
+		//Corners of the glyph's quad after its state is applied, as x,y pairs ordered
+		//bottom left, bottom right, top left, top right
+		void getCorners(int index, float* corners) const;
+
+		size_t getStateBytes() const;
+		size_t getLayoutBytes() const { return _glyphs.capacity() * sizeof(GlyphLayout); }
+		size_t getEffectBytes() const;
+
+	private:
+
+		struct Glyph
+		{
+			GlyphLayout layout;
+			GlyphState state;
+			unsigned char variant;
+		};
+
+		struct Group
+		{
+			float centreX;
+			float centreY;
+			GlyphState state;
+		};
+
+		//One effect for every group of a level
+		struct GroupLayer
+		{
+			std::vector<int> groupOf; //group of every glyph, empty when groups aren't set
+			std::vector<Group> groups;
+			GlyphEffect effect;
+			float elapsed;
+			float endTime;
+			bool running;
+			bool active; //an effect has been started, so the groups' states apply
+		};
+
+		struct Layer
+		{
+			int id;
+			GlyphEffect effect;
+			std::vector<float> startOffsets; //per glyph
+			float elapsed;
+			float endTime;
+			float weight;
+			float targetWeight;
+			float fadeSpeed; //weight per second
+			bool loop;
+			bool endsAtRest;
+			bool removeWhenFaded;
+		};
+
+		void evaluate();
+		void blendLayers(int index, GlyphState& state) const;
+		//advances the layers and drops finished ones, true while any of them still changes
+		bool updateLayers(float dt);
+		int findLayer(int layer) const;
+		void evaluateGroups(GroupLayer& layer);
+		void applyGroup(const GroupLayer& layer, int index, float& centreX, float& centreY, GlyphState& state) const;
+		void clearGroups();
+
+		std::vector<Glyph, GlyphArenaAllocator<Glyph>> _glyphs;
+		GlyphEffect _effect;
+		float _elapsed;
+		float _endTime;
+		bool _running;
+		GroupLayer _groupLayers[2];
+		std::vector<Layer> _layers;
+		int _nextLayerId;
+};
+
+#endif /* __GlyphAnimator_h__ */
@@ -0,0 +1,123 @@
+//
+//  GlyphArena.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphArena.h"
+
+#include <stdint.h>
+#include <algorithm>
+
+GlyphArena::GlyphArena(size_t chunkSize /* = 16 * 1024 */)
+: _chunkSize(chunkSize > 0 ? chunkSize : 1024)
+, _allocationCount(0)
+, _chunkAllocationCount(0)
+{
+}
+
+GlyphArena::~GlyphArena()
+{
+	for (Chunk& chunk : _chunks)
+	{
+		::operator delete(chunk.data);
+	}
+}
+
+void GlyphArena::addChunk(size_t bytes)
+{
+	Chunk chunk;
+	chunk.size = std::max(bytes, _chunkSize);
+	chunk.data = static_cast<char*>(::operator new(chunk.size));
+	chunk.used = 0;
+	_chunks.push_back(chunk);
+	++_chunkAllocationCount;
+}
+
+void* GlyphArena::allocate(size_t bytes, size_t alignment)
+{
+	if (bytes == 0)
+		bytes = 1;
+
+	if (!_chunks.empty())
+	{
+		Chunk& chunk = _chunks.back();
+		const uintptr_t address = (uintptr_t)(chunk.data + chunk.used);
+		const size_t padding = (alignment - address % alignment) % alignment;
+
+		if (chunk.used + padding + bytes <= chunk.size)
+		{
+			chunk.used += padding + bytes;
+			++_allocationCount;
+			return chunk.data + chunk.used - bytes;
+		}
+	}
+
+	//::operator new aligns for any type, so a fresh chunk needs no padding
+	addChunk(bytes);
+	_chunks.back().used = bytes;
+	++_allocationCount;
+	return _chunks.back().data;
+}
+
+void GlyphArena::reserve(size_t bytes)
+{
+	if (!_chunks.empty() && _chunks.back().size - _chunks.back().used >= bytes)
+		return;
+
+	addChunk(bytes);
+}
+
+void GlyphArena::reset()
+{
+	_allocationCount = 0;
+
+	if (_chunks.size() == 1)
+	{
+		_chunks.back().used = 0;
+		return;
+	}
+
+	if (_chunks.empty())
+		return;
+
+	//what was spread over several chunks last time goes in one next time
+	const size_t total = getBytesReserved();
+	for (Chunk& chunk : _chunks)
+	{
+		::operator delete(chunk.data);
+	}
+	_chunks.clear();
+
+	addChunk(total);
+}
+
+size_t GlyphArena::getBytesUsed() const
+{
+	size_t bytes = 0;
+	for (const Chunk& chunk : _chunks)
+	{
+		bytes += chunk.used;
+	}
+	return bytes;
+}
+
+size_t GlyphArena::getBytesReserved() const
+{
+	size_t bytes = 0;
+	for (const Chunk& chunk : _chunks)
+	{
+		bytes += chunk.size;
+	}
+	return bytes;
+}
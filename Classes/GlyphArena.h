@@ -0,0 +1,114 @@
+//
+//  GlyphArena.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphArena_h__
+#define __GlyphArena_h__
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//A bump allocator: allocations are carved one after the other out of large chunks and
+//never freed one by one, only all together by reset() or when the arena goes. Labels
+//made together (AnimatedLabelBatch) put their per glyph blocks in one arena instead
+//of making an allocation each.
+class GlyphArena
+{
+	public:
+
+		//chunkSize is the size of every chunk after the first, which is as large as the
+		//first allocation needs when reserve() hasn't sized it already
+		explicit GlyphArena(size_t chunkSize = 16 * 1024);
+		~GlyphArena();
+
+		void* allocate(size_t bytes, size_t alignment);
+		//makes sure the next bytes allocated come from a single chunk
+		void reserve(size_t bytes);
+		//Forgets every allocation. When they took several chunks, the chunks are replaced
+		//by a single one as large as all of them, so the same allocations fit in one next time
+		void reset();
+
+		size_t getBytesUsed() const;
+		size_t getBytesReserved() const;
+		int getChunkCount() const { return (int)_chunks.size(); }
+		//allocations made since the arena was created or last reset
+		int getAllocationCount() const { return _allocationCount; }
+		//chunks taken from the heap over the arena's life
+		int getChunkAllocationCount() const { return _chunkAllocationCount; }
+
+	private:
+
+		GlyphArena(const GlyphArena&);
+		GlyphArena& operator=(const GlyphArena&);
+
+		struct Chunk
+		{
+			char *data;
+			size_t size;
+			size_t used;
+		};
+
+		void addChunk(size_t bytes);
+
+		std::vector<Chunk> _chunks; //the last one is allocated from
+		size_t _chunkSize;
+		int _allocationCount;
+		int _chunkAllocationCount;
+};
+
+//Standard allocator over an arena, so containers can keep their storage in one. With
+//no arena it's the plain heap. Freeing into an arena does nothing, the memory comes
+//back when the arena is reset. The arena travels with the container's contents when
+//they are moved or swapped.
+template <class T>
+class GlyphArenaAllocator
+{
+	public:
+
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		GlyphArenaAllocator(GlyphArena* arena = nullptr) : _arena(arena) {}
+		template <class U> GlyphArenaAllocator(const GlyphArenaAllocator<U>& other) : _arena(other.getArena()) {}
+
+		T* allocate(size_t count)
+		{
+			if (_arena != nullptr)
+				return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		}
+
+		void deallocate(T* pointer, size_t)
+		{
+			if (_arena == nullptr)
+				::operator delete(pointer);
+		}
+
+		GlyphArena* getArena() const { return _arena; }
+
+		template <class U> bool operator==(const GlyphArenaAllocator<U>& other) const { return _arena == other.getArena(); }
+		template <class U> bool operator!=(const GlyphArenaAllocator<U>& other) const { return _arena != other.getArena(); }
+
+	private:
+
+		GlyphArena *_arena;
+};
+
+#endif /* __GlyphArena_h__ */
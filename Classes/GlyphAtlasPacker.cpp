@@ -0,0 +1,132 @@
+//
+//  GlyphAtlasPacker.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphAtlasPacker.h"
+
+GlyphAtlasPacker::GlyphAtlasPacker(int pageWidth /* = 1024 */, int pageHeight /* = 1024 */, int padding /* = 1 */)
+: _pageWidth(pageWidth)
+, _pageHeight(pageHeight)
+, _padding(padding)
+{
+}
+
+bool GlyphAtlasPacker::find(uint64_t key, Region& region) const
+{
+	auto found = _regions.find(key);
+	if (found == _regions.end())
+		return false;
+
+	region = found->second;
+	return true;
+}
+
+GlyphAtlasPacker::Region GlyphAtlasPacker::pack(uint64_t key, int width, int height)
+{
+	Region region;
+	if (find(key, region))
+		return region;
+
+	region.page = -1;
+	region.x = region.y = 0;
+	region.width = width;
+	region.height = height;
+
+	if (width + _padding * 2 > _pageWidth || height + _padding * 2 > _pageHeight)
+		return region;
+
+	//only the last page has room worth looking for, the earlier ones were full for
+	//some glyph already and glyphs of a font are all about the same height
+	if (_pages.empty() || !packInPage((int)_pages.size() - 1, width, height, region))
+	{
+		Page page;
+		page.top = 0;
+		page.glyphArea = 0;
+		_pages.push_back(page);
+		packInPage((int)_pages.size() - 1, width, height, region);
+	}
+
+	_regions[key] = region;
+	return region;
+}
+
+bool GlyphAtlasPacker::packInPage(int pageIndex, int width, int height, Region& region)
+{
+	Page& page = _pages[pageIndex];
+	const int paddedWidth = width + _padding * 2;
+	const int paddedHeight = height + _padding * 2;
+
+	//the lowest shelf the glyph fits in without wasting more than a third of it
+	Shelf *best = nullptr;
+	for (Shelf& shelf : page.shelves)
+	{
+		if (shelf.height < paddedHeight || shelf.height * 2 > paddedHeight * 3 || shelf.used + paddedWidth > _pageWidth)
+			continue;
+
+		if (best == nullptr || shelf.height < best->height)
+			best = &shelf;
+	}
+
+	if (best == nullptr)
+	{
+		if (page.top + paddedHeight > _pageHeight)
+			return false;
+
+		Shelf shelf;
+		shelf.y = page.top;
+		shelf.height = paddedHeight;
+		shelf.used = 0;
+		page.shelves.push_back(shelf);
+		page.top += paddedHeight;
+		best = &page.shelves.back();
+	}
+
+	region.page = pageIndex;
+	region.x = best->used + _padding;
+	region.y = best->y + _padding;
+	region.width = width;
+	region.height = height;
+
+	best->used += paddedWidth;
+	page.glyphArea += (int64_t)width * height;
+	return true;
+}
+
+void GlyphAtlasPacker::clear()
+{
+	_pages.clear();
+	_regions.clear();
+}
+
+float GlyphAtlasPacker::getPageCoverage(int page) const
+{
+	if (page < 0 || page >= (int)_pages.size())
+		return 0.f;
+
+	return (float)((double)_pages[page].glyphArea / ((double)_pageWidth * _pageHeight));
+}
+
+size_t GlyphAtlasPacker::getBytes() const
+{
+	size_t bytes = _pages.capacity() * sizeof(Page);
+	for (const Page& page : _pages)
+	{
+		bytes += page.shelves.capacity() * sizeof(Shelf);
+	}
+
+	//the map's nodes and buckets
+	bytes += _regions.size() * (sizeof(uint64_t) + sizeof(Region) + sizeof(void*)) + _regions.bucket_count() * sizeof(void*);
+	return bytes;
+}
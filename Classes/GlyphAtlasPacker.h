@@ -0,0 +1,90 @@
+//
+//  GlyphAtlasPacker.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphAtlasPacker_h__
+#define __GlyphAtlasPacker_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+//Places glyph images from any number of fonts into shared fixed size pages, so labels
+//using different fonts can draw from the same texture. Glyphs are packed in shelves
+//(rows as tall as the first glyph put in them), which suits glyphs of a few similar
+//heights, and a glyph is only ever placed once: packing it again returns the same
+//region. Pages are never repacked, a new one is opened when the glyph fits nowhere.
+//Sizes and positions are in pixels, from the bottom left corner of the page.
+class GlyphAtlasPacker
+{
+	public:
+
+		struct Region
+		{
+			int page; //-1 when the glyph doesn't fit in a page at all
+			int x;
+			int y;
+			int width;
+			int height;
+		};
+
+		//padding is left around every glyph, so filtering doesn't bleed neighbours in
+		GlyphAtlasPacker(int pageWidth = 1024, int pageHeight = 1024, int padding = 1);
+
+		//a glyph of a font (any id the caller gives it)
+		static uint64_t makeKey(int font, char32_t glyph) { return ((uint64_t)(uint32_t)font << 32) | (uint32_t)glyph; }
+
+		bool find(uint64_t key, Region& region) const;
+		//Places a glyph not seen before, or returns where it already is. The region's
+		//page is -1 when it is larger than a page.
+		Region pack(uint64_t key, int width, int height);
+		void clear();
+
+		int getPageWidth() const { return _pageWidth; }
+		int getPageHeight() const { return _pageHeight; }
+		int getPageCount() const { return (int)_pages.size(); }
+		int getGlyphCount() const { return (int)_regions.size(); }
+		//0 to 1, the share of the page's pixels covered by glyphs (padding excluded)
+		float getPageCoverage(int page) const;
+
+		size_t getBytes() const;
+
+	private:
+
+		struct Shelf
+		{
+			int y;
+			int height;
+			int used; //width taken from the left
+		};
+
+		struct Page
+		{
+			std::vector<Shelf> shelves;
+			int top; //height taken by the shelves
+			int64_t glyphArea;
+		};
+
+		bool packInPage(int pageIndex, int width, int height, Region& region);
+
+		int _pageWidth;
+		int _pageHeight;
+		int _padding;
+		std::vector<Page> _pages;
+		std::unordered_map<uint64_t, Region> _regions;
+};
+
+#endif /* __GlyphAtlasPacker_h__ */
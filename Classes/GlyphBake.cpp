@@ -0,0 +1,275 @@
+//
+//  GlyphBake.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphBake.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+//corner offsets are stored in eighths of a point
+static const float kOffsetScale = 8.f;
+
+//GLYPH BAKED CLIP
+
+GlyphBakedClip::GlyphBakedClip()
+: _numGlyphs(0)
+, _capturedFrames(0)
+{
+}
+
+void GlyphBakedClip::beginCapture(int numGlyphs, const float* restCorners)
+{
+	_numGlyphs = std::max(numGlyphs, 0);
+	_capturedFrames = 0;
+
+	_captureRest.assign(restCorners, restCorners + _numGlyphs * 8);
+	_captureTimes.clear();
+	_captureCorners.clear();
+	_captureColors.clear();
+
+	_times.clear();
+	_offsets.clear();
+	_colors.clear();
+}
+
+void GlyphBakedClip::addFrame(float time, const float* corners, const unsigned char* colors)
+{
+	_captureTimes.push_back(time);
+	_captureCorners.insert(_captureCorners.end(), corners, corners + _numGlyphs * 8);
+	_captureColors.insert(_captureColors.end(), colors, colors + _numGlyphs * 16);
+}
+
+bool GlyphBakedClip::canInterpolate(int from, int to, float positionTolerance, int colorTolerance, bool colors) const
+{
+	const int cornerValues = _numGlyphs * 8;
+	const int colorValues = _numGlyphs * 16;
+	const float span = _captureTimes[to] - _captureTimes[from];
+
+	for (int frame = from + 1; frame < to; ++frame)
+	{
+		const float blend = span > 0 ? (_captureTimes[frame] - _captureTimes[from]) / span : 0.f;
+
+		const float *a = &_captureCorners[from * cornerValues];
+		const float *b = &_captureCorners[to * cornerValues];
+		const float *actual = &_captureCorners[frame * cornerValues];
+		for (int i = 0; i < cornerValues; ++i)
+		{
+			if (fabsf(a[i] + (b[i] - a[i]) * blend - actual[i]) > positionTolerance)
+				return false;
+		}
+
+		if (!colors)
+			continue;
+
+		const unsigned char *colorA = &_captureColors[from * colorValues];
+		const unsigned char *colorB = &_captureColors[to * colorValues];
+		const unsigned char *colorActual = &_captureColors[frame * colorValues];
+		for (int i = 0; i < colorValues; ++i)
+		{
+			if (fabsf(colorA[i] + (colorB[i] - colorA[i]) * blend - colorActual[i]) > colorTolerance)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool GlyphBakedClip::finishCapture(float positionTolerance /* = 0.25f */, int colorTolerance /* = 2 */)
+{
+	const int numFrames = (int)_captureTimes.size();
+	_capturedFrames = numFrames;
+
+	if (numFrames > 0 && _numGlyphs > 0)
+	{
+		const int colorValues = _numGlyphs * 16;
+		bool colors = false;
+		for (size_t i = colorValues; i < _captureColors.size() && !colors; ++i)
+		{
+			colors = _captureColors[i] != _captureColors[i % colorValues];
+		}
+
+		//greedy: stretch the span from the last keyframe for as long as it interpolates
+		std::vector<int> keyframes(1, 0);
+		for (int end = 2; end < numFrames; ++end)
+		{
+			if (!canInterpolate(keyframes.back(), end, positionTolerance, colorTolerance, colors))
+				keyframes.push_back(end - 1);
+		}
+		if (numFrames > 1)
+			keyframes.push_back(numFrames - 1);
+
+		const int cornerValues = _numGlyphs * 8;
+		_times.reserve(keyframes.size());
+		_offsets.reserve(keyframes.size() * cornerValues);
+		if (colors)
+			_colors.reserve(keyframes.size() * colorValues);
+
+		for (int frame : keyframes)
+		{
+			_times.push_back(_captureTimes[frame]);
+
+			for (int i = 0; i < cornerValues; ++i)
+			{
+				const float offset = roundf((_captureCorners[frame * cornerValues + i] - _captureRest[i]) * kOffsetScale);
+				_offsets.push_back((short)std::min(std::max(offset, -32767.f), 32767.f));
+			}
+
+			if (colors)
+				_colors.insert(_colors.end(), _captureColors.begin() + frame * colorValues, _captureColors.begin() + (frame + 1) * colorValues);
+		}
+	}
+
+	std::vector<float>().swap(_captureRest);
+	std::vector<float>().swap(_captureTimes);
+	std::vector<float>().swap(_captureCorners);
+	std::vector<unsigned char>().swap(_captureColors);
+
+	return !_times.empty();
+}
+
+int GlyphBakedClip::findKeyframe(float time, float& blend) const
+{
+	blend = 0;
+	if (_times.size() < 2 || time <= _times.front())
+		return 0;
+
+	if (time >= _times.back())
+	{
+		blend = 1;
+		return (int)_times.size() - 2;
+	}
+
+	const int next = (int)(std::upper_bound(_times.begin(), _times.end(), time) - _times.begin());
+	const float span = _times[next] - _times[next - 1];
+	blend = span > 0 ? (time - _times[next - 1]) / span : 1.f;
+	return next - 1;
+}
+
+void GlyphBakedClip::sampleGlyph(int keyframe, float blend, int glyph, const float* restCorners, float* corners, unsigned char* colors) const
+{
+	const int next = std::min(keyframe + 1, (int)_times.size() - 1);
+	const short *a = &_offsets[(keyframe * _numGlyphs + glyph) * 8];
+	const short *b = &_offsets[(next * _numGlyphs + glyph) * 8];
+
+	for (int i = 0; i < 8; ++i)
+	{
+		corners[i] = restCorners[i] + (a[i] + (b[i] - a[i]) * blend) / kOffsetScale;
+	}
+
+	if (_colors.empty())
+		return;
+
+	const unsigned char *colorA = &_colors[(keyframe * _numGlyphs + glyph) * 16];
+	const unsigned char *colorB = &_colors[(next * _numGlyphs + glyph) * 16];
+	for (int i = 0; i < 16; ++i)
+	{
+		colors[i] = (unsigned char)(colorA[i] + (colorB[i] - colorA[i]) * blend + 0.5f);
+	}
+}
+
+size_t GlyphBakedClip::getBytes() const
+{
+	return sizeof(GlyphBakedClip) + _times.capacity() * sizeof(float) + _offsets.capacity() * sizeof(short) + _colors.capacity()
+			+ (_captureRest.capacity() + _captureTimes.capacity() + _captureCorners.capacity()) * sizeof(float) + _captureColors.capacity();
+}
+
+//GLYPH BAKE CACHE
+
+GlyphBakeCache::GlyphBakeCache(size_t byteLimit /* = 1024 * 1024 */)
+{
+	_stats = Stats();
+	_stats.byteLimit = byteLimit;
+}
+
+void GlyphBakeCache::setByteLimit(size_t byteLimit)
+{
+	_stats.byteLimit = byteLimit;
+	evict();
+}
+
+std::shared_ptr<const GlyphBakedClip> GlyphBakeCache::find(const std::string& key)
+{
+	auto found = _index.find(key);
+	if (found == _index.end())
+	{
+		_stats.misses++;
+		return nullptr;
+	}
+
+	//to the front, the most recently used
+	_entries.splice(_entries.begin(), _entries, found->second);
+	_stats.hits++;
+	return found->second->clip;
+}
+
+void GlyphBakeCache::insert(const std::string& key, const std::shared_ptr<const GlyphBakedClip>& clip)
+{
+	auto found = _index.find(key);
+	if (found != _index.end())
+	{
+		erase(found->second);
+	}
+
+	const size_t bytes = clip->getBytes() + key.capacity();
+	if (bytes > _stats.byteLimit)
+		return;
+
+	Entry entry;
+	entry.key = key;
+	entry.clip = clip;
+	entry.bytes = bytes;
+	_entries.push_front(entry);
+	_index[key] = _entries.begin();
+
+	_stats.bytes += bytes;
+	_stats.clips++;
+
+	evict();
+}
+
+void GlyphBakeCache::erase(std::list<Entry>::iterator entry)
+{
+	_stats.bytes -= entry->bytes;
+	_stats.clips--;
+
+	_index.erase(entry->key);
+	_entries.erase(entry);
+}
+
+void GlyphBakeCache::evict()
+{
+	while (_stats.bytes > _stats.byteLimit && !_entries.empty())
+	{
+		erase(std::prev(_entries.end()));
+		_stats.evictions++;
+	}
+}
+
+void GlyphBakeCache::clear()
+{
+	_entries.clear();
+	_index.clear();
+	_stats.bytes = 0;
+	_stats.clips = 0;
+}
+
+void GlyphBakeCache::resetStats()
+{
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
@@ -0,0 +1,128 @@
+//
+//  GlyphBake.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphBake_h__
+#define __GlyphBake_h__
+
+#include <stddef.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//The quads of every glyph of a label over the length of an effect, captured once and
+//replayed on identical labels without running the effect again. Only keyframes that
+//can't be interpolated from the keyframes around them are kept, with corners stored as
+//offsets from the glyph's rest corners in eighths of a point. Colours are only kept when
+//they change during the clip.
+//Corners are in GlyphAnimator::getCorners order, colours are RGBA per corner in the
+//same order.
+class GlyphBakedClip
+{
+	public:
+
+		GlyphBakedClip();
+
+		//CAPTURE
+		//restCorners and corners hold 8 floats per glyph, colors 16 bytes per glyph
+		void beginCapture(int numGlyphs, const float* restCorners);
+		void addFrame(float time, const float* corners, const unsigned char* colors);
+		//Reduces the captured frames to keyframes, within positionTolerance (points) and
+		//colorTolerance (per channel) of every frame dropped. False if nothing was captured.
+		bool finishCapture(float positionTolerance = 0.25f, int colorTolerance = 2);
+
+		//PLAYBACK
+		float getDuration() const { return _times.empty() ? 0.f : _times.back(); }
+		int getGlyphCount() const { return _numGlyphs; }
+		int getKeyframeCount() const { return (int)_times.size(); }
+		int getCapturedFrameCount() const { return _capturedFrames; }
+		bool hasColors() const { return !_colors.empty(); }
+
+		//The keyframe at or before time and how far it is towards the next one, found once
+		//per frame for every glyph
+		int findKeyframe(float time, float& blend) const;
+		//The glyph's corners at that point, from the rest corners of the label it's played
+		//on. colors are only written when the clip has them.
+		void sampleGlyph(int keyframe, float blend, int glyph, const float* restCorners, float* corners, unsigned char* colors) const;
+
+		size_t getBytes() const;
+
+	private:
+
+		bool canInterpolate(int from, int to, float positionTolerance, int colorTolerance, bool colors) const;
+
+		int _numGlyphs;
+		int _capturedFrames;
+
+		std::vector<float> _captureRest;
+		std::vector<float> _captureTimes;
+		std::vector<float> _captureCorners; //frame major
+		std::vector<unsigned char> _captureColors; //frame major
+
+		std::vector<float> _times; //of the keyframes
+		std::vector<short> _offsets; //keyframe major, 8 per glyph, eighths of a point from rest
+		std::vector<unsigned char> _colors; //keyframe major, 16 per glyph, empty without colours
+};
+
+//Baked clips by key, least recently used first out once the clips are over the byte
+//limit. Clips are shared, so one evicted while a label plays it lives until it's done.
+class GlyphBakeCache
+{
+	public:
+
+		struct Stats
+		{
+			int hits;
+			int misses;
+			int evictions;
+			int clips;
+			size_t bytes;
+			size_t byteLimit;
+		};
+
+		explicit GlyphBakeCache(size_t byteLimit = 1024 * 1024);
+
+		void setByteLimit(size_t byteLimit);
+		size_t getByteLimit() const { return _stats.byteLimit; }
+
+		//The clip baked for key, counted as a hit, or nullptr counted as a miss
+		std::shared_ptr<const GlyphBakedClip> find(const std::string& key);
+		//Replaces a clip under the same key. A clip over the byte limit on its own isn't kept.
+		void insert(const std::string& key, const std::shared_ptr<const GlyphBakedClip>& clip);
+		void clear();
+
+		const Stats& getStats() const { return _stats; }
+		void resetStats();
+
+	private:
+
+		struct Entry
+		{
+			std::string key;
+			std::shared_ptr<const GlyphBakedClip> clip;
+			size_t bytes;
+		};
+
+		void erase(std::list<Entry>::iterator entry);
+		void evict();
+
+		std::list<Entry> _entries; //most recently used first
+		std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+		Stats _stats;
+};
+
+#endif /* __GlyphBake_h__ */
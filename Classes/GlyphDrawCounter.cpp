@@ -0,0 +1,113 @@
+//
+//  GlyphDrawCounter.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphDrawCounter.h"
+#include "GlyphTrace.h"
+
+#include <stdio.h>
+
+static GlyphDrawCounter* s_activeCounter = nullptr;
+static const GlyphDrawCounter::Counts kNoCounts = { 0, 0, 0, 0 };
+
+GlyphDrawCounter::GlyphDrawCounter()
+{
+	reset();
+}
+
+void GlyphDrawCounter::setActive(GlyphDrawCounter* counter)
+{
+	s_activeCounter = counter;
+}
+
+GlyphDrawCounter* GlyphDrawCounter::getActive()
+{
+	return s_activeCounter;
+}
+
+void GlyphDrawCounter::reset()
+{
+	_frame = _lastFrame = _total = kNoCounts;
+	_frameCount = 0;
+	_boundTexture = 0;
+	_batchMaterial = 0;
+}
+
+void GlyphDrawCounter::beginFrame()
+{
+	_frame = kNoCounts;
+	//the renderer starts every frame with its texture cache cleared
+	_boundTexture = 0;
+	_batchMaterial = 0;
+}
+
+void GlyphDrawCounter::addQuads(uint32_t texture, uint32_t material, int quads)
+{
+	++_frame.commands;
+	_frame.quads += quads;
+
+	if (material == 0 || material != _batchMaterial)
+	{
+		draw(texture);
+		_batchMaterial = material;
+	}
+}
+
+void GlyphDrawCounter::addCustom(uint32_t texture, int quads)
+{
+	++_frame.commands;
+	_frame.quads += quads;
+
+	draw(texture);
+	_batchMaterial = 0;
+}
+
+void GlyphDrawCounter::draw(uint32_t texture)
+{
+	++_frame.drawCalls;
+
+	if (texture != _boundTexture)
+	{
+		++_frame.textureSwitches;
+		_boundTexture = texture;
+	}
+}
+
+void GlyphDrawCounter::endFrame()
+{
+	_lastFrame = _frame;
+	_total.drawCalls += _frame.drawCalls;
+	_total.textureSwitches += _frame.textureSwitches;
+	_total.quads += _frame.quads;
+	_total.commands += _frame.commands;
+	++_frameCount;
+
+	if (GlyphTrace::isEnabled())
+	{
+		const uint64_t now = GlyphTrace::now();
+		GlyphTrace::recordCounter("drawCalls", _frame.drawCalls, now);
+		GlyphTrace::recordCounter("textureSwitches", _frame.textureSwitches, now);
+	}
+
+	_frame = kNoCounts;
+}
+
+std::string GlyphDrawCounter::toString() const
+{
+	char text[128];
+	snprintf(text, sizeof(text), "draw calls %d, texture switches %d, quads %d, commands %d",
+			_lastFrame.drawCalls, _lastFrame.textureSwitches, _lastFrame.quads, _lastFrame.commands);
+	return text;
+}
@@ -0,0 +1,85 @@
+//
+//  GlyphDrawCounter.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphDrawCounter_h__
+#define __GlyphDrawCounter_h__
+
+#include <stdint.h>
+#include <string>
+
+//A counting stand in for the renderer: labels report the commands they submit and the
+//counter works out the draw calls and texture binds the cocos2d renderer would issue
+//for them, so batching can be checked without a GPU (or in the headless build, by
+//feeding it commands directly). Like the renderer, it merges consecutive quad commands
+//that share a material (texture, shader and blend function) into one draw call, while
+//custom commands always draw on their own and end the current batch. A texture switch
+//is a draw call binding a different texture from the previous one.
+//Frame counts are also written to GlyphTrace as counter events while tracing is on.
+//  GlyphDrawCounter counter;
+//  GlyphDrawCounter::setActive(&counter);
+//  ...each frame
+//  counter.endFrame();
+//  counter.beginFrame();
+class GlyphDrawCounter
+{
+	public:
+
+		struct Counts
+		{
+			int drawCalls;
+			int textureSwitches;
+			int quads;
+			int commands;
+		};
+
+		GlyphDrawCounter();
+
+		//the counter labels report to, nullptr (the default) when nothing is counting
+		static void setActive(GlyphDrawCounter* counter);
+		static GlyphDrawCounter* getActive();
+
+		void beginFrame();
+		//a QuadCommand, batched with the previous command when the material matches
+		void addQuads(uint32_t texture, uint32_t material, int quads);
+		//a CustomCommand drawing one atlas page
+		void addCustom(uint32_t texture, int quads);
+		void endFrame();
+
+		//counts of the frame begun last, so far
+		const Counts& getFrame() const { return _frame; }
+		//counts of the last ended frame
+		const Counts& getLastFrame() const { return _lastFrame; }
+		//every ended frame added together
+		const Counts& getTotal() const { return _total; }
+		int getFrameCount() const { return _frameCount; }
+		void reset();
+
+		//"draw calls 3, texture switches 2, quads 120, commands 9" for the last frame
+		std::string toString() const;
+
+	private:
+
+		void draw(uint32_t texture);
+
+		Counts _frame;
+		Counts _lastFrame;
+		Counts _total;
+		int _frameCount;
+		uint32_t _boundTexture;
+		uint32_t _batchMaterial; //0 while no quad batch is open
+};
+
+#endif /* __GlyphDrawCounter_h__ */
@@ -0,0 +1,139 @@
+//
+//  GlyphEffectLibrary.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "GlyphEffectLibrary.h"
+
+GlyphEffect GlyphEffectLibrary::flyIn(float offsetX, float offsetY)
+{
+	GlyphEffect flyIn;
+	if (offsetX != 0)
+		flyIn.addKey(GlyphEffect::Channel::OFFSET_X, 0, 1, offsetX, 0.f, GlyphEffect::Ease::EXPONENTIAL_OUT);
+	if (offsetY != 0)
+		flyIn.addKey(GlyphEffect::Channel::OFFSET_Y, 0, 1, offsetY, 0.f, GlyphEffect::Ease::EXPONENTIAL_OUT);
+	return flyIn;
+}
+
+GlyphEffect GlyphEffectLibrary::dropFromTop(float offsetY)
+{
+	GlyphEffect drop;
+	drop.addKey(GlyphEffect::Channel::OFFSET_Y, 0, 1, offsetY, 0.f, GlyphEffect::Ease::BOUNCE_OUT);
+	return drop;
+}
+
+GlyphEffect GlyphEffectLibrary::typewriter()
+{
+	GlyphEffect appear;
+	appear.addKey(GlyphEffect::Channel::SCALE, 0, 0, 0.f, 1.f);
+	return appear;
+}
+
+GlyphEffect GlyphEffectLibrary::inSwell()
+{
+	GlyphEffect swell;
+	swell.addKey(GlyphEffect::Channel::SCALE, 0, 0.2, 0.f, 1.5f);
+	swell.addKey(GlyphEffect::Channel::SCALE, 0.2, 0.2, 1.5f, 1.f);
+	return swell;
+}
+
+GlyphEffect GlyphEffectLibrary::swell()
+{
+	GlyphEffect swell;
+	swell.addKey(GlyphEffect::Channel::SCALE, 0, 0.2, 1.f, 1.5f);
+	swell.addKey(GlyphEffect::Channel::SCALE, 0.2, 0.2, 1.5f, 1.f);
+	return swell;
+}
+
+GlyphEffect GlyphEffectLibrary::jump(float height)
+{
+	GlyphEffect jump;
+	jump.addKey(GlyphEffect::Channel::OFFSET_Y, 0, 0.5, 0.f, height, GlyphEffect::Ease::ARC);
+	return jump;
+}
+
+GlyphEffect GlyphEffectLibrary::stretchElastic(float stretchDuration, float releaseDuration, float stretchAmount, float labelWidth)
+{
+	//each glyph moves to (x - width/4) * stretchAmount, an offset of x * (stretchAmount - 1) - width/4 * stretchAmount
+	GlyphEffect::Value stretched(-(labelWidth/4) * stretchAmount, stretchAmount - 1);
+
+	GlyphEffect stretch;
+	stretch.addKey(GlyphEffect::Channel::OFFSET_X, 0, stretchDuration, 0.f, stretched);
+	stretch.addKey(GlyphEffect::Channel::OFFSET_X, stretchDuration, releaseDuration, stretched, 0.f, GlyphEffect::Ease::ELASTIC_OUT);
+	return stretch;
+}
+
+GlyphEffect GlyphEffectLibrary::inSpin(float duration, int spins, float labelWidth, bool spinGlyphs)
+{
+	//glyphs start at the horizontal centre, an offset of centreX - x
+	GlyphEffect spinIn;
+	spinIn.addKey(GlyphEffect::Channel::OFFSET_X, 0, duration, GlyphEffect::Value(labelWidth/2, -1), 0.f, GlyphEffect::Ease::EXPONENTIAL_OUT);
+	spinIn.addKey(GlyphEffect::Channel::OPACITY, 0, duration, 0.f, 1.f);
+	if (spinGlyphs)
+		spinIn.addKey(GlyphEffect::Channel::ROTATION, 0, duration, 0.f, -360.f * spins, GlyphEffect::Ease::SINE_OUT);
+	return spinIn;
+}
+
+GlyphEffect GlyphEffectLibrary::alongPath(const GlyphPath& path, float pathDuration, GlyphEffect::Ease ease)
+{
+	GlyphEffect alongPath;
+	alongPath.addPathKey(path, 0, pathDuration, 1.f, 1.f, ease);
+	return alongPath;
+}
+
+GlyphEffect GlyphEffectLibrary::vortex(float duration, int spins, float labelWidth)
+{
+	//every glyph circles the centre at its own distance, so a path serves every glyph
+	//with the same number of spins. Spin counts of 0 or less leave their glyphs still.
+	GlyphEffect vortex;
+	for (int variant = 1; variant <= 3; ++variant)
+	{
+		const int glyphSpins = spins + variant - 2;
+		if (glyphSpins > 0)
+			vortex.addPathKey(GlyphPath::circle(1, 0, glyphSpins), 0, duration, GlyphEffect::Value(-labelWidth/2, 1), 0, GlyphEffect::Ease::SINE_OUT, (unsigned char)variant);
+	}
+	return vortex;
+}
+
+void GlyphEffectLibrary::vortexVariants(int numGlyphs, std::vector<unsigned char>& variants)
+{
+	variants.assign(numGlyphs, 2);
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		if (i % 2 == 0)
+			variants[i] = 1;
+		else if (i % 3 == 0)
+			variants[i] = 3;
+	}
+}
+
+GlyphEffect GlyphEffectLibrary::wobble(float amplitude, float period)
+{
+	//a quarter of a sine wave per key
+	GlyphEffect wobble;
+	wobble.addKey(GlyphEffect::Channel::ROTATION, 0, period/4, 0.f, amplitude, GlyphEffect::Ease::SINE_OUT);
+	wobble.addKey(GlyphEffect::Channel::ROTATION, period/4, period/4, amplitude, 0.f, GlyphEffect::Ease::SINE_IN);
+	wobble.addKey(GlyphEffect::Channel::ROTATION, period/2, period/4, 0.f, -amplitude, GlyphEffect::Ease::SINE_OUT);
+	wobble.addKey(GlyphEffect::Channel::ROTATION, period*3/4, period/4, -amplitude, 0.f, GlyphEffect::Ease::SINE_IN);
+	return wobble;
+}
+
+GlyphEffect GlyphEffectLibrary::pulse(float scale, float period)
+{
+	GlyphEffect pulse;
+	pulse.addKey(GlyphEffect::Channel::SCALE, 0, period/2, 1.f, scale, GlyphEffect::Ease::SINE_OUT);
+	pulse.addKey(GlyphEffect::Channel::SCALE, period/2, period/2, scale, 1.f, GlyphEffect::Ease::SINE_IN);
+	return pulse;
+}
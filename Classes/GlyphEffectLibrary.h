@@ -0,0 +1,64 @@
+//
+//  GlyphEffectLibrary.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __GlyphEffectLibrary_h__
+#define __GlyphEffectLibrary_h__
+
+#include <vector>
+#include "GlyphAnimator.h"
+
+//The GlyphEffects behind AnimatedLabel's compact animations, built from plain numbers
+//so the label, the golden tests and anything else running a GlyphAnimator make exactly
+//the same effect. Offsets are in label space; a label scaled down passes offsets scaled
+//up to match.
+class GlyphEffectLibrary
+{
+	public:
+
+		//From (offsetX, offsetY) back to rest over a second, easing out exponentially.
+		//The fly ins from every side and the lines fly in.
+		static GlyphEffect flyIn(float offsetX, float offsetY);
+		//Down from offsetY, bouncing on landing
+		static GlyphEffect dropFromTop(float offsetY);
+		//Scale 0 until the glyph's start, then 1
+		static GlyphEffect typewriter();
+		//Up from nothing to 1.5 and back to 1
+		static GlyphEffect inSwell();
+		//1 to 1.5 and back
+		static GlyphEffect swell();
+		//Up by height and back down in half a second, for glyphs or words
+		static GlyphEffect jump(float height);
+		//Every glyph to (x - labelWidth/4) * stretchAmount, then elastically back
+		static GlyphEffect stretchElastic(float stretchDuration, float releaseDuration, float stretchAmount, float labelWidth);
+		//From the label's horizontal centre, fading in. With spinGlyphs each glyph turns
+		//back by spins turns, to cancel out the label spinning the other way.
+		static GlyphEffect inSpin(float duration, int spins, float labelWidth, bool spinGlyphs);
+		//Along path, resting where it ends
+		static GlyphEffect alongPath(const GlyphPath& path, float pathDuration, GlyphEffect::Ease ease);
+		//A circle through each glyph around the label's centre, spins - 1, spins or
+		//spins + 1 times as the glyph's variant (see vortexVariants) is 1, 2 or 3
+		static GlyphEffect vortex(float duration, int spins, float labelWidth);
+		//The variant of each glyph for vortex(): a turn less for even glyphs, one more for
+		//every third odd one
+		static void vortexVariants(int numGlyphs, std::vector<unsigned char>& variants);
+		//Rotation swinging between -amplitude and amplitude once a period, a looping layer
+		static GlyphEffect wobble(float amplitude, float period);
+		//Scale between 1 and scale once a period, a looping layer
+		static GlyphEffect pulse(float scale, float period);
+};
+
+#endif /* __GlyphEffectLibrary_h__ */
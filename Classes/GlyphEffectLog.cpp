@@ -0,0 +1,127 @@
+//
+//  GlyphEffectLog.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphEffectLog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+
+static const char* kEffectLogHeader = "GlyphEffectLog 1";
+
+int GlyphEffectLog::getLabelCount() const
+{
+	int labels = 0;
+	for (auto&& call : _calls)
+	{
+		labels = std::max(labels, call.label + 1);
+	}
+	return labels;
+}
+
+std::string GlyphEffectLog::toString() const
+{
+	std::string text = kEffectLogHeader;
+	text += "\n";
+
+	char line[256];
+	snprintf(line, sizeof(line), "calls %d\n", getCallCount());
+	text += line;
+
+	//time label name argument count, the arguments, then the text after a '|', one call a line
+	for (auto&& call : _calls)
+	{
+		snprintf(line, sizeof(line), "%.9g %d %s %d", call.time, call.label, call.name.c_str(), (int)call.args.size());
+		text += line;
+
+		for (double arg : call.args)
+		{
+			snprintf(line, sizeof(line), " %.17g", arg);
+			text += line;
+		}
+
+		//new lines and backslashes are escaped, so a call stays on one line
+		text += " |";
+		for (char c : call.text)
+		{
+			if (c == '\n')
+				text += "\\n";
+			else if (c == '\\')
+				text += "\\\\";
+			else
+				text += c;
+		}
+		text += "\n";
+	}
+
+	return text;
+}
+
+bool GlyphEffectLog::fromString(const std::string& text)
+{
+	clear();
+
+	std::istringstream stream(text);
+	std::string line;
+
+	if (!std::getline(stream, line) || line != kEffectLogHeader)
+		return false;
+
+	int callCount = 0;
+	if (!std::getline(stream, line) || sscanf(line.c_str(), "calls %d", &callCount) != 1)
+		return false;
+
+	for (int i = 0; i < callCount; ++i)
+	{
+		if (!std::getline(stream, line))
+			return false;
+
+		const size_t bar = line.find(" |");
+		if (bar == std::string::npos)
+			return false;
+
+		Call call;
+		int argCount = 0;
+		std::istringstream fields(line.substr(0, bar));
+		if (!(fields >> call.time >> call.label >> call.name >> argCount) || argCount < 0)
+			return false;
+
+		call.args.resize(argCount);
+		for (double& arg : call.args)
+		{
+			if (!(fields >> arg))
+				return false;
+		}
+
+		for (size_t c = bar + 2; c < line.size(); ++c)
+		{
+			if (line[c] == '\\' && c + 1 < line.size())
+			{
+				call.text += line[c + 1] == 'n' ? '\n' : line[c + 1];
+				++c;
+			}
+			else
+			{
+				call.text += line[c];
+			}
+		}
+
+		_calls.push_back(call);
+	}
+
+	return true;
+}
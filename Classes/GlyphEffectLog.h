@@ -0,0 +1,56 @@
+//
+//  GlyphEffectLog.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphEffectLog_h__
+#define __GlyphEffectLog_h__
+
+#include <string>
+#include <vector>
+
+//Effect calls made on labels, with their arguments and when they were made, so a run can
+//be replayed call for call. Stored as plain text like GlyphRecording, so a log taken on a
+//device can be read, diffed and replayed somewhere else.
+class GlyphEffectLog
+{
+	public:
+
+		struct Call
+		{
+			float time; //seconds since the log started
+			int label; //labels are numbered in the order they first appear
+			std::string name;
+			std::vector<double> args; //doubles, so seeds and random states survive the trip
+			std::string text; //the string argument, if the call has one
+		};
+
+		void clear() { _calls.clear(); }
+		void addCall(const Call& call) { _calls.push_back(call); }
+
+		int getCallCount() const { return (int)_calls.size(); }
+		const Call& getCall(int index) const { return _calls[index]; }
+		float getDuration() const { return _calls.empty() ? 0.f : _calls.back().time; }
+		int getLabelCount() const;
+
+		std::string toString() const;
+		//Returns false if text is not an effect log
+		bool fromString(const std::string& text);
+
+	private:
+
+		std::vector<Call> _calls; //in the order they were made
+};
+
+#endif /* __GlyphEffectLog_h__ */
@@ -0,0 +1,202 @@
+//
+//  GlyphHitGrid.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphHitGrid.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+//a glyph scaled up this many cells across is listed in none, it would fill the grid
+static const int kMaxCellsAcross = 64;
+
+GlyphHitGrid::GlyphHitGrid()
+: _cellSize(1)
+, _invCellSize(1)
+{
+}
+
+void GlyphHitGrid::reset(int numGlyphs, float cellSize)
+{
+	clear();
+
+	_cellSize = cellSize > 0 ? cellSize : 1.f;
+	_invCellSize = 1.f / _cellSize;
+
+	Glyph glyph = Glyph();
+	glyph.placed = false;
+	_glyphs.assign(numGlyphs, glyph);
+}
+
+void GlyphHitGrid::clear()
+{
+	_glyphs.clear();
+	_cells.clear();
+}
+
+int GlyphHitGrid::toCell(float coordinate) const
+{
+	return (int)floorf(coordinate * _invCellSize);
+}
+
+bool GlyphHitGrid::setGlyph(int index, const float corners[8])
+{
+	if (index < 0 || index >= (int)_glyphs.size())
+		return false;
+
+	Glyph& glyph = _glyphs[index];
+	if (glyph.placed && memcmp(glyph.corners, corners, sizeof(glyph.corners)) == 0)
+		return false;
+
+	float minX = corners[0], maxX = corners[0];
+	float minY = corners[1], maxY = corners[1];
+	for (int corner = 2; corner < 8; corner += 2)
+	{
+		minX = fminf(minX, corners[corner]);
+		maxX = fmaxf(maxX, corners[corner]);
+		minY = fminf(minY, corners[corner + 1]);
+		maxY = fmaxf(maxY, corners[corner + 1]);
+	}
+
+	const int minCellX = toCell(minX), maxCellX = toCell(maxX);
+	const int minCellY = toCell(minY), maxCellY = toCell(maxY);
+
+	if (!glyph.placed || minCellX != glyph.minCellX || maxCellX != glyph.maxCellX || minCellY != glyph.minCellY || maxCellY != glyph.maxCellY)
+	{
+		if (glyph.placed)
+		{
+			removeFromCells(index, glyph);
+		}
+
+		glyph.minCellX = minCellX;
+		glyph.maxCellX = maxCellX;
+		glyph.minCellY = minCellY;
+		glyph.maxCellY = maxCellY;
+		addToCells(index, glyph);
+	}
+
+	memcpy(glyph.corners, corners, sizeof(glyph.corners));
+	glyph.placed = true;
+	return true;
+}
+
+void GlyphHitGrid::removeGlyph(int index)
+{
+	if (index < 0 || index >= (int)_glyphs.size() || !_glyphs[index].placed)
+		return;
+
+	removeFromCells(index, _glyphs[index]);
+	_glyphs[index].placed = false;
+}
+
+void GlyphHitGrid::addToCells(int index, const Glyph& glyph)
+{
+	if (glyph.maxCellX - glyph.minCellX >= kMaxCellsAcross || glyph.maxCellY - glyph.minCellY >= kMaxCellsAcross)
+		return;
+
+	for (int cellY = glyph.minCellY; cellY <= glyph.maxCellY; ++cellY)
+	{
+		for (int cellX = glyph.minCellX; cellX <= glyph.maxCellX; ++cellX)
+		{
+			_cells[cellKey(cellX, cellY)].push_back(index);
+		}
+	}
+}
+
+void GlyphHitGrid::removeFromCells(int index, const Glyph& glyph)
+{
+	if (glyph.maxCellX - glyph.minCellX >= kMaxCellsAcross || glyph.maxCellY - glyph.minCellY >= kMaxCellsAcross)
+		return;
+
+	for (int cellY = glyph.minCellY; cellY <= glyph.maxCellY; ++cellY)
+	{
+		for (int cellX = glyph.minCellX; cellX <= glyph.maxCellX; ++cellX)
+		{
+			auto cell = _cells.find(cellKey(cellX, cellY));
+			if (cell == _cells.end())
+				continue;
+
+			//a cell holds a handful of glyphs, order doesn't matter
+			std::vector<int>& indices = cell->second;
+			auto found = std::find(indices.begin(), indices.end(), index);
+			if (found != indices.end())
+			{
+				*found = indices.back();
+				indices.pop_back();
+			}
+
+			//glyphs flying across the label would otherwise leave a trail of empty cells
+			if (indices.empty())
+			{
+				_cells.erase(cell);
+			}
+		}
+	}
+}
+
+int GlyphHitGrid::hitTest(float x, float y) const
+{
+	auto cell = _cells.find(cellKey(toCell(x), toCell(y)));
+	if (cell == _cells.end())
+		return -1;
+
+	int hit = -1;
+	for (int index : cell->second)
+	{
+		if (index > hit && contains(_glyphs[index].corners, x, y))
+			hit = index;
+	}
+
+	return hit;
+}
+
+bool GlyphHitGrid::contains(const float corners[8], float x, float y)
+{
+	//around the quad: bottom left, bottom right, top right, top left
+	static const int kOrder[4] = { 0, 1, 3, 2 };
+
+	bool positive = false, negative = false;
+	for (int i = 0; i < 4; ++i)
+	{
+		const float* a = &corners[kOrder[i] * 2];
+		const float* b = &corners[kOrder[(i + 1) % 4] * 2];
+		const float cross = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+
+		if (cross > 0)
+			positive = true;
+		else if (cross < 0)
+			negative = true;
+
+		if (positive && negative)
+			return false;
+	}
+
+	//a quad collapsed to a point or a line has no inside
+	return positive || negative;
+}
+
+size_t GlyphHitGrid::getBytes() const
+{
+	size_t bytes = _glyphs.capacity() * sizeof(Glyph);
+
+	for (auto&& cell : _cells)
+	{
+		bytes += sizeof(uint64_t) + sizeof(std::vector<int>) + sizeof(void*) + cell.second.capacity() * sizeof(int);
+	}
+	bytes += _cells.bucket_count() * sizeof(void*);
+
+	return bytes;
+}
@@ -0,0 +1,80 @@
+//
+//  GlyphHitGrid.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphHitGrid_h__
+#define __GlyphHitGrid_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+//Finds the glyph under a point from the glyphs' current quads, rotated, scaled and
+//moved by whatever is animating them. Each glyph is listed in the cells of a uniform
+//grid its bounding box touches, and a point only tests the glyphs listed in its own
+//cell against their exact quads, so a query costs the same on a label of ten glyphs or
+//ten thousand. Cells are hashed, so glyphs flying far outside the label don't grow the
+//grid. Updating a glyph that hasn't moved costs a comparison, one that has moved
+//within its cells doesn't touch the grid either.
+//Corners are in GlyphAnimator::getCorners order: bottom left, bottom right, top left,
+//top right, x then y.
+class GlyphHitGrid
+{
+	public:
+
+		GlyphHitGrid();
+
+		//numGlyphs glyphs, none of them placed. cellSize is best about a glyph's height.
+		void reset(int numGlyphs, float cellSize);
+		void clear();
+		int getGlyphCount() const { return (int)_glyphs.size(); }
+
+		//Places the glyph at its current corners, returns false if it hadn't moved
+		bool setGlyph(int index, const float corners[8]);
+		//the glyph can't be hit until placed again
+		void removeGlyph(int index);
+
+		//The glyph whose quad contains the point, the highest index (drawn last) when
+		//several overlap, -1 for none
+		int hitTest(float x, float y) const;
+
+		size_t getBytes() const;
+
+	private:
+
+		struct Glyph
+		{
+			float corners[8];
+			int minCellX;
+			int minCellY;
+			int maxCellX;
+			int maxCellY;
+			bool placed;
+		};
+
+		static uint64_t cellKey(int cellX, int cellY) { return ((uint64_t)(uint32_t)cellX << 32) | (uint32_t)cellY; }
+		int toCell(float coordinate) const;
+		void addToCells(int index, const Glyph& glyph);
+		void removeFromCells(int index, const Glyph& glyph);
+		static bool contains(const float corners[8], float x, float y);
+
+		float _cellSize;
+		float _invCellSize;
+		std::vector<Glyph> _glyphs;
+		std::unordered_map<uint64_t, std::vector<int>> _cells;
+};
+
+#endif /* __GlyphHitGrid_h__ */
@@ -0,0 +1,174 @@
+//
+//  GlyphPath.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphPath.h"
+
+#include <math.h>
+#include <algorithm>
+
+static const float kPi = 3.14159265358979f;
+
+//table entries per turn of a circle or spiral, and for a Bezier
+static const int kSamplesPerTurn = 32;
+static const int kBezierSamples = 64;
+
+GlyphPath GlyphPath::circle(float radius, float startAngle, float turns, bool clockwise /* = true */)
+{
+	return spiral(radius, radius, startAngle, turns, clockwise);
+}
+
+GlyphPath GlyphPath::spiral(float startRadius, float endRadius, float startAngle, float turns, bool clockwise /* = true */)
+{
+	GlyphPath path(Shape::SPIRAL);
+	path._startRadius = startRadius;
+	path._endRadius = endRadius;
+	path._startAngle = startAngle * kPi / 180.f;
+	path._sweep = fabsf(turns) * 2 * kPi * (clockwise ? -1.f : 1.f);
+
+	//a circle's arc length is already even in the angle, a single span is exact
+	const int samples = startRadius == endRadius ? 1 : std::max(1, (int)ceilf(fabsf(turns) * kSamplesPerTurn));
+	path.buildTable(samples);
+	return path;
+}
+
+GlyphPath GlyphPath::bezier(const Point& p0, const Point& p1, const Point& p2, const Point& p3)
+{
+	GlyphPath path(Shape::BEZIER);
+	path._points.push_back(p0);
+	path._points.push_back(p1);
+	path._points.push_back(p2);
+	path._points.push_back(p3);
+	path.buildTable(kBezierSamples);
+	return path;
+}
+
+GlyphPath GlyphPath::polyline(const std::vector<Point>& points)
+{
+	GlyphPath path(Shape::POLYLINE);
+	path._points = points;
+	if (path._points.empty())
+		path._points.push_back(Point());
+	if (path._points.size() == 1)
+		path._points.push_back(path._points.back());
+
+	//one entry per point, so the table is exact
+	path.buildTable((int)path._points.size() - 1);
+	return path;
+}
+
+GlyphPath::GlyphPath()
+: GlyphPath(Shape::POLYLINE)
+{
+	_points.assign(2, Point());
+	buildTable(1);
+}
+
+GlyphPath::GlyphPath(Shape shape)
+: _shape(shape)
+, _startRadius(0)
+, _endRadius(0)
+, _startAngle(0)
+, _sweep(0)
+, _closed(false)
+{
+}
+
+void GlyphPath::buildTable(int samples)
+{
+	_lengths.resize(samples + 1);
+	_lengths[0] = 0;
+
+	Point previous = evaluate(0);
+	for (int i = 1; i <= samples; ++i)
+	{
+		const Point point = evaluate((float)i / samples);
+		_lengths[i] = _lengths[i - 1] + hypotf(point.x - previous.x, point.y - previous.y);
+		previous = point;
+	}
+
+	//a circle is measured along its chord above, its real length is the arc's
+	if (_shape == Shape::SPIRAL && _startRadius == _endRadius)
+	{
+		_lengths[1] = fabsf(_startRadius * _sweep);
+	}
+
+	const Point start = evaluate(0);
+	_closed = getLength() > 0 && hypotf(previous.x - start.x, previous.y - start.y) <= getLength() * 1e-4f;
+}
+
+GlyphPath::Point GlyphPath::getPoint(float fraction) const
+{
+	const int samples = (int)_lengths.size() - 1;
+	const float length = getLength();
+
+	if (samples < 1 || length <= 0)
+		return evaluate(0);
+
+	if (fraction >= 1 && _closed)
+		return evaluate(0);
+
+	const float distance = std::min(std::max(fraction, 0.f), 1.f) * length;
+
+	//the first entry past the distance, the span before it holds the point
+	const int upper = std::min((int)(std::upper_bound(_lengths.begin(), _lengths.end(), distance) - _lengths.begin()), samples);
+	const int lower = upper - 1;
+	const float span = _lengths[upper] - _lengths[lower];
+	const float along = span > 0 ? (distance - _lengths[lower]) / span : 0.f;
+
+	return evaluate((lower + along) / samples);
+}
+
+GlyphPath::Point GlyphPath::evaluate(float t) const
+{
+	switch (_shape)
+	{
+		case Shape::SPIRAL:
+		{
+			const float radius = _startRadius + (_endRadius - _startRadius) * t;
+			const float angle = _startAngle + _sweep * t;
+			return Point(radius * cosf(angle), radius * sinf(angle));
+		}
+
+		case Shape::BEZIER:
+		{
+			const float u = 1 - t;
+			const float b0 = u * u * u;
+			const float b1 = 3 * u * u * t;
+			const float b2 = 3 * u * t * t;
+			const float b3 = t * t * t;
+			return Point(b0 * _points[0].x + b1 * _points[1].x + b2 * _points[2].x + b3 * _points[3].x,
+					b0 * _points[0].y + b1 * _points[1].y + b2 * _points[2].y + b3 * _points[3].y);
+		}
+
+		case Shape::POLYLINE:
+		{
+			const int segments = (int)_points.size() - 1;
+			const float position = std::min(std::max(t, 0.f), 1.f) * segments;
+			const int segment = std::min((int)position, segments - 1);
+			const float along = position - segment;
+			const Point& a = _points[segment];
+			const Point& b = _points[segment + 1];
+			return Point(a.x + (b.x - a.x) * along, a.y + (b.y - a.y) * along);
+		}
+	}
+
+	return Point();
+}
+
+size_t GlyphPath::getBytes() const
+{
+	return _points.capacity() * sizeof(Point) + _lengths.capacity() * sizeof(float);
+}
@@ -0,0 +1,84 @@
+//
+//  GlyphPath.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphPath_h__
+#define __GlyphPath_h__
+
+#include <stddef.h>
+#include <vector>
+
+//A curve glyphs can travel along at a constant speed. The curve itself is analytic
+//(circle, spiral, cubic Bezier or polyline) and a table of arc lengths at evenly
+//spaced parameters, built once when the path is made, turns a distance along the
+//path back into a parameter. One path is shared by every glyph following it, so
+//moving a glyph costs a binary search in the table and one evaluation of the curve.
+//Angles are in degrees, counterclockwise from +x, and y goes up like cocos2d.
+class GlyphPath
+{
+	public:
+
+		struct Point
+		{
+			float x;
+			float y;
+
+			Point(float px = 0.f, float py = 0.f) : x(px), y(py) {}
+		};
+
+		//around the origin, starting at startAngle
+		static GlyphPath circle(float radius, float startAngle, float turns, bool clockwise = true);
+		//around the origin, the radius changing evenly with the angle
+		static GlyphPath spiral(float startRadius, float endRadius, float startAngle, float turns, bool clockwise = true);
+		static GlyphPath bezier(const Point& p0, const Point& p1, const Point& p2, const Point& p3);
+		//through every point, at least two
+		static GlyphPath polyline(const std::vector<Point>& points);
+
+		GlyphPath();
+
+		float getLength() const { return _lengths.empty() ? 0.f : _lengths.back(); }
+
+		//The point at a fraction (clamped to 0 to 1) of the path's length, so a fraction
+		//moving at a constant rate moves the point at a constant speed
+		Point getPoint(float fraction) const;
+
+		size_t getBytes() const;
+
+	private:
+
+		enum class Shape : unsigned char
+		{
+			SPIRAL, //circles are spirals with a constant radius
+			BEZIER,
+			POLYLINE
+		};
+
+		explicit GlyphPath(Shape shape);
+
+		//the point at a parameter from 0 to 1, not evenly spaced along the path
+		Point evaluate(float t) const;
+		void buildTable(int samples);
+
+		Shape _shape;
+		std::vector<Point> _points; //Bezier control points, or the polyline's points
+		float _startRadius;
+		float _endRadius;
+		float _startAngle; //radians
+		float _sweep; //radians, negative clockwise
+		std::vector<float> _lengths; //arc length at each of the table's evenly spaced parameters
+		bool _closed; //ends where it starts, exactly rather than give or take rounding
+};
+
+#endif /* __GlyphPath_h__ */
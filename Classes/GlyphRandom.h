@@ -0,0 +1,54 @@
+//
+//  GlyphRandom.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphRandom_h__
+#define __GlyphRandom_h__
+
+//xorshift32: a few shifts per number and four bytes of state, so every label can have its
+//own. The same seed always gives the same sequence, on every platform.
+class GlyphRandom
+{
+	public:
+
+		explicit GlyphRandom(unsigned int seed = 0) { setSeed(seed); }
+
+		//zero is a fixed point of xorshift, so it is swapped for a constant
+		void setSeed(unsigned int seed) { _state = seed != 0 ? seed : 0x9E3779B9u; }
+		//where the sequence is now, to carry on from it later with setState
+		unsigned int getState() const { return _state; }
+		void setState(unsigned int state) { setSeed(state); }
+
+		unsigned int next()
+		{
+			_state ^= _state << 13;
+			_state ^= _state >> 17;
+			_state ^= _state << 5;
+			return _state;
+		}
+
+		//[0, 1), from the top 24 bits
+		float nextFloat() { return (next() >> 8) * (1.f / 16777216.f); }
+		//[min, max)
+		float nextFloat(float min, float max) { return min + (max - min) * nextFloat(); }
+		//[min, max], both included
+		int nextInt(int min, int max) { return min + (int)(nextFloat() * (max - min + 1)); }
+
+	private:
+
+		unsigned int _state;
+};
+
+#endif /* __GlyphRandom_h__ */
@@ -0,0 +1,185 @@
+//
+//  GlyphRecording.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphRecording.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+
+static const char* kRecordingHeader = "GlyphRecording 1";
+
+//far more characters than a label holds, the count is only read to size a frame
+static const int kMaxRecordingGlyphs = 65536;
+
+GlyphRecording::GlyphRecording()
+: _glyphCount(0)
+{
+}
+
+void GlyphRecording::clear()
+{
+	_times.clear();
+	_samples.clear();
+	_glyphCount = 0;
+}
+
+void GlyphRecording::addFrame(float time, const std::vector<GlyphSample>& samples)
+{
+	if (_times.empty())
+		_glyphCount = (int)samples.size();
+
+	//the glyph count is fixed by the first frame, later frames are padded or cut to it
+	GlyphSample empty = GlyphSample();
+	for (int i = 0; i < _glyphCount; ++i)
+	{
+		_samples.push_back(i < (int)samples.size() ? samples[i] : empty);
+	}
+	_times.push_back(time);
+}
+
+std::string GlyphRecording::toString() const
+{
+	std::string text = kRecordingHeader;
+	text += "\n";
+
+	char line[256];
+	snprintf(line, sizeof(line), "glyphs %d frames %d\n", _glyphCount, getFrameCount());
+	text += line;
+
+	for (int frame = 0; frame < getFrameCount(); ++frame)
+	{
+		snprintf(line, sizeof(line), "time %.6g\n", _times[frame]);
+		text += line;
+
+		for (int glyph = 0; glyph < _glyphCount; ++glyph)
+		{
+			const GlyphSample& sample = getSample(frame, glyph);
+			snprintf(line, sizeof(line), "%.4f %.4f %.5f %.5f %.4f %d %d %d %d\n",
+					sample.x, sample.y, sample.scaleX, sample.scaleY, sample.rotation,
+					sample.r, sample.g, sample.b, sample.a);
+			text += line;
+		}
+	}
+
+	return text;
+}
+
+bool GlyphRecording::fromString(const std::string& text)
+{
+	clear();
+
+	std::istringstream stream(text);
+	std::string line;
+
+	if (!std::getline(stream, line) || line != kRecordingHeader)
+		return false;
+
+	int glyphCount = 0;
+	int frameCount = 0;
+	if (!std::getline(stream, line) || sscanf(line.c_str(), "glyphs %d frames %d", &glyphCount, &frameCount) != 2)
+		return false;
+
+	if (glyphCount < 0 || glyphCount > kMaxRecordingGlyphs || frameCount < 0)
+		return false;
+
+	std::vector<GlyphSample> samples(glyphCount);
+
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		float time = 0;
+		if (!std::getline(stream, line) || sscanf(line.c_str(), "time %f", &time) != 1)
+			return false;
+
+		for (int glyph = 0; glyph < glyphCount; ++glyph)
+		{
+			GlyphSample& sample = samples[glyph];
+			int r, g, b, a;
+			if (!std::getline(stream, line) ||
+					sscanf(line.c_str(), "%f %f %f %f %f %d %d %d %d", &sample.x, &sample.y, &sample.scaleX, &sample.scaleY, &sample.rotation, &r, &g, &b, &a) != 9)
+				return false;
+			sample.r = r;
+			sample.g = g;
+			sample.b = b;
+			sample.a = a;
+		}
+
+		addFrame(time, samples);
+	}
+
+	_glyphCount = glyphCount;
+	return true;
+}
+
+bool GlyphRecording::matches(const GlyphRecording& golden, const Tolerance& tolerance /* = Tolerance() */, std::string* report /* = nullptr */) const
+{
+	char line[256];
+
+	if (golden.getFrameCount() != getFrameCount() || golden.getGlyphCount() != _glyphCount)
+	{
+		if (report != nullptr)
+		{
+			snprintf(line, sizeof(line), "expected %d frames of %d glyphs, got %d frames of %d glyphs\n",
+					golden.getFrameCount(), golden.getGlyphCount(), getFrameCount(), _glyphCount);
+			*report += line;
+		}
+		return false;
+	}
+
+	int mismatches = 0;
+
+	for (int frame = 0; frame < getFrameCount(); ++frame)
+	{
+		for (int glyph = 0; glyph < _glyphCount; ++glyph)
+		{
+			const GlyphSample& expected = golden.getSample(frame, glyph);
+			const GlyphSample& actual = getSample(frame, glyph);
+
+			bool same = fabsf(expected.x - actual.x) <= tolerance.position &&
+				fabsf(expected.y - actual.y) <= tolerance.position &&
+				fabsf(expected.scaleX - actual.scaleX) <= tolerance.scale &&
+				fabsf(expected.scaleY - actual.scaleY) <= tolerance.scale &&
+				fabsf(expected.rotation - actual.rotation) <= tolerance.rotation &&
+				abs(expected.r - actual.r) <= tolerance.color &&
+				abs(expected.g - actual.g) <= tolerance.color &&
+				abs(expected.b - actual.b) <= tolerance.color &&
+				abs(expected.a - actual.a) <= tolerance.color;
+
+			if (same)
+				continue;
+
+			//keep reports readable when a whole effect is off
+			if (report != nullptr && mismatches < 20)
+			{
+				snprintf(line, sizeof(line), "t=%g glyph %d: expected (%.3f, %.3f) scale (%.3f, %.3f) rotation %.3f rgba %d %d %d %d, got (%.3f, %.3f) scale (%.3f, %.3f) rotation %.3f rgba %d %d %d %d\n",
+						_times[frame], glyph,
+						expected.x, expected.y, expected.scaleX, expected.scaleY, expected.rotation, expected.r, expected.g, expected.b, expected.a,
+						actual.x, actual.y, actual.scaleX, actual.scaleY, actual.rotation, actual.r, actual.g, actual.b, actual.a);
+				*report += line;
+			}
+			++mismatches;
+		}
+	}
+
+	if (report != nullptr && mismatches > 20)
+	{
+		snprintf(line, sizeof(line), "... %d mismatching samples in total\n", mismatches);
+		*report += line;
+	}
+
+	return mismatches == 0;
+}
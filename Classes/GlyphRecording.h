@@ -0,0 +1,79 @@
+//
+//  GlyphRecording.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphRecording_h__
+#define __GlyphRecording_h__
+
+#include <string>
+#include <vector>
+
+//What one character looked like at one moment, position in label space
+struct GlyphSample
+{
+	float x;
+	float y;
+	float scaleX;
+	float scaleY;
+	float rotation;
+	unsigned char r;
+	unsigned char g;
+	unsigned char b;
+	unsigned char a;
+};
+
+//Samples of every character of a label at a series of timestamps, the golden output an
+//effect is checked against. Stored as plain text so golden files diff well.
+class GlyphRecording
+{
+	public:
+
+		struct Tolerance
+		{
+			float position;
+			float scale;
+			float rotation;
+			int color; //per channel, alpha included
+
+			Tolerance() : position(0.01f), scale(0.001f), rotation(0.01f), color(1) {}
+		};
+
+		GlyphRecording();
+
+		void clear();
+		void addFrame(float time, const std::vector<GlyphSample>& samples);
+
+		int getFrameCount() const { return (int)_times.size(); }
+		int getGlyphCount() const { return _glyphCount; }
+		float getTime(int frame) const { return _times[frame]; }
+		const GlyphSample& getSample(int frame, int glyph) const { return _samples[frame * _glyphCount + glyph]; }
+
+		std::string toString() const;
+		//Returns false if text is not a recording, or claims a negative number of frames or
+		//glyphs or more than 65536 glyphs
+		bool fromString(const std::string& text);
+
+		//True when both recordings have the same frames and glyphs and every sample is within
+		//tolerance of the golden one. Mismatches are described in report, if given.
+		bool matches(const GlyphRecording& golden, const Tolerance& tolerance = Tolerance(), std::string* report = nullptr) const;
+
+	private:
+
+		std::vector<float> _times;
+		std::vector<GlyphSample> _samples; //frame major
+		int _glyphCount;
+};
+
+#endif /* __GlyphRecording_h__ */
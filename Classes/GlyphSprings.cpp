@@ -0,0 +1,247 @@
+//
+//  GlyphSprings.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphSprings.h"
+
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLYPH_SPRINGS_SSE 1
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GLYPH_SPRINGS_NEON 1
+#include <arm_neon.h>
+#endif
+
+const float GlyphSprings::kStep = 1.f/120;
+const int GlyphSprings::kMaxStepsPerUpdate = 16;
+
+//below these (points and points per second) a glyph can't be told from rest
+static const float kRestOffset = 0.05f;
+static const float kRestSpeed = 0.5f;
+
+GlyphSprings::GlyphSprings()
+: _count(0)
+, _stiffness(300.f)
+, _damping(12.f)
+, _accumulator(0)
+, _awake(false)
+, _vectorized(hasVectorUnit())
+{
+}
+
+bool GlyphSprings::hasVectorUnit()
+{
+#if defined(GLYPH_SPRINGS_SSE) || defined(GLYPH_SPRINGS_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GlyphSprings::resize(int numGlyphs)
+{
+	_count = numGlyphs;
+
+	const size_t padded = (numGlyphs + 3) & ~3;
+	_x.assign(padded, 0.f);
+	_y.assign(padded, 0.f);
+	_velocityX.assign(padded, 0.f);
+	_velocityY.assign(padded, 0.f);
+
+	_accumulator = 0;
+	_awake = false;
+}
+
+void GlyphSprings::clear()
+{
+	std::vector<float>().swap(_x);
+	std::vector<float>().swap(_y);
+	std::vector<float>().swap(_velocityX);
+	std::vector<float>().swap(_velocityY);
+
+	_count = 0;
+	_accumulator = 0;
+	_awake = false;
+}
+
+void GlyphSprings::addVelocity(int index, float velocityX, float velocityY)
+{
+	if (index < 0 || index >= _count)
+		return;
+
+	_velocityX[index] += velocityX;
+	_velocityY[index] += velocityY;
+	_awake = true;
+}
+
+void GlyphSprings::addOffset(int index, float offsetX, float offsetY)
+{
+	if (index < 0 || index >= _count)
+		return;
+
+	_x[index] += offsetX;
+	_y[index] += offsetY;
+	_awake = true;
+}
+
+bool GlyphSprings::update(float dt)
+{
+	if (!_awake)
+		return false;
+
+	_accumulator += dt;
+
+	int steps = (int)(_accumulator / kStep);
+	_accumulator -= steps * kStep;
+	if (steps > kMaxStepsPerUpdate)
+	{
+		steps = kMaxStepsPerUpdate;
+	}
+
+	float maxOffset = 0, maxSpeed = 0;
+	for (int i = 0; i < steps; ++i)
+	{
+		step(i == steps - 1, maxOffset, maxSpeed);
+	}
+
+	if (steps > 0 && maxOffset < kRestOffset && maxSpeed < kRestSpeed)
+	{
+		sleep();
+	}
+
+	return _awake;
+}
+
+void GlyphSprings::sleep()
+{
+	//snap the last fraction of a point so the glyphs land exactly on the layout
+	const size_t padded = _x.size();
+	for (size_t i = 0; i < padded; ++i)
+	{
+		_x[i] = _y[i] = _velocityX[i] = _velocityY[i] = 0.f;
+	}
+
+	_accumulator = 0;
+	_awake = false;
+}
+
+void GlyphSprings::step(bool measure, float& maxOffset, float& maxSpeed)
+{
+	//semi implicit Euler: v += (-k x - c v) h, then x += v h
+	const float velocityScale = 1.f - _damping * kStep;
+	const float offsetToVelocity = -_stiffness * kStep;
+	const float h = kStep;
+	const size_t padded = _x.size();
+
+	float *x = _x.data(), *y = _y.data();
+	float *vx = _velocityX.data(), *vy = _velocityY.data();
+
+#if defined(GLYPH_SPRINGS_SSE)
+	if (_vectorized)
+	{
+		const __m128 a = _mm_set1_ps(velocityScale);
+		const __m128 b = _mm_set1_ps(offsetToVelocity);
+		const __m128 dt = _mm_set1_ps(h);
+		const __m128 signMask = _mm_set1_ps(-0.f);
+		__m128 offsetMax = _mm_setzero_ps();
+		__m128 speedMax = _mm_setzero_ps();
+
+		for (size_t i = 0; i < padded; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+			__m128 pvx = _mm_loadu_ps(vx + i), pvy = _mm_loadu_ps(vy + i);
+
+			pvx = _mm_add_ps(_mm_mul_ps(pvx, a), _mm_mul_ps(px, b));
+			pvy = _mm_add_ps(_mm_mul_ps(pvy, a), _mm_mul_ps(py, b));
+			px = _mm_add_ps(px, _mm_mul_ps(pvx, dt));
+			py = _mm_add_ps(py, _mm_mul_ps(pvy, dt));
+
+			_mm_storeu_ps(x + i, px); _mm_storeu_ps(y + i, py);
+			_mm_storeu_ps(vx + i, pvx); _mm_storeu_ps(vy + i, pvy);
+
+			if (measure)
+			{
+				offsetMax = _mm_max_ps(offsetMax, _mm_max_ps(_mm_andnot_ps(signMask, px), _mm_andnot_ps(signMask, py)));
+				speedMax = _mm_max_ps(speedMax, _mm_max_ps(_mm_andnot_ps(signMask, pvx), _mm_andnot_ps(signMask, pvy)));
+			}
+		}
+
+		if (measure)
+		{
+			float offsets[4], speeds[4];
+			_mm_storeu_ps(offsets, offsetMax);
+			_mm_storeu_ps(speeds, speedMax);
+			maxOffset = fmaxf(fmaxf(offsets[0], offsets[1]), fmaxf(offsets[2], offsets[3]));
+			maxSpeed = fmaxf(fmaxf(speeds[0], speeds[1]), fmaxf(speeds[2], speeds[3]));
+		}
+		return;
+	}
+#elif defined(GLYPH_SPRINGS_NEON)
+	if (_vectorized)
+	{
+		const float32x4_t a = vdupq_n_f32(velocityScale);
+		const float32x4_t b = vdupq_n_f32(offsetToVelocity);
+		const float32x4_t dt = vdupq_n_f32(h);
+		float32x4_t offsetMax = vdupq_n_f32(0.f);
+		float32x4_t speedMax = vdupq_n_f32(0.f);
+
+		for (size_t i = 0; i < padded; i += 4)
+		{
+			float32x4_t px = vld1q_f32(x + i), py = vld1q_f32(y + i);
+			float32x4_t pvx = vld1q_f32(vx + i), pvy = vld1q_f32(vy + i);
+
+			pvx = vmlaq_f32(vmulq_f32(pvx, a), px, b);
+			pvy = vmlaq_f32(vmulq_f32(pvy, a), py, b);
+			px = vmlaq_f32(px, pvx, dt);
+			py = vmlaq_f32(py, pvy, dt);
+
+			vst1q_f32(x + i, px); vst1q_f32(y + i, py);
+			vst1q_f32(vx + i, pvx); vst1q_f32(vy + i, pvy);
+
+			if (measure)
+			{
+				offsetMax = vmaxq_f32(offsetMax, vmaxq_f32(vabsq_f32(px), vabsq_f32(py)));
+				speedMax = vmaxq_f32(speedMax, vmaxq_f32(vabsq_f32(pvx), vabsq_f32(pvy)));
+			}
+		}
+
+		if (measure)
+		{
+			float offsets[4], speeds[4];
+			vst1q_f32(offsets, offsetMax);
+			vst1q_f32(speeds, speedMax);
+			maxOffset = fmaxf(fmaxf(offsets[0], offsets[1]), fmaxf(offsets[2], offsets[3]));
+			maxSpeed = fmaxf(fmaxf(speeds[0], speeds[1]), fmaxf(speeds[2], speeds[3]));
+		}
+		return;
+	}
+#endif
+
+	for (size_t i = 0; i < padded; ++i)
+	{
+		vx[i] = vx[i] * velocityScale + x[i] * offsetToVelocity;
+		vy[i] = vy[i] * velocityScale + y[i] * offsetToVelocity;
+		x[i] += vx[i] * h;
+		y[i] += vy[i] * h;
+
+		if (measure)
+		{
+			maxOffset = fmaxf(maxOffset, fmaxf(fabsf(x[i]), fabsf(y[i])));
+			maxSpeed = fmaxf(maxSpeed, fmaxf(fabsf(vx[i]), fabsf(vy[i])));
+		}
+	}
+}
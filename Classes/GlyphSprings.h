@@ -0,0 +1,88 @@
+//
+//  GlyphSprings.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphSprings_h__
+#define __GlyphSprings_h__
+
+#include <stddef.h>
+#include <vector>
+
+//A damped spring per glyph pulling its offset back to 0. Offsets and velocities are
+//kept as separate arrays (x, y, velocity x, velocity y) and stepped four glyphs at a
+//time with SSE or NEON where available, at a fixed step so the motion doesn't depend
+//on the frame rate. Impulses add to whatever the springs are doing, so triggering an
+//effect again mid flight just carries on from where the glyphs are. Once every glyph
+//is back at rest the springs go to sleep and update() costs nothing.
+class GlyphSprings
+{
+	public:
+
+		GlyphSprings();
+
+		//numGlyphs springs, all at rest and asleep
+		void resize(int numGlyphs);
+		void clear();
+		int getCount() const { return _count; }
+
+		//stiffness in 1/s^2 and damping in 1/s, critically damped at damping = 2 * sqrt(stiffness)
+		void setStiffness(float stiffness) { _stiffness = stiffness; }
+		void setDamping(float damping) { _damping = damping; }
+		float getStiffness() const { return _stiffness; }
+		float getDamping() const { return _damping; }
+
+		//IMPULSES
+		void addVelocity(int index, float velocityX, float velocityY);
+		void addOffset(int index, float offsetX, float offsetY);
+
+		//Runs as many fixed steps as dt covers. Returns false once asleep.
+		bool update(float dt);
+		bool isAwake() const { return _awake; }
+
+		//SSE or NEON by default where the build has it, the plain loop when off. Both give
+		//the same motion, the switch is there to check that and to profile.
+		static bool hasVectorUnit();
+		void setVectorized(bool vectorized) { _vectorized = vectorized && hasVectorUnit(); }
+		bool isVectorized() const { return _vectorized; }
+
+		float getOffsetX(int index) const { return _x[index]; }
+		float getOffsetY(int index) const { return _y[index]; }
+
+		size_t getBytes() const { return (_x.capacity() + _y.capacity() + _velocityX.capacity() + _velocityY.capacity()) * sizeof(float); }
+
+		static const float kStep; //seconds per step
+		static const int kMaxStepsPerUpdate; //a long frame drops the rest instead of catching up
+
+	private:
+
+		//one step over every glyph, returns the largest offset and speed when measure is set
+		void step(bool measure, float& maxOffset, float& maxSpeed);
+		void sleep();
+
+		//padded to a multiple of four, the padding stays at rest
+		std::vector<float> _x;
+		std::vector<float> _y;
+		std::vector<float> _velocityX;
+		std::vector<float> _velocityY;
+
+		int _count;
+		float _stiffness;
+		float _damping;
+		float _accumulator;
+		bool _awake;
+		bool _vectorized;
+};
+
+#endif /* __GlyphSprings_h__ */
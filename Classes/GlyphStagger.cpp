@@ -0,0 +1,169 @@
+//
+//  GlyphStagger.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphStagger.h"
+#include "GlyphRandom.h"
+
+#include <math.h>
+
+GlyphStagger GlyphStagger::linear()
+{
+	return GlyphStagger(Order::LINEAR);
+}
+
+GlyphStagger GlyphStagger::linearReverse()
+{
+	return GlyphStagger(Order::LINEAR_REVERSE);
+}
+
+GlyphStagger GlyphStagger::fromCenter()
+{
+	return GlyphStagger(Order::FROM_CENTER);
+}
+
+GlyphStagger GlyphStagger::random(unsigned int seed)
+{
+	GlyphStagger stagger(Order::RANDOM);
+	stagger._seed = seed;
+	return stagger;
+}
+
+GlyphStagger GlyphStagger::perWord()
+{
+	return GlyphStagger(Order::PER_WORD);
+}
+
+GlyphStagger GlyphStagger::perLine()
+{
+	return GlyphStagger(Order::PER_LINE);
+}
+
+GlyphStagger GlyphStagger::fromPoint(float x, float y)
+{
+	GlyphStagger stagger(Order::FROM_POINT);
+	stagger._pointX = x;
+	stagger._pointY = y;
+	return stagger;
+}
+
+GlyphStagger::GlyphStagger()
+: GlyphStagger(Order::LINEAR)
+{
+}
+
+GlyphStagger::GlyphStagger(Order order)
+: _order(order)
+, _seed(0)
+, _pointX(0)
+, _pointY(0)
+{
+}
+
+void GlyphStagger::computeOffsets(const std::vector<Glyph>& glyphs, float duration, float initialDelay, std::vector<float>& offsets) const
+{
+	const int numGlyphs = (int)glyphs.size();
+	offsets.resize(numGlyphs);
+
+	if (numGlyphs == 0)
+		return;
+
+	if (numGlyphs == 1)
+	{
+		offsets[0] = initialDelay;
+		return;
+	}
+
+	//First pass writes a key per glyph, the second scales the keys into [0, 1].
+	//Orders that need the span of the keys (centre, point, word, line) track it on the way.
+	float maxKey = 0;
+
+	switch (_order)
+	{
+		case Order::LINEAR:
+			for (int i = 0; i < numGlyphs; ++i)
+				offsets[i] = (float)i;
+			maxKey = (float)(numGlyphs - 1);
+			break;
+
+		case Order::LINEAR_REVERSE:
+			for (int i = 0; i < numGlyphs; ++i)
+				offsets[i] = (float)((numGlyphs - 1) - i);
+			maxKey = (float)(numGlyphs - 1);
+			break;
+
+		case Order::FROM_CENTER:
+		{
+			float minX = glyphs[0].x;
+			float maxX = glyphs[0].x;
+			for (int i = 1; i < numGlyphs; ++i)
+			{
+				minX = fminf(minX, glyphs[i].x);
+				maxX = fmaxf(maxX, glyphs[i].x);
+			}
+			float centreX = (minX + maxX) * 0.5f;
+			for (int i = 0; i < numGlyphs; ++i)
+			{
+				offsets[i] = fabsf(glyphs[i].x - centreX);
+				maxKey = fmaxf(maxKey, offsets[i]);
+			}
+			break;
+		}
+
+		case Order::RANDOM:
+		{
+			GlyphRandom random(_seed);
+			for (int i = 0; i < numGlyphs; ++i)
+			{
+				offsets[i] = random.nextFloat();
+			}
+			maxKey = 1;
+			break;
+		}
+
+		case Order::PER_WORD:
+			for (int i = 0; i < numGlyphs; ++i)
+			{
+				offsets[i] = (float)glyphs[i].word;
+				maxKey = fmaxf(maxKey, offsets[i]);
+			}
+			break;
+
+		case Order::PER_LINE:
+			for (int i = 0; i < numGlyphs; ++i)
+			{
+				offsets[i] = (float)glyphs[i].line;
+				maxKey = fmaxf(maxKey, offsets[i]);
+			}
+			break;
+
+		case Order::FROM_POINT:
+			for (int i = 0; i < numGlyphs; ++i)
+			{
+				float dx = glyphs[i].x - _pointX;
+				float dy = glyphs[i].y - _pointY;
+				offsets[i] = sqrtf(dx*dx + dy*dy);
+				maxKey = fmaxf(maxKey, offsets[i]);
+			}
+			break;
+	}
+
+	const float scale = maxKey > 0 ? duration / maxKey : 0;
+
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		offsets[i] = offsets[i] * scale + initialDelay;
+	}
+}
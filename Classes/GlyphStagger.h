@@ -0,0 +1,75 @@
+//
+//  GlyphStagger.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphStagger_h__
+#define __GlyphStagger_h__
+
+#include <vector>
+
+//Decides when each glyph of a sequential effect starts.
+//All start offsets are computed in a single pass and handed back as plain floats,
+//so effects no longer need a DelayTime + Sequence pair per glyph.
+class GlyphStagger
+{
+	public:
+
+		enum class Order
+		{
+			LINEAR,         //first glyph to last glyph
+			LINEAR_REVERSE, //last glyph to first glyph
+			FROM_CENTER,    //outwards from the horizontal centre of the label
+			RANDOM,         //shuffled, reproducible for a given seed
+			PER_WORD,       //every glyph of a word starts together, words in order
+			PER_LINE,       //every glyph of a line starts together, lines in order
+			FROM_POINT      //by distance from a point in label space
+		};
+
+		//What the stagger needs to know about a glyph, positions are in label space
+		struct Glyph
+		{
+			float x;
+			float y;
+			int word;
+			int line;
+		};
+
+		static GlyphStagger linear();
+		static GlyphStagger linearReverse();
+		static GlyphStagger fromCenter();
+		static GlyphStagger random(unsigned int seed);
+		static GlyphStagger perWord();
+		static GlyphStagger perLine();
+		static GlyphStagger fromPoint(float x, float y);
+
+		GlyphStagger();
+
+		//Writes one start offset per glyph. Offsets are spread over
+		//[initialDelay, initialDelay + duration]; a single glyph starts at initialDelay.
+		void computeOffsets(const std::vector<Glyph>& glyphs, float duration, float initialDelay, std::vector<float>& offsets) const;
+
+		Order getOrder() const { return _order; }
+
+	private:
+
+		explicit GlyphStagger(Order order);
+
+		Order _order;
+		unsigned int _seed;
+		float _pointX;
+		float _pointY;
+};
+
+#endif /* __GlyphStagger_h__ */
@@ -0,0 +1,254 @@
+//
+//  GlyphTextLayout.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "GlyphTextLayout.h"
+
+static const char32_t kNewLine = '\n';
+static const char32_t kCarriageReturn = '\r';
+static const char32_t kNextCharNoChangeX = '\b';
+
+bool GlyphTextLayout::Settings::operator==(const Settings& other) const
+{
+	return maxLineWidth == other.maxLineWidth && enableWrap == other.enableWrap && lineBreakWithoutSpaces == other.lineBreakWithoutSpaces
+			&& lineHeight == other.lineHeight && lineSpacing == other.lineSpacing && additionalKerning == other.additionalKerning
+			&& fontScale == other.fontScale && contentScaleFactor == other.contentScaleFactor
+			&& labelWidth == other.labelWidth && labelHeight == other.labelHeight
+			&& hAlignment == other.hAlignment && vAlignment == other.vAlignment;
+}
+
+GlyphTextLayout::GlyphTextLayout()
+: _numberOfLines(0)
+, _textDesiredHeight(0)
+, _letterOffsetY(0)
+, _width(0)
+, _height(0)
+, _complete(false)
+{
+}
+
+//as cocos2d::StringUtils
+bool GlyphTextLayout::isUnicodeSpace(char32_t character)
+{
+	return (character >= 0x0009 && character <= 0x000D) || character == 0x0020 || character == 0x0085 || character == 0x00A0 || character == 0x1680
+			|| (character >= 0x2000 && character <= 0x200A) || character == 0x2028 || character == 0x2029 || character == 0x202F
+			|| character == 0x205F || character == 0x3000;
+}
+
+bool GlyphTextLayout::isCJKUnicode(char32_t character)
+{
+	return (character >= 0x4E00 && character <= 0x9FBF) //CJK Unified Ideographs
+			|| (character >= 0x2E80 && character <= 0x2FDF) //CJK Radicals Supplement and Kangxi Radicals
+			|| (character >= 0x2FF0 && character <= 0x30FF) //Ideographic Description Characters, CJK Symbols and Punctuation and Japanese
+			|| (character >= 0x3100 && character <= 0x31BF) //Korean
+			|| (character >= 0xAC00 && character <= 0xD7AF) //Hangul Syllables
+			|| (character >= 0xF900 && character <= 0xFAFF) //CJK Compatibility Ideographs
+			|| (character >= 0xFE30 && character <= 0xFE4F) //CJK Compatibility Forms
+			|| (character >= 0x31C0 && character <= 0x4DFF) //Other extensions
+			|| (character >= 0x1F004 && character <= 0x1F682); //Emoticons
+}
+
+//Label::getFirstWordLen: a word, or as much of it as fits on a line on its own
+int GlyphTextLayout::getFirstWordLength(const std::u32string& text, int startIndex, const LetterLookup& lookup, const Settings& settings) const
+{
+	char32_t character = text[startIndex];
+	if (isCJKUnicode(character) || isUnicodeSpace(character) || character == kNewLine)
+		return 1;
+
+	int length = 1;
+	Letter letter;
+	if (!lookup(character, letter))
+		return length;
+
+	float nextLetterX = letter.xAdvance * settings.fontScale + settings.additionalKerning;
+	for (int index = startIndex + 1; index < (int)text.size(); ++index)
+	{
+		character = text[index];
+		if (!lookup(character, letter))
+			break;
+
+		const float letterX = (nextLetterX + letter.offsetX * settings.fontScale) / settings.contentScaleFactor;
+		if (settings.maxLineWidth > 0.f && letterX + letter.width * settings.fontScale > settings.maxLineWidth && !isUnicodeSpace(character) && length >= 2)
+			return length - 1;
+
+		nextLetterX += letter.xAdvance * settings.fontScale + settings.additionalKerning;
+		if (character == kNewLine || isUnicodeSpace(character) || isCJKUnicode(character))
+			break;
+
+		length++;
+	}
+
+	return length;
+}
+
+void GlyphTextLayout::addPlaceholder(int index, char32_t character)
+{
+	LetterInfo& info = _letters[index];
+	info.character = character;
+	info.placeholder = true;
+}
+
+//Label::multilineTextWrap and computeAlignmentOffset, with the same arithmetic so the
+//positions come out the same to the bit
+void GlyphTextLayout::layout(const std::u32string& text, const std::vector<int>& kernings, const LetterLookup& lookup, const Settings& settings)
+{
+	const int textLength = (int)text.size();
+	const bool byWord = settings.maxLineWidth > 0.f && !settings.lineBreakWithoutSpaces;
+	const float contentScaleFactor = settings.contentScaleFactor;
+	const float lineSpacing = settings.lineSpacing * contentScaleFactor;
+	const float scale = settings.fontScale;
+
+	LetterInfo empty = LetterInfo();
+	empty.placeholder = true;
+	_letters.assign(textLength, empty);
+	_linesWidth.clear();
+	_linesOffsetX.clear();
+	_complete = text.find(kNextCharNoChangeX) == std::u32string::npos;
+	if (!_complete)
+		return;
+
+	int lineIndex = 0;
+	float nextTokenX = 0.f;
+	float nextTokenY = 0.f;
+	float longestLine = 0.f;
+	float letterRight = 0.f;
+	Letter letter;
+
+	for (int index = 0; index < textLength; )
+	{
+		char32_t character = text[index];
+		if (character == kNewLine)
+		{
+			_linesWidth.push_back(letterRight);
+			letterRight = 0.f;
+			lineIndex++;
+			nextTokenX = 0.f;
+			nextTokenY -= settings.lineHeight * scale + lineSpacing;
+			addPlaceholder(index, character);
+			index++;
+			continue;
+		}
+
+		const int tokenLength = byWord ? getFirstWordLength(text, index, lookup, settings) : 1;
+		float tokenRight = letterRight;
+		float nextLetterX = nextTokenX;
+		bool newLine = false;
+
+		for (int tokenIndex = 0; tokenIndex < tokenLength; ++tokenIndex)
+		{
+			const int letterIndex = index + tokenIndex;
+			character = text[letterIndex];
+			if (character == kCarriageReturn || !lookup(character, letter))
+			{
+				addPlaceholder(letterIndex, character);
+				continue;
+			}
+
+			const float letterX = (nextLetterX + letter.offsetX * scale) / contentScaleFactor;
+			if (settings.enableWrap && settings.maxLineWidth > 0.f && nextTokenX > 0.f && letterX + letter.width * scale > settings.maxLineWidth
+					&& !isUnicodeSpace(character))
+			{
+				_linesWidth.push_back(letterRight);
+				letterRight = 0.f;
+				lineIndex++;
+				nextTokenX = 0.f;
+				nextTokenY -= settings.lineHeight * scale + lineSpacing;
+				newLine = true;
+				break;
+			}
+
+			LetterInfo& info = _letters[letterIndex];
+			info.character = character;
+			info.placeholder = false;
+			info.positionX = letterX;
+			info.positionY = (nextTokenY - letter.offsetY * scale) / contentScaleFactor;
+			info.atlasIndex = letter.atlasIndex;
+			info.lineIndex = lineIndex;
+
+			float letterWidth = 0.f;
+			if (!kernings.empty() && letterIndex < textLength - 1)
+				letterWidth = (float)kernings[letterIndex + 1];
+			letterWidth += letter.xAdvance * scale + settings.additionalKerning;
+
+			nextLetterX += letterWidth;
+			tokenRight = nextLetterX / contentScaleFactor;
+		}
+
+		//the token starts again on the next line
+		if (newLine)
+			continue;
+
+		nextTokenX = nextLetterX;
+		letterRight = tokenRight;
+		if (longestLine < letterRight)
+			longestLine = letterRight;
+
+		index += tokenLength;
+	}
+
+	if (_linesWidth.empty())
+		longestLine = letterRight;
+	_linesWidth.push_back(letterRight);
+
+	_numberOfLines = lineIndex + 1;
+	_textDesiredHeight = (_numberOfLines * settings.lineHeight * scale) / contentScaleFactor;
+	if (_numberOfLines > 1)
+		_textDesiredHeight += (_numberOfLines - 1) * settings.lineSpacing;
+
+	_width = settings.labelWidth > 0.f ? settings.labelWidth : longestLine;
+	_height = settings.labelHeight > 0.f ? settings.labelHeight : _textDesiredHeight;
+
+	computeAlignmentOffset(settings);
+}
+
+void GlyphTextLayout::computeAlignmentOffset(const Settings& settings)
+{
+	switch (settings.hAlignment)
+	{
+		case HAlignment::LEFT:
+			_linesOffsetX.assign(_numberOfLines, 0.f);
+			break;
+
+		case HAlignment::CENTER:
+			for (float lineWidth : _linesWidth)
+			{
+				_linesOffsetX.push_back((_width - lineWidth) / 2.f);
+			}
+			break;
+
+		case HAlignment::RIGHT:
+			for (float lineWidth : _linesWidth)
+			{
+				_linesOffsetX.push_back(_width - lineWidth);
+			}
+			break;
+	}
+
+	switch (settings.vAlignment)
+	{
+		case VAlignment::TOP:
+			_letterOffsetY = _height;
+			break;
+
+		case VAlignment::CENTER:
+			_letterOffsetY = (_height + _textDesiredHeight) / 2.f;
+			break;
+
+		case VAlignment::BOTTOM:
+			_letterOffsetY = _textDesiredHeight;
+			break;
+	}
+}
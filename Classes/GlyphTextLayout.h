@@ -0,0 +1,134 @@
+//
+//  GlyphTextLayout.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __GlyphTextLayout_h__
+#define __GlyphTextLayout_h__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//Line breaking and alignment of a string from its font's letter metrics, the same
+//layout cocos2d::Label works out in alignText, kept apart from any label or atlas so it
+//can run on a worker thread. Letters come from a lookup the caller provides, which must
+//be safe to call from the thread the layout runs on. Positions are in label space like
+//Label's LetterInfo: a letter's top left corner relative to the top of its first line,
+//before the line's alignment offset and letterOffsetY are added.
+//Strings with a \b (draw the next letter at the same x) aren't laid out, isComplete is
+//false and the label lays them out itself.
+class GlyphTextLayout
+{
+	public:
+
+		//A letter of the font, as in cocos2d::FontLetterDefinition
+		struct Letter
+		{
+			float offsetX;
+			float offsetY;
+			float width;
+			float height;
+			float xAdvance;
+			int atlasIndex; //the atlas page
+		};
+
+		//false when the font has no valid letter for the character
+		typedef std::function<bool(char32_t character, Letter& letter)> LetterLookup;
+
+		enum class HAlignment
+		{
+			LEFT,
+			CENTER,
+			RIGHT
+		};
+
+		enum class VAlignment
+		{
+			TOP,
+			CENTER,
+			BOTTOM
+		};
+
+		//The label's layout state the text is laid out with
+		struct Settings
+		{
+			float maxLineWidth = 0; //0 to break lines only at newlines
+			bool enableWrap = true;
+			bool lineBreakWithoutSpaces = false; //break anywhere, not only between words
+			float lineHeight = 0;
+			float lineSpacing = 0;
+			float additionalKerning = 0;
+			float fontScale = 1; //Label's _bmfontScale
+			float contentScaleFactor = 1;
+			float labelWidth = 0; //0 to fit the width to the text
+			float labelHeight = 0; //0 to fit the height to the text
+			HAlignment hAlignment = HAlignment::LEFT;
+			VAlignment vAlignment = VAlignment::TOP;
+
+			bool operator==(const Settings& other) const;
+			bool operator!=(const Settings& other) const { return !(*this == other); }
+		};
+
+		//Where a character ended up. Newlines, carriage returns and characters the font
+		//has no letter for are placeholders, with only the character set.
+		struct LetterInfo
+		{
+			char32_t character;
+			bool placeholder;
+			float positionX;
+			float positionY;
+			int atlasIndex;
+			int lineIndex;
+		};
+
+		GlyphTextLayout();
+
+		//kernings holds the font's kerning before each character, as returned by
+		//cocos2d::Font::getHorizontalKerningForTextUTF32, or is empty for none
+		void layout(const std::u32string& text, const std::vector<int>& kernings, const LetterLookup& lookup, const Settings& settings);
+
+		bool isComplete() const { return _complete; }
+		const std::vector<LetterInfo>& getLetters() const { return _letters; }
+		const std::vector<float>& getLinesWidth() const { return _linesWidth; }
+		const std::vector<float>& getLinesOffsetX() const { return _linesOffsetX; }
+		int getNumberOfLines() const { return _numberOfLines; }
+		float getTextDesiredHeight() const { return _textDesiredHeight; }
+		float getLetterOffsetY() const { return _letterOffsetY; }
+		//the label's content size
+		float getWidth() const { return _width; }
+		float getHeight() const { return _height; }
+
+		static bool isUnicodeSpace(char32_t character);
+		static bool isCJKUnicode(char32_t character);
+
+	private:
+
+		int getFirstWordLength(const std::u32string& text, int startIndex, const LetterLookup& lookup, const Settings& settings) const;
+		void addPlaceholder(int index, char32_t character);
+		void computeAlignmentOffset(const Settings& settings);
+
+		std::vector<LetterInfo> _letters;
+		std::vector<float> _linesWidth;
+		std::vector<float> _linesOffsetX;
+		int _numberOfLines;
+		float _textDesiredHeight;
+		float _letterOffsetY;
+		float _width;
+		float _height;
+		bool _complete;
+};
+
+#endif /* __GlyphTextLayout_h__ */
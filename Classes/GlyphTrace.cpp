@@ -0,0 +1,296 @@
+//
+//  GlyphTrace.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "GlyphTrace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct Event
+	{
+		const char* name;
+		const void* object;
+		uint64_t start;
+		uint32_t duration;
+		int value; //counter events only
+		bool counter;
+		char detail[GlyphTrace::kDetailLength + 1];
+	};
+
+	//Only its own thread writes to a buffer. The count is published after the event is
+	//written, so a dump on another thread only reads finished events. A clear only bumps
+	//the generation, the owner resets its count when it next sees the bump.
+	struct ThreadBuffer
+	{
+		std::atomic<int> count;
+		std::atomic<unsigned int> generation;
+		int threadId;
+		Event events[GlyphTrace::kEventsPerThread];
+	};
+
+	std::atomic<bool> s_enabled(false);
+	std::atomic<int> s_dropped(0);
+	std::atomic<unsigned int> s_generation(0);
+
+	//buffers outlive their threads, so a dump still shows threads that have finished
+	std::mutex s_buffersMutex;
+	std::vector<ThreadBuffer*> s_buffers;
+
+	thread_local ThreadBuffer* t_buffer = nullptr;
+
+	ThreadBuffer* getThreadBuffer()
+	{
+		if (t_buffer == nullptr)
+		{
+			ThreadBuffer *buffer = new ThreadBuffer();
+			buffer->count.store(0);
+			buffer->generation.store(s_generation.load());
+
+			std::lock_guard<std::mutex> lock(s_buffersMutex);
+			buffer->threadId = (int)s_buffers.size() + 1;
+			s_buffers.push_back(buffer);
+			t_buffer = buffer;
+		}
+
+		return t_buffer;
+	}
+
+	//the index for the next event in this thread's buffer, after catching up with a clear
+	int beginEvent(ThreadBuffer* buffer)
+	{
+		const unsigned int generation = s_generation.load(std::memory_order_acquire);
+		if (buffer->generation.load(std::memory_order_relaxed) != generation)
+		{
+			//the count first, so a dump that sees the new generation sees the reset too
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->generation.store(generation, std::memory_order_release);
+		}
+
+		return buffer->count.load(std::memory_order_relaxed);
+	}
+
+	void copyDetail(char* destination, const char* detail)
+	{
+		if (detail == nullptr)
+		{
+			destination[0] = '\0';
+			return;
+		}
+
+		strncpy(destination, detail, GlyphTrace::kDetailLength);
+		destination[GlyphTrace::kDetailLength] = '\0';
+
+		//don't leave half a UTF-8 character at the cut
+		const size_t length = strlen(destination);
+		size_t lead = length;
+		while (lead > 0 && ((unsigned char)destination[lead - 1] & 0xC0) == 0x80)
+			--lead;
+
+		if (lead > 0 && ((unsigned char)destination[lead - 1] & 0x80) != 0)
+		{
+			const unsigned char c = destination[lead - 1];
+			const size_t needed = c >= 0xF0 ? 4 : (c >= 0xE0 ? 3 : 2);
+			if (length - (lead - 1) < needed)
+				destination[lead - 1] = '\0';
+		}
+	}
+
+	void appendEscaped(std::string& json, const char* text)
+	{
+		for (const char* c = text; *c != '\0'; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				json += '\\';
+				json += *c;
+			}
+			else if ((unsigned char)*c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+				json += escaped;
+			}
+			else
+			{
+				json += *c;
+			}
+		}
+	}
+}
+
+void GlyphTrace::setEnabled(bool enabled)
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool GlyphTrace::isEnabled()
+{
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t GlyphTrace::now()
+{
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void GlyphTrace::record(const char* name, const void* object, const char* detail, uint64_t start, uint64_t end)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	const int index = beginEvent(buffer);
+	if (index >= kEventsPerThread)
+	{
+		s_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event& event = buffer->events[index];
+	event.name = name;
+	event.object = object;
+	event.start = start;
+	event.duration = (uint32_t)(end - start);
+	event.value = 0;
+	event.counter = false;
+	copyDetail(event.detail, detail);
+
+	buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void GlyphTrace::recordCounter(const char* name, int value, uint64_t time)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	const int index = beginEvent(buffer);
+	if (index >= kEventsPerThread)
+	{
+		s_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event& event = buffer->events[index];
+	event.name = name;
+	event.object = nullptr;
+	event.start = time;
+	event.duration = 0;
+	event.value = value;
+	event.counter = true;
+	event.detail[0] = '\0';
+
+	buffer->count.store(index + 1, std::memory_order_release);
+}
+
+std::string GlyphTrace::toJSON()
+{
+	std::string json = "{\"traceEvents\":[";
+	bool first = true;
+	char line[256];
+
+	std::lock_guard<std::mutex> lock(s_buffersMutex);
+	const unsigned int generation = s_generation.load(std::memory_order_acquire);
+
+	for (ThreadBuffer *buffer : s_buffers)
+	{
+		//not caught up with a clear yet, so everything in it was cleared
+		if (buffer->generation.load(std::memory_order_acquire) != generation)
+			continue;
+
+		const int count = buffer->count.load(std::memory_order_acquire);
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Event& event = buffer->events[i];
+
+			json += first ? "\n" : ",\n";
+			first = false;
+
+			json += "{\"name\":\"";
+			appendEscaped(json, event.name);
+
+			if (event.counter)
+			{
+				snprintf(line, sizeof(line), "\",\"cat\":\"AnimatedLabel\",\"ph\":\"C\",\"ts\":%llu,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%d}}",
+						(unsigned long long)event.start, buffer->threadId, event.value);
+				json += line;
+				continue;
+			}
+
+			snprintf(line, sizeof(line), "\",\"cat\":\"AnimatedLabel\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%d,\"args\":{\"label\":\"%p\",\"text\":\"",
+					(unsigned long long)event.start, (unsigned int)event.duration, buffer->threadId, event.object);
+			json += line;
+			appendEscaped(json, event.detail);
+			json += "\"}}";
+		}
+	}
+
+	json += "\n]}\n";
+	return json;
+}
+
+bool GlyphTrace::writeToFile(const std::string& path)
+{
+	FILE *file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	const std::string json = toJSON();
+	const bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+	fclose(file);
+
+	return written;
+}
+
+void GlyphTrace::clear()
+{
+	//the writers reset their own buffers, see beginEvent
+	std::lock_guard<std::mutex> lock(s_buffersMutex);
+	s_generation.fetch_add(1, std::memory_order_acq_rel);
+	s_dropped.store(0);
+}
+
+int GlyphTrace::getDroppedCount()
+{
+	return s_dropped.load(std::memory_order_relaxed);
+}
+
+//SCOPE
+
+GlyphTrace::Scope::Scope(const char* name, const void* object, const char* detail /* = nullptr */)
+: _name(nullptr)
+, _object(object)
+, _start(0)
+{
+	if (!isEnabled())
+		return;
+
+	_name = name;
+	copyDetail(_detail, detail);
+	_start = now();
+}
+
+GlyphTrace::Scope::~Scope()
+{
+	if (_name != nullptr)
+	{
+		record(_name, _object, _detail, _start, now());
+	}
+}
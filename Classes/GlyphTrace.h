@@ -0,0 +1,89 @@
+//
+//  GlyphTrace.h
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __GlyphTrace_h__
+#define __GlyphTrace_h__
+
+#include <stdint.h>
+#include <string>
+
+//Scoped timing events for label work, written to a buffer owned by the thread that
+//records them (no locks once a thread has its buffer) and dumped as Chrome trace event
+//JSON, to be loaded in chrome://tracing or Perfetto. Off until setEnabled(true), and
+//compiled out entirely when GLYPH_TRACE_DISABLED is defined.
+//AnimatedLabel records its creation, layout, every effect's setup, the per frame
+//evaluation of its animations and its quad writes, each tagged with the label's
+//address and the start of its text. GlyphDrawCounter adds its per frame draw call and
+//texture switch counts as counter events, e.g.
+//  GlyphTrace::setEnabled(true);
+//  ...
+//  GlyphTrace::writeToFile(cocos2d::FileUtils::getInstance()->getWritablePath() + "labels.json");
+class GlyphTrace
+{
+	public:
+
+		//events kept per thread, later events are dropped once a buffer is full
+		static const int kEventsPerThread = 8192;
+		//characters of the detail string kept per event
+		static const int kDetailLength = 23;
+
+		static void setEnabled(bool enabled);
+		static bool isEnabled();
+
+		//name must outlive the trace (a string literal), detail is copied
+		static void record(const char* name, const void* object, const char* detail, uint64_t start, uint64_t end);
+		//A counter sample (a Chrome "C" event), drawn as a graph under its name
+		static void recordCounter(const char* name, int value, uint64_t time);
+		//microseconds on the trace clock
+		static uint64_t now();
+
+		//Chrome trace event JSON of every event recorded so far
+		static std::string toJSON();
+		static bool writeToFile(const std::string& path);
+		//Forgets the events recorded so far. Safe while other threads record: a thread only
+		//ever resets its own buffer, the next time it records after the clear, and dumps
+		//skip the buffers that haven't been reset yet. An event whose scope spans the clear
+		//is dropped.
+		static void clear();
+		static int getDroppedCount();
+
+		//Records the time between its construction and destruction
+		class Scope
+		{
+			public:
+
+				Scope(const char* name, const void* object, const char* detail = nullptr);
+				~Scope();
+
+			private:
+
+				const char* _name; //nullptr when tracing was off at construction
+				const void* _object;
+				char _detail[kDetailLength + 1]; //copied now, the source may change in the scope
+				uint64_t _start;
+		};
+};
+
+#define GLYPH_TRACE_CONCAT_(a, b) a##b
+#define GLYPH_TRACE_CONCAT(a, b) GLYPH_TRACE_CONCAT_(a, b)
+
+#if defined(GLYPH_TRACE_DISABLED)
+#define GLYPH_TRACE_SCOPE(name, object, detail)
+#else
+#define GLYPH_TRACE_SCOPE(name, object, detail) GlyphTrace::Scope GLYPH_TRACE_CONCAT(glyphTraceScope, __LINE__)(name, object, detail)
+#endif
+
+#endif /* __GlyphTrace_h__ */
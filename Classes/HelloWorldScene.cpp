@@ -1,4 +1,10 @@
 #include "HelloWorldScene.h"
+#ifdef ANIMATED_LABEL_BENCHMARKS
+#include "AnimatedLabelBenchmark.h"
+#endif
+#ifdef ANIMATED_LABEL_GOLDENS
+#include "AnimatedLabelGoldens.h"
+#endif
 
 USING_NS_CC;
 
@@ -32,6 +38,15 @@ bool HelloWorld::init()
     
     setupTouch();
     
+    //static text doesn't need 60 frames a second, idle along at 10 until something animates
+    schedule([](float dt) {
+        static bool idle = false;
+        if (idle == AnimatedLabel::isAnythingAnimating()) {
+            idle = !idle;
+            cocos2d::Director::getInstance()->setAnimationInterval(idle ? 1.0 / 10 : 1.0 / 60);
+        }
+    }, "idleFrameRate");
+    
     return true;
 }
 
@@ -39,6 +54,16 @@ void HelloWorld::onEnter(){
     
     cocos2d::Layer::onEnter();
     
+#ifdef ANIMATED_LABEL_BENCHMARKS
+    //a 40 row results table, made with a batch and with a create call per label
+    AnimatedLabelBenchmark::runBatchCreation(AnimatedLabelBenchmark::makeResultsTable(40, "fonts/NBFont1.fnt", "fonts/arial.ttf", 30));
+    AnimatedLabelBenchmark::runEffectAllocations(this, "fonts/NBFont1.fnt");
+#endif
+#ifdef ANIMATED_LABEL_GOLDENS
+    //every effect on letter sprites against its golden, and the compact forms against those
+    AnimatedLabelGoldens::run(this, "fonts/NBFont1.fnt", ANIMATED_LABEL_GOLDEN_DIR);
+#endif
+    
     runNextAnimation();
     
 }
@@ -194,6 +219,10 @@ void HelloWorld::runNextAnimation(){
         label->setString("AnimatedLabel");
         title->setString("Run Custom Action On All Characters Sequentially");
         label->runActionOnAllSpritesSequentially(customAction, 4);
+        //the run's state came from the label's effect arena, the heap is only hit while it grows
+        AnimatedLabel::EffectArenaStats arena = label->getEffectArenaStats();
+        cocos2d::log("AnimatedLabel effect arena: %d allocations served, %d heap allocations in total, %d resets",
+                arena.allocations, arena.chunkAllocations, arena.resets);
     }
     //run custom action on all chars sequentially reverse
     else if (step == 18) {
@@ -207,11 +236,80 @@ void HelloWorld::runNextAnimation(){
         title->setString("And ttf fonts work as well!");
         label->runActionOnAllSpritesSequentially(customAction, 4);
     }
+    //per-vertex colour animation
+    else if (step == 20) {
+        label->setString("AnimatedLabel");
+        title->setString("Animate Colors Rainbow (Per Corner)");
+        label->animateColorsRainbow(2, 1, true);
+    }
+    //compact animation, no letter sprites
+    else if (step == 21) {
+        label->setString("AnimatedLabel");
+        title->setString("Compact Animate In Drop From Top");
+        label->setCompactAnimation(true);
+        label->animateInDropFromTop(2);
+        AnimatedLabel::MemoryUsage usage = label->getMemoryUsage();
+        cocos2d::log("AnimatedLabel memory: %d bytes state, %d bytes actions, %d bytes layout, %d letter sprites",
+                (int)usage.glyphState, (int)usage.actions, (int)usage.layout, usage.letterSpriteCount);
+    }
+    //word groups, one evaluation per word
+    else if (step == 22) {
+        label->setString("Animated Label Words");
+        title->setString("Animate Words Jump");
+        label->animateWordsJump(1, 40);
+    }
+    //a looping layer under a one shot effect
+    else if (step == 23) {
+        label->setString("AnimatedLabel");
+        title->setString("Wobble Layer Under Swell");
+        label->setCompactAnimation(true);
+        label->addWobbleLayer(10, 1);
+        label->animateSwell(1);
+    }
+    //letters swoop in along a curve at a constant speed
+    else if (step == 24) {
+        cocos2d::Size visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
+        label->setString("AnimatedLabel");
+        title->setString("Animate In Along Path");
+        GlyphPath swoop = GlyphPath::bezier(GlyphPath::Point(-visibleSize.width/2, -visibleSize.height/2),
+                GlyphPath::Point(-visibleSize.width/2, visibleSize.height/2),
+                GlyphPath::Point(visibleSize.width/4, visibleSize.height/4),
+                GlyphPath::Point(0, 0));
+        label->animateInAlongPath(swoop, 1.2, 1);
+    }
+    //the string is laid out on a worker, the effect waits for it
+    else if (step == 25) {
+        title->setString("Set String Deferred");
+        label->setStringDeferred("AnimatedLabel");
+        label->runWhenStringSet([](AnimatedLabel* laidOut) {
+            laidOut->animateInSwell(1);
+        });
+    }
+    //captured the first time round, replayed from the bake cache after that
+    else if (step == 26) {
+        label->setString("AnimatedLabel");
+        title->setString("Baked Animate In Spin");
+        label->playBakedEffect("spin", 1.5, [](AnimatedLabel* spinning) {
+            spinning->animateInSpin(1.5, 2);
+        });
+        const GlyphBakeCache::Stats& bakes = AnimatedLabel::getBakeCacheStats();
+        cocos2d::log("AnimatedLabel bake cache: %d hits, %d misses, %d clips, %d bytes",
+                bakes.hits, bakes.misses, bakes.clips, (int)bakes.bytes);
+    }
+    //the same seed gives the same vortex every time, the log can replay it at a fixed step
+    else if (step == 27) {
+        label->setString("AnimatedLabel");
+        title->setString("Seeded Vortex");
+        AnimatedLabel::startEffectLog();
+        label->setRandomSeed(27);
+        label->animateInVortex(1, 3);
+        cocos2d::log("AnimatedLabel effect log:\n%s", AnimatedLabel::stopEffectLog().toString().c_str());
+    }
      
     
     
     step++;
-    if (step > 19) {
+    if (step > 27) {
         step = 1;
     }
 }
@@ -233,12 +331,24 @@ void HelloWorld::setupTouch(){
 
 bool HelloWorld::onTouchBegan(cocos2d::Touch* touch, cocos2d::Event* event){
     
+    //a tapped letter pops up, wherever its current effect has put it
+    if (label != nullptr) {
+        AnimatedLabel::GlyphHit hit = label->hitTestGlyph(label->convertToNodeSpace(touch->getLocation()));
+        if (hit.index >= 0) {
+            cocos2d::log("Tapped letter %d, word %d, line %d", hit.index, hit.word, hit.line);
+            label->springImpulse(hit.index, cocos2d::Vec2(0, 300));
+        }
+    }
     return true;
     
 }
 
 void HelloWorld::onTouchMoved(cocos2d::Touch* touch, cocos2d::Event* event){
     
+    //letters at rest wobble away from the finger
+    if (label != nullptr) {
+        label->springRipple(label->convertToNodeSpace(touch->getLocation()), 400, 80);
+    }
     return;
     
 }
@@ -0,0 +1,915 @@
+//
+//  GlyphCoreTests.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//Unit tests for the parts of the glyph core that aren't effects: the golden recordings of
+//those are in GlyphGoldenTests. Needs no cocos2d, window or GL, so it runs headless on CI.
+//
+//	GlyphCoreTests
+//
+//Prints every failed check and returns 1 if there was one.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GlyphAtlasPacker.h"
+#include "GlyphBake.h"
+#include "GlyphDrawCounter.h"
+#include "GlyphEffectLog.h"
+#include "GlyphHitGrid.h"
+#include "GlyphPath.h"
+#include "GlyphSprings.h"
+#include "GlyphTextLayout.h"
+#include "GlyphTrace.h"
+
+static int s_failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static void check(bool passed, const char* condition, const char* file, int line)
+{
+	if (passed)
+		return;
+
+	fprintf(stderr, "%s:%d: failed: %s\n", file, line, condition);
+	s_failures++;
+}
+
+static bool near(float a, float b, float tolerance = 1e-4f)
+{
+	return fabsf(a - b) <= tolerance;
+}
+
+//SPRINGS
+
+static void testSpringsFixedStep()
+{
+	GlyphSprings once, stepped;
+	once.resize(5);
+	stepped.resize(5);
+	once.addVelocity(2, 100, -50);
+	stepped.addVelocity(2, 100, -50);
+
+	//a frame covering four steps moves the springs as four frames of one step do
+	once.update(GlyphSprings::kStep * 4);
+	for (int i = 0; i < 4; ++i)
+	{
+		stepped.update(GlyphSprings::kStep);
+	}
+	CHECK(near(once.getOffsetX(2), stepped.getOffsetX(2)));
+	CHECK(near(once.getOffsetY(2), stepped.getOffsetY(2)));
+	CHECK(once.getOffsetX(2) > 0 && once.getOffsetY(2) < 0);
+
+	//less than a step is carried over to the next frame, not stepped
+	const float x = once.getOffsetX(2);
+	once.update(GlyphSprings::kStep * 0.5f);
+	CHECK(once.getOffsetX(2) == x);
+	once.update(GlyphSprings::kStep * 0.5f);
+	CHECK(once.getOffsetX(2) != x);
+
+	//a long frame runs at most kMaxStepsPerUpdate steps
+	GlyphSprings hitch, capped;
+	hitch.resize(1);
+	capped.resize(1);
+	hitch.addOffset(0, 10, 0);
+	capped.addOffset(0, 10, 0);
+	hitch.update(1.f);
+	for (int i = 0; i < GlyphSprings::kMaxStepsPerUpdate; ++i)
+	{
+		capped.update(GlyphSprings::kStep);
+	}
+	CHECK(near(hitch.getOffsetX(0), capped.getOffsetX(0)));
+}
+
+static void testSpringsSleep()
+{
+	GlyphSprings springs;
+	springs.resize(3);
+	CHECK(!springs.isAwake());
+	CHECK(!springs.update(1.f/60));
+
+	springs.addVelocity(1, 0, 200);
+	CHECK(springs.isAwake());
+
+	int frames = 0;
+	while (springs.update(1.f/60) && frames < 600)
+	{
+		++frames;
+	}
+
+	//back at rest within ten seconds, snapped exactly onto the layout
+	CHECK(frames < 600);
+	CHECK(!springs.isAwake());
+	CHECK(springs.getOffsetX(1) == 0 && springs.getOffsetY(1) == 0);
+
+	//asleep, an update does nothing until the next impulse
+	CHECK(!springs.update(1.f/60));
+	springs.addOffset(0, 5, 0);
+	CHECK(springs.isAwake());
+}
+
+static void testSpringsVectorized()
+{
+	//seven glyphs, so the last group of four is padded
+	GlyphSprings vector, scalar;
+	vector.resize(7);
+	scalar.resize(7);
+	scalar.setVectorized(false);
+	CHECK(!scalar.isVectorized());
+	CHECK(vector.isVectorized() == GlyphSprings::hasVectorUnit());
+
+	for (int i = 0; i < 7; ++i)
+	{
+		vector.addVelocity(i, i * 30.f - 90, 45.f - i * 15);
+		scalar.addVelocity(i, i * 30.f - 90, 45.f - i * 15);
+		vector.addOffset(i, (float)(i % 3), -(float)(i % 2));
+		scalar.addOffset(i, (float)(i % 3), -(float)(i % 2));
+	}
+
+	for (int frame = 0; frame < 240; ++frame)
+	{
+		const bool vectorAwake = vector.update(1.f/60);
+		const bool scalarAwake = scalar.update(1.f/60);
+		CHECK(vectorAwake == scalarAwake);
+
+		for (int i = 0; i < 7; ++i)
+		{
+			CHECK(near(vector.getOffsetX(i), scalar.getOffsetX(i)));
+			CHECK(near(vector.getOffsetY(i), scalar.getOffsetY(i)));
+		}
+	}
+}
+
+//TRACE
+
+static int countOccurrences(const std::string& text, const std::string& pattern)
+{
+	int count = 0;
+	for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+		count++;
+	return count;
+}
+
+static void testTraceClearWhileRecording()
+{
+	std::atomic<bool> stop(false);
+	std::atomic<int> recorded(0);
+	std::thread writer([&stop, &recorded]()
+	{
+		while (!stop.load())
+		{
+			GlyphTrace::record("writer", nullptr, "w", GlyphTrace::now(), GlyphTrace::now());
+			recorded.fetch_add(1);
+		}
+	});
+
+	for (int i = 0; i < 200; ++i)
+	{
+		//a few events between clears, so some land between the writer's load and store
+		const int before = recorded.load();
+		while (recorded.load() < before + 2)
+			std::this_thread::yield();
+
+		GlyphTrace::clear();
+		GlyphTrace::toJSON();
+	}
+
+	const int before = recorded.load();
+	while (recorded.load() < before + 2)
+		std::this_thread::yield();
+	stop.store(true);
+	writer.join();
+
+	//the writer's last events came after the last clear
+	CHECK(countOccurrences(GlyphTrace::toJSON(), "\"writer\"") > 0);
+
+	//its buffer is only reset when it records again, which it never will
+	GlyphTrace::clear();
+	GlyphTrace::record("after", nullptr, "a", GlyphTrace::now(), GlyphTrace::now());
+	const std::string json = GlyphTrace::toJSON();
+	CHECK(countOccurrences(json, "\"writer\"") == 0);
+	CHECK(countOccurrences(json, "\"after\"") == 1);
+	CHECK(GlyphTrace::getDroppedCount() == 0);
+
+	GlyphTrace::clear();
+}
+
+//ATLAS PACKER
+
+static void testAtlasPackerShelves()
+{
+	GlyphAtlasPacker packer(64, 32, 1);
+
+	//side by side on the first shelf, padding on every side
+	const GlyphAtlasPacker::Region a = packer.pack(GlyphAtlasPacker::makeKey(0, 'a'), 10, 8);
+	const GlyphAtlasPacker::Region b = packer.pack(GlyphAtlasPacker::makeKey(0, 'b'), 10, 8);
+	CHECK(a.page == 0 && a.x == 1 && a.y == 1 && a.width == 10 && a.height == 8);
+	CHECK(b.page == 0 && b.x == 13 && b.y == 1);
+
+	//a glyph taller than the shelf opens a new one above it
+	const GlyphAtlasPacker::Region tall = packer.pack(GlyphAtlasPacker::makeKey(0, 'T'), 10, 14);
+	CHECK(tall.page == 0 && tall.x == 1 && tall.y == 11);
+
+	//the same glyph of another font is another glyph, the same glyph again isn't
+	const GlyphAtlasPacker::Region other = packer.pack(GlyphAtlasPacker::makeKey(1, 'a'), 10, 8);
+	CHECK(other.page == 0 && other.x == 25 && other.y == 1);
+	const GlyphAtlasPacker::Region again = packer.pack(GlyphAtlasPacker::makeKey(0, 'a'), 10, 8);
+	CHECK(again.page == a.page && again.x == a.x && again.y == a.y);
+	CHECK(packer.getGlyphCount() == 4);
+
+	GlyphAtlasPacker::Region found;
+	CHECK(packer.find(GlyphAtlasPacker::makeKey(0, 'T'), found) && found.y == tall.y);
+	CHECK(!packer.find(GlyphAtlasPacker::makeKey(0, 'z'), found));
+
+	CHECK(near(packer.getPageCoverage(0), (10 * 8 * 3 + 10 * 14) / (64.f * 32)));
+	CHECK(packer.getPageCoverage(1) == 0.f);
+}
+
+static void testAtlasPackerPages()
+{
+	GlyphAtlasPacker packer(32, 32, 1);
+
+	//too big for any page
+	const GlyphAtlasPacker::Region huge = packer.pack(GlyphAtlasPacker::makeKey(0, 'H'), 31, 4);
+	CHECK(huge.page == -1);
+	CHECK(packer.getPageCount() == 0);
+
+	//three shelves of 10 fill the 32 high page, the fourth goes to a new one
+	for (int i = 0; i < 3; ++i)
+	{
+		CHECK(packer.pack(GlyphAtlasPacker::makeKey(0, 'a' + i), 30, 8).page == 0);
+	}
+	const GlyphAtlasPacker::Region next = packer.pack(GlyphAtlasPacker::makeKey(0, 'd'), 30, 8);
+	CHECK(next.page == 1 && next.x == 1 && next.y == 1);
+	CHECK(packer.getPageCount() == 2);
+
+	packer.clear();
+	CHECK(packer.getPageCount() == 0 && packer.getGlyphCount() == 0);
+}
+
+//DRAW COUNTER
+
+static void testDrawCounterBatching()
+{
+	GlyphDrawCounter counter;
+	counter.beginFrame();
+
+	//two labels sharing a material are one draw call
+	counter.addQuads(1, 10, 5);
+	counter.addQuads(1, 10, 7);
+	//another material breaks the batch, on the same texture
+	counter.addQuads(1, 11, 2);
+	//material 0 never batches
+	counter.addQuads(2, 0, 1);
+	counter.addQuads(2, 0, 1);
+	//custom commands draw alone and close the batch
+	counter.addCustom(3, 4);
+	counter.addQuads(1, 11, 2);
+
+	const GlyphDrawCounter::Counts& frame = counter.getFrame();
+	CHECK(frame.commands == 7);
+	CHECK(frame.quads == 22);
+	CHECK(frame.drawCalls == 6);
+	CHECK(frame.textureSwitches == 4);
+
+	counter.endFrame();
+	CHECK(counter.getLastFrame().drawCalls == 6);
+	CHECK(counter.getFrame().drawCalls == 0);
+	CHECK(counter.toString() == "draw calls 6, texture switches 4, quads 22, commands 7");
+}
+
+static void testDrawCounterFrames()
+{
+	GlyphDrawCounter counter;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		//every frame rebinds its first texture, like the renderer
+		counter.beginFrame();
+		counter.addQuads(1, 10, 3);
+		counter.addQuads(1, 10, 3);
+		counter.endFrame();
+		CHECK(counter.getLastFrame().drawCalls == 1);
+		CHECK(counter.getLastFrame().textureSwitches == 1);
+	}
+
+	CHECK(counter.getFrameCount() == 3);
+	CHECK(counter.getTotal().drawCalls == 3);
+	CHECK(counter.getTotal().quads == 18);
+	CHECK(counter.getTotal().commands == 6);
+
+	counter.reset();
+	CHECK(counter.getFrameCount() == 0 && counter.getTotal().quads == 0);
+
+	GlyphDrawCounter::setActive(&counter);
+	CHECK(GlyphDrawCounter::getActive() == &counter);
+	GlyphDrawCounter::setActive(nullptr);
+	CHECK(GlyphDrawCounter::getActive() == nullptr);
+}
+
+//HIT GRID
+
+//an axis aligned glyph, corners in GlyphAnimator::getCorners order
+static void makeBox(float corners[8], float x, float y, float width, float height)
+{
+	const float box[8] = { x, y, x + width, y, x, y + height, x + width, y + height };
+	for (int i = 0; i < 8; ++i)
+		corners[i] = box[i];
+}
+
+static void testHitGridRow()
+{
+	GlyphHitGrid grid;
+	grid.reset(5, 20);
+	CHECK(grid.getGlyphCount() == 5);
+
+	//ten wide glyphs with gaps of four, the first one left of the origin
+	float corners[8];
+	for (int i = 0; i < 5; ++i)
+	{
+		makeBox(corners, i * 14.f - 14, 0, 10, 16);
+		CHECK(grid.setGlyph(i, corners));
+	}
+
+	CHECK(grid.hitTest(-9, 8) == 0);
+	CHECK(grid.hitTest(5, 1) == 1);
+	CHECK(grid.hitTest(47, 15) == 4);
+	CHECK(grid.hitTest(12, 8) == -1); //the gap
+	CHECK(grid.hitTest(5, 17) == -1); //above
+	CHECK(grid.hitTest(500, 8) == -1); //no cell
+
+	//an unmoved glyph is left alone
+	makeBox(corners, 0, 0, 10, 16);
+	CHECK(!grid.setGlyph(1, corners));
+
+	//moved to another cell, it's only found there
+	makeBox(corners, 100, 100, 10, 16);
+	CHECK(grid.setGlyph(1, corners));
+	CHECK(grid.hitTest(5, 8) == -1);
+	CHECK(grid.hitTest(105, 108) == 1);
+
+	grid.removeGlyph(1);
+	CHECK(grid.hitTest(105, 108) == -1);
+	CHECK(!grid.setGlyph(7, corners));
+}
+
+static void testHitGridRotatedAndOverlapping()
+{
+	GlyphHitGrid grid;
+	grid.reset(2, 16);
+
+	//a diamond around (20, 20): the corners of its bounding box are outside it
+	const float diamond[8] = { 20, 10, 30, 20, 10, 20, 20, 30 };
+	CHECK(grid.setGlyph(0, diamond));
+	CHECK(grid.hitTest(20, 20) == 0);
+	CHECK(grid.hitTest(28, 20) == 0);
+	CHECK(grid.hitTest(12, 12) == -1);
+	CHECK(grid.hitTest(28, 28) == -1);
+
+	//drawn last, so it wins where they overlap
+	float corners[8];
+	makeBox(corners, 18, 18, 20, 4);
+	CHECK(grid.setGlyph(1, corners));
+	CHECK(grid.hitTest(20, 20) == 1);
+	CHECK(grid.hitTest(20, 25) == 0);
+	CHECK(grid.hitTest(35, 20) == 1);
+
+	//collapsed to a line by a scale of 0, it can't be hit
+	makeBox(corners, 18, 18, 20, 0);
+	grid.setGlyph(1, corners);
+	CHECK(grid.hitTest(20, 18) == 0);
+}
+
+//PATHS
+
+static float distance(const GlyphPath::Point& a, const GlyphPath::Point& b)
+{
+	return hypotf(b.x - a.x, b.y - a.y);
+}
+
+//every step of a fraction moving at a constant rate covers the same distance
+static void checkConstantSpeed(const GlyphPath& path, float tolerance)
+{
+	const int steps = 100;
+	const float step = path.getLength() / steps;
+
+	GlyphPath::Point previous = path.getPoint(0);
+	for (int i = 1; i <= steps; ++i)
+	{
+		const GlyphPath::Point point = path.getPoint((float)i / steps);
+		CHECK(near(distance(previous, point), step, step * tolerance));
+		previous = point;
+	}
+}
+
+static void testPathCircle()
+{
+	const float pi = 3.14159265f;
+	const GlyphPath path = GlyphPath::circle(50, 90, 1);
+	CHECK(near(path.getLength(), 2 * pi * 50, 1e-2f));
+
+	//clockwise from the top
+	const GlyphPath::Point start = path.getPoint(0);
+	const GlyphPath::Point quarter = path.getPoint(0.25f);
+	CHECK(near(start.x, 0, 1e-3f) && near(start.y, 50, 1e-3f));
+	CHECK(near(quarter.x, 50, 1e-3f) && near(quarter.y, 0, 1e-3f));
+
+	//closed, so the end is the start exactly
+	const GlyphPath::Point end = path.getPoint(1);
+	CHECK(end.x == start.x && end.y == start.y);
+
+	const GlyphPath::Point half = GlyphPath::circle(10, 0, 0.5f, false).getPoint(1);
+	CHECK(near(half.x, -10, 1e-3f) && near(half.y, 0, 1e-3f));
+
+	//the chords between steps fall short of the arc by under a tenth of a percent
+	checkConstantSpeed(path, 1e-3f);
+}
+
+static void testPathSpiral()
+{
+	const float pi = 3.14159265f;
+	const GlyphPath path = GlyphPath::spiral(10, 60, 0, 2, false);
+
+	//the length of the Archimedean spiral, by summing a fine polyline along it
+	float length = 0;
+	GlyphPath::Point previous(10, 0);
+	for (int i = 1; i <= 20000; ++i)
+	{
+		const float t = i / 20000.f;
+		const float radius = 10 + 50 * t;
+		const GlyphPath::Point point(radius * cosf(4 * pi * t), radius * sinf(4 * pi * t));
+		length += distance(previous, point);
+		previous = point;
+	}
+	//the table measures 32 chords a turn, which fall short of the curve a little
+	CHECK(path.getLength() <= length);
+	CHECK(near(path.getLength(), length, length * 5e-3f));
+
+	const GlyphPath::Point end = path.getPoint(1);
+	CHECK(near(end.x, 60, 1e-2f) && near(end.y, 0, 1e-2f));
+
+	//the outer turn is longer, so half the length is well past the first turn
+	const GlyphPath::Point middle = path.getPoint(0.5f);
+	CHECK(hypotf(middle.x, middle.y) > 35);
+
+	checkConstantSpeed(path, 1e-2f);
+}
+
+static void testPathBezier()
+{
+	//control points bunched at the start, so the parameter is far from even
+	const GlyphPath path = GlyphPath::bezier(GlyphPath::Point(0, 0), GlyphPath::Point(5, 0), GlyphPath::Point(10, 0), GlyphPath::Point(300, 200));
+
+	const GlyphPath::Point start = path.getPoint(0);
+	const GlyphPath::Point end = path.getPoint(1);
+	CHECK(start.x == 0 && start.y == 0);
+	CHECK(near(end.x, 300, 1e-2f) && near(end.y, 200, 1e-2f));
+	CHECK(path.getLength() > distance(start, end));
+
+	checkConstantSpeed(path, 2e-2f);
+
+	//clamped
+	const GlyphPath::Point before = path.getPoint(-1);
+	const GlyphPath::Point after = path.getPoint(2);
+	CHECK(before.x == start.x && before.y == start.y);
+	CHECK(after.x == end.x && after.y == end.y);
+}
+
+static void testPathPolyline()
+{
+	//segments of 30, 40 and 30
+	const GlyphPath path = GlyphPath::polyline({ GlyphPath::Point(0, 0), GlyphPath::Point(30, 0), GlyphPath::Point(30, 40), GlyphPath::Point(0, 40) });
+	CHECK(near(path.getLength(), 100));
+
+	const GlyphPath::Point corner = path.getPoint(0.3f);
+	const GlyphPath::Point middle = path.getPoint(0.5f);
+	const GlyphPath::Point last = path.getPoint(0.85f);
+	CHECK(near(corner.x, 30, 1e-3f) && near(corner.y, 0, 1e-3f));
+	CHECK(near(middle.x, 30, 1e-3f) && near(middle.y, 20, 1e-3f));
+	CHECK(near(last.x, 15, 1e-3f) && near(last.y, 40, 1e-3f));
+
+	checkConstantSpeed(path, 1e-3f);
+
+	//a single point, or none, is a path going nowhere
+	const GlyphPath still = GlyphPath::polyline({ GlyphPath::Point(4, 5) });
+	CHECK(still.getLength() == 0);
+	CHECK(still.getPoint(0.5f).x == 4 && still.getPoint(0.5f).y == 5);
+	CHECK(GlyphPath().getLength() == 0);
+}
+
+//BAKED CLIPS
+
+//two glyphs moving from their rest corners, the first at a constant speed, the second
+//bouncing, while the second fades when fade is set
+static void bakeFrame(float time, bool fade, float* corners, unsigned char* colors)
+{
+	float rest[16];
+	makeBox(rest, 0, 0, 10, 16);
+	makeBox(rest + 8, 12, 0, 10, 16);
+
+	for (int i = 0; i < 16; ++i)
+	{
+		const bool x = i % 2 == 0;
+		const float move = i < 8 ? (x ? time * 40 : 0.f) : (x ? 0.f : fabsf(sinf(time * 6)) * 30);
+		corners[i] = rest[i] + move;
+	}
+
+	for (int i = 0; i < 32; ++i)
+	{
+		colors[i] = (unsigned char)(fade && i >= 16 && i % 4 == 3 ? 255 - time * 200 : 255);
+	}
+}
+
+static std::shared_ptr<GlyphBakedClip> bake(bool fade, int frames)
+{
+	float rest[16];
+	unsigned char colors[32];
+	bakeFrame(0, false, rest, colors);
+
+	std::shared_ptr<GlyphBakedClip> clip = std::make_shared<GlyphBakedClip>();
+	clip->beginCapture(2, rest);
+
+	float corners[16];
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		bakeFrame(frame / 60.f, fade, corners, colors);
+		clip->addFrame(frame / 60.f, corners, colors);
+	}
+
+	clip->finishCapture();
+	return clip;
+}
+
+static void testBakedClipReplay()
+{
+	const std::shared_ptr<GlyphBakedClip> clip = bake(true, 61);
+	CHECK(clip->getGlyphCount() == 2);
+	CHECK(clip->getCapturedFrameCount() == 61);
+	CHECK(near(clip->getDuration(), 1));
+	CHECK(clip->hasColors());
+	//the bounce needs keyframes, but far fewer than there were frames
+	CHECK(clip->getKeyframeCount() > 2 && clip->getKeyframeCount() < 40);
+
+	//played on a label moved by (100, 50): the same motion from its own rest corners
+	float rest[16];
+	unsigned char colors[32];
+	bakeFrame(0, false, rest, colors);
+	float movedRest[16];
+	for (int i = 0; i < 16; ++i)
+		movedRest[i] = rest[i] + (i % 2 == 0 ? 100 : 50);
+
+	for (int frame = 0; frame <= 60; ++frame)
+	{
+		float expected[16];
+		unsigned char expectedColors[32];
+		bakeFrame(frame / 60.f, true, expected, expectedColors);
+
+		float blend;
+		const int keyframe = clip->findKeyframe(frame / 60.f, blend);
+		for (int glyph = 0; glyph < 2; ++glyph)
+		{
+			float corners[8];
+			unsigned char sampled[16];
+			clip->sampleGlyph(keyframe, blend, glyph, movedRest + glyph * 8, corners, sampled);
+
+			//the tolerance, plus the eighths of a point offsets are stored in
+			for (int i = 0; i < 8; ++i)
+				CHECK(near(corners[i] - (i % 2 == 0 ? 100 : 50), expected[glyph * 8 + i], 0.25f + 1/16.f + 1e-3f));
+			for (int i = 0; i < 16; ++i)
+				CHECK(abs(sampled[i] - expectedColors[glyph * 16 + i]) <= 3);
+		}
+	}
+
+	//held at the last keyframe after the end
+	float blend;
+	const int last = clip->findKeyframe(5, blend);
+	CHECK(last == clip->getKeyframeCount() - 2 && blend == 1);
+}
+
+static void testBakedClipLinear()
+{
+	//only the constant speed glyph moves: two keyframes, no colours
+	float rest[16];
+	unsigned char colors[32];
+	bakeFrame(0, false, rest, colors);
+
+	GlyphBakedClip clip;
+	clip.beginCapture(2, rest);
+	for (int frame = 0; frame < 31; ++frame)
+	{
+		float corners[16];
+		for (int i = 0; i < 16; ++i)
+			corners[i] = rest[i] + (i < 8 && i % 2 == 0 ? frame : 0);
+		clip.addFrame(frame / 30.f, corners, colors);
+	}
+
+	CHECK(clip.finishCapture());
+	CHECK(clip.getKeyframeCount() == 2);
+	CHECK(!clip.hasColors());
+
+	float blend, corners[8];
+	const int keyframe = clip.findKeyframe(0.5f, blend);
+	clip.sampleGlyph(keyframe, blend, 0, rest, corners, nullptr);
+	CHECK(near(corners[0], 15) && near(corners[1], 0));
+
+	GlyphBakedClip empty;
+	empty.beginCapture(2, rest);
+	CHECK(!empty.finishCapture());
+}
+
+static void testBakeCacheEviction()
+{
+	const std::shared_ptr<GlyphBakedClip> a = bake(false, 31);
+	const std::shared_ptr<GlyphBakedClip> b = bake(false, 31);
+	const std::shared_ptr<GlyphBakedClip> c = bake(false, 31);
+
+	//the same size each, so the limit holds two and a half of them
+	GlyphBakeCache cache;
+	cache.insert("a", a);
+	const size_t entryBytes = cache.getStats().bytes;
+	CHECK(entryBytes >= a->getBytes());
+	cache.setByteLimit(entryBytes * 5 / 2);
+
+	cache.insert("b", b);
+	CHECK(cache.find("a") == a); //now b is the least recently used
+	cache.insert("c", c);
+
+	CHECK(cache.getStats().clips == 2);
+	CHECK(cache.getStats().bytes == entryBytes * 2);
+	CHECK(cache.getStats().evictions == 1);
+	CHECK(cache.find("b") == nullptr);
+	CHECK(cache.find("a") == a);
+	CHECK(cache.find("c") == c);
+	CHECK(cache.getStats().hits == 3 && cache.getStats().misses == 1);
+
+	//replacing a clip doesn't count it twice
+	cache.insert("c", c);
+	CHECK(cache.getStats().clips == 2 && cache.getStats().bytes == entryBytes * 2);
+
+	//shrinking the limit evicts, from the least recently used: a was found before c
+	cache.setByteLimit(entryBytes);
+	CHECK(cache.getStats().clips == 1);
+	CHECK(cache.find("c") == c);
+	CHECK(a.use_count() == 1); //only ours is left
+
+	//a clip over the limit on its own isn't kept
+	cache.setByteLimit(entryBytes / 2);
+	CHECK(cache.getStats().clips == 0 && cache.getStats().bytes == 0);
+	cache.insert("a", a);
+	CHECK(cache.find("a") == nullptr);
+
+	cache.resetStats();
+	CHECK(cache.getStats().hits == 0 && cache.getStats().misses == 0 && cache.getStats().evictions == 0);
+}
+
+//TEXT LAYOUT
+
+//letters 10 wide a 12 advance apart, spaces 6, no x, and c on the second page
+static bool lookupTestLetter(char32_t character, GlyphTextLayout::Letter& letter)
+{
+	if (character == 'x')
+		return false;
+
+	const bool space = character == ' ';
+	letter.offsetX = space ? 0.f : 1.f;
+	letter.offsetY = 2;
+	letter.width = space ? 0.f : 10.f;
+	letter.height = 16;
+	letter.xAdvance = space ? 6.f : 12.f;
+	letter.atlasIndex = character == 'c' ? 1 : 0;
+	return true;
+}
+
+static GlyphTextLayout::Settings getTestLayoutSettings(float maxLineWidth)
+{
+	GlyphTextLayout::Settings settings;
+	settings.maxLineWidth = maxLineWidth;
+	settings.lineHeight = 20;
+	return settings;
+}
+
+static void checkLetter(const GlyphTextLayout& layout, int index, float x, float y, int line)
+{
+	const GlyphTextLayout::LetterInfo& letter = layout.getLetters()[index];
+	CHECK(!letter.placeholder);
+	CHECK(near(letter.positionX, x) && near(letter.positionY, y));
+	CHECK(letter.lineIndex == line);
+}
+
+static void testTextLayoutLine()
+{
+	GlyphTextLayout layout;
+	layout.layout(U"abc", {}, lookupTestLetter, getTestLayoutSettings(0));
+
+	CHECK(layout.isComplete());
+	CHECK(layout.getLetters().size() == 3);
+	checkLetter(layout, 0, 1, -2, 0);
+	checkLetter(layout, 1, 13, -2, 0);
+	checkLetter(layout, 2, 25, -2, 0);
+	CHECK(layout.getLetters()[2].atlasIndex == 1);
+
+	CHECK(layout.getNumberOfLines() == 1);
+	CHECK(layout.getLinesWidth().size() == 1 && near(layout.getLinesWidth()[0], 36));
+	CHECK(near(layout.getWidth(), 36) && near(layout.getHeight(), 20));
+	CHECK(near(layout.getTextDesiredHeight(), 20) && near(layout.getLetterOffsetY(), 20));
+	CHECK(layout.getLinesOffsetX().size() == 1 && layout.getLinesOffsetX()[0] == 0);
+
+	//drawing the next letter in place is left to the label
+	layout.layout(U"a\bb", {}, lookupTestLetter, getTestLayoutSettings(0));
+	CHECK(!layout.isComplete());
+}
+
+static void testTextLayoutWrapByWord()
+{
+	GlyphTextLayout::Settings settings = getTestLayoutSettings(40);
+	settings.hAlignment = GlyphTextLayout::HAlignment::CENTER;
+
+	//cd doesn't fit after the space, the space stays on the first line
+	GlyphTextLayout layout;
+	layout.layout(U"ab cd", {}, lookupTestLetter, settings);
+	checkLetter(layout, 0, 1, -2, 0);
+	checkLetter(layout, 1, 13, -2, 0);
+	checkLetter(layout, 2, 24, -2, 0);
+	checkLetter(layout, 3, 1, -22, 1);
+	checkLetter(layout, 4, 13, -22, 1);
+
+	CHECK(layout.getNumberOfLines() == 2);
+	CHECK(near(layout.getLinesWidth()[0], 30) && near(layout.getLinesWidth()[1], 24));
+	CHECK(near(layout.getWidth(), 30) && near(layout.getHeight(), 40));
+	CHECK(near(layout.getLinesOffsetX()[0], 0) && near(layout.getLinesOffsetX()[1], 3));
+
+	//with room for c but not d, the word still moves down whole
+	settings.maxLineWidth = 50;
+	layout.layout(U"ab cd", {}, lookupTestLetter, settings);
+	checkLetter(layout, 3, 1, -22, 1);
+	checkLetter(layout, 4, 13, -22, 1);
+
+	//a word too long for a line is split where it overflows
+	settings.maxLineWidth = 30;
+	layout.layout(U"abcd", {}, lookupTestLetter, settings);
+	checkLetter(layout, 1, 13, -2, 0);
+	checkLetter(layout, 2, 1, -22, 1);
+	checkLetter(layout, 3, 13, -22, 1);
+}
+
+static void testTextLayoutWrapByChar()
+{
+	GlyphTextLayout::Settings settings = getTestLayoutSettings(50);
+	settings.lineBreakWithoutSpaces = true;
+
+	//only d moves down
+	GlyphTextLayout layout;
+	layout.layout(U"ab cd", {}, lookupTestLetter, settings);
+	checkLetter(layout, 3, 31, -2, 0);
+	checkLetter(layout, 4, 1, -22, 1);
+	CHECK(near(layout.getLinesWidth()[0], 42) && near(layout.getLinesWidth()[1], 12));
+
+	//no wrapping at all
+	settings.enableWrap = false;
+	layout.layout(U"ab cd", {}, lookupTestLetter, settings);
+	checkLetter(layout, 4, 43, -2, 0);
+	CHECK(layout.getNumberOfLines() == 1);
+}
+
+static void testTextLayoutPlaceholdersAndScale()
+{
+	//a font at twice the size on a screen at twice the resolution, c kerned 3 further from b
+	GlyphTextLayout::Settings settings = getTestLayoutSettings(0);
+	settings.fontScale = 2;
+	settings.contentScaleFactor = 2;
+	settings.labelWidth = 50;
+	settings.labelHeight = 100;
+	settings.hAlignment = GlyphTextLayout::HAlignment::RIGHT;
+	settings.vAlignment = GlyphTextLayout::VAlignment::CENTER;
+
+	GlyphTextLayout layout;
+	layout.layout(U"a\nxbc", { 0, 0, 0, 0, 3 }, lookupTestLetter, settings);
+
+	checkLetter(layout, 0, 1, -2, 0);
+	CHECK(layout.getLetters()[1].placeholder && layout.getLetters()[1].character == '\n');
+	CHECK(layout.getLetters()[2].placeholder && layout.getLetters()[2].character == 'x');
+	checkLetter(layout, 3, 1, -22, 1);
+	checkLetter(layout, 4, 14.5f, -22, 1);
+
+	CHECK(near(layout.getLinesWidth()[0], 12) && near(layout.getLinesWidth()[1], 25.5f));
+	CHECK(near(layout.getTextDesiredHeight(), 40));
+	CHECK(near(layout.getWidth(), 50) && near(layout.getHeight(), 100));
+	CHECK(near(layout.getLinesOffsetX()[0], 38) && near(layout.getLinesOffsetX()[1], 24.5f));
+	CHECK(near(layout.getLetterOffsetY(), 70));
+
+	settings.vAlignment = GlyphTextLayout::VAlignment::BOTTOM;
+	layout.layout(U"a\nxbc", { 0, 0, 0, 0, 3 }, lookupTestLetter, settings);
+	CHECK(near(layout.getLetterOffsetY(), 40));
+}
+
+//EFFECT LOG
+
+static GlyphEffectLog::Call makeCall(float time, int label, const char* name, const std::vector<double>& args, const std::string& text)
+{
+	GlyphEffectLog::Call call;
+	call.time = time;
+	call.label = label;
+	call.name = name;
+	call.args = args;
+	call.text = text;
+	return call;
+}
+
+static void testEffectLogRoundTrip()
+{
+	//a label as AnimatedLabel logs it, with a random state that needs all 32 bits, then
+	//text with the characters the format escapes
+	GlyphEffectLog log;
+	log.addCall(makeCall(0, 0, "label", { 0, 1, 300, 240.5, -12.25, 1, 4294967295., 1.5, 0.75, 30, 30, 0, 1, 400, 0, 2, 3, -4, -1 }, "fonts/futura-48.fnt"));
+	log.addCall(makeCall(0, 0, "setString", {}, "two\nlines \\ and a | bar"));
+	log.addCall(makeCall(0.0166666675f, 1, "label", { 24, 0, 0, 0, 0, 0, 7 }, "fonts/Marker Felt.ttf"));
+	log.addCall(makeCall(1.25f, 1, "animateInSwell", { 0.1 }, ""));
+	log.addCall(makeCall(2.5f, 0, "unreplayable", {}, "runActionOnAllSprites"));
+
+	GlyphEffectLog read;
+	CHECK(read.fromString(log.toString()));
+	CHECK(read.getCallCount() == log.getCallCount());
+	CHECK(read.getLabelCount() == 2);
+	CHECK(read.getDuration() == 2.5f);
+
+	for (int i = 0; i < read.getCallCount() && i < log.getCallCount(); ++i)
+	{
+		const GlyphEffectLog::Call& written = log.getCall(i);
+		const GlyphEffectLog::Call& call = read.getCall(i);
+		CHECK(call.time == written.time);
+		CHECK(call.label == written.label);
+		CHECK(call.name == written.name);
+		CHECK(call.args == written.args);
+		CHECK(call.text == written.text);
+	}
+
+	//written again, it reads the same
+	CHECK(read.toString() == log.toString());
+
+	const std::string text = log.toString();
+	CHECK(!read.fromString("not an effect log\n" + text.substr(text.find('\n') + 1)));
+	CHECK(!read.fromString(text.substr(0, text.rfind("2.5"))));
+}
+
+int main()
+{
+	const std::vector<std::pair<const char*, std::function<void()>>> tests = {
+		{ "springs fixed step", testSpringsFixedStep },
+		{ "springs sleep", testSpringsSleep },
+		{ "springs vectorized", testSpringsVectorized },
+		{ "trace clear while recording", testTraceClearWhileRecording },
+		{ "atlas packer shelves", testAtlasPackerShelves },
+		{ "atlas packer pages", testAtlasPackerPages },
+		{ "draw counter batching", testDrawCounterBatching },
+		{ "draw counter frames", testDrawCounterFrames },
+		{ "hit grid row", testHitGridRow },
+		{ "hit grid rotated and overlapping", testHitGridRotatedAndOverlapping },
+		{ "path circle", testPathCircle },
+		{ "path spiral", testPathSpiral },
+		{ "path bezier", testPathBezier },
+		{ "path polyline", testPathPolyline },
+		{ "baked clip replay", testBakedClipReplay },
+		{ "baked clip linear", testBakedClipLinear },
+		{ "bake cache eviction", testBakeCacheEviction },
+		{ "text layout line", testTextLayoutLine },
+		{ "text layout wrap by word", testTextLayoutWrapByWord },
+		{ "text layout wrap by char", testTextLayoutWrapByChar },
+		{ "text layout placeholders and scale", testTextLayoutPlaceholdersAndScale },
+		{ "effect log round trip", testEffectLogRoundTrip },
+	};
+
+	for (auto&& test : tests)
+	{
+		const int failures = s_failures;
+		test.second();
+		printf("%s: %s\n", test.first, s_failures == failures ? "ok" : "FAILED");
+	}
+
+	if (s_failures > 0)
+	{
+		fprintf(stderr, "%d checks failed\n", s_failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,333 @@
+//
+//  GlyphGoldenTests.cpp
+//  AnimatedLabel
+//
+
+/*
+   Copyright (c) 2015 Steve Barnegren
+   Copyright (c) 2017 Wilson E. Alvarez
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//Drives every effect AnimatedLabel runs in compact mode through a GlyphAnimator, over a
+//fixed two line layout, with the stagger, timing and variants the label gives it, and
+//checks the samples against the recordings in Tests/golden, so a change to the compact
+//engine shows up on CI. Needs no cocos2d, window or GL, so it runs headless. Whether the
+//compact engine matches the sprite and action effects it stands in for is checked by
+//AnimatedLabelGoldens, which needs cocos2d (see Tests/golden/sprite).
+//
+//	GlyphGoldenTests <golden directory> [--update]
+//
+//--update writes the recordings as the new goldens instead of checking them.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "GlyphAnimator.h"
+#include "GlyphEffectLibrary.h"
+#include "GlyphPath.h"
+#include "GlyphRecording.h"
+#include "GlyphStagger.h"
+
+//the screen the fly ins start from, at a label scale of 1
+static const float kVisibleWidth = 480.f;
+static const float kVisibleHeight = 320.f;
+
+//a monospace font: every character 10pt apart, its quad 8 by 12, lines 16pt apart
+static const float kAdvance = 10.f;
+static const float kGlyphWidth = 8.f;
+static const float kGlyphHeight = 12.f;
+static const float kLineHeight = 16.f;
+
+//What the label does with its glyphs in compact mode, without the label
+class GoldenLabel
+{
+	public:
+
+		explicit GoldenLabel(const std::string& text)
+		{
+			int numLines = 1 + (int)std::count(text.begin(), text.end(), '\n');
+			int line = 0, column = 0, word = -1;
+			bool inWord = false;
+
+			_animator.reset((int)text.size());
+			_glyphs.resize(text.size());
+			_width = 0;
+
+			for (int i = 0; i < (int)text.size(); ++i)
+			{
+				const char c = text[i];
+				const bool whitespace = (c == ' ' || c == '\n');
+
+				if (!whitespace && !inWord)
+					++word;
+				inWord = !whitespace;
+
+				GlyphLayout& layout = _animator.getLayout(i);
+				layout.left = column * kAdvance;
+				layout.right = layout.left + kGlyphWidth;
+				layout.bottom = (numLines - 1 - line) * kLineHeight;
+				layout.top = layout.bottom + kGlyphHeight;
+				layout.page = 0;
+				layout.atlasIndex = whitespace ? -1 : i;
+
+				_glyphs[i].x = layout.left;
+				_glyphs[i].y = layout.bottom;
+				_glyphs[i].word = std::max(word, 0);
+				_glyphs[i].line = line;
+
+				if (c == '\n')
+				{
+					++line;
+					column = 0;
+				}
+				else
+				{
+					++column;
+					_width = std::max(_width, column * kAdvance);
+				}
+			}
+
+			_animator.setGroups(_glyphs);
+		}
+
+		float getWidth() const { return _width; }
+		int getLength() const { return (int)_glyphs.size(); }
+
+		//the calls AnimatedLabel::startGlyphEffect, runGroupEffect and addAnimationLayer make
+		void startEffect(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, float initialDelay = 0.f, const std::vector<unsigned char>& variants = std::vector<unsigned char>())
+		{
+			_animator.startStaggered(effect, stagger, _glyphs, staggerDuration, initialDelay, variants, _offsets);
+		}
+
+		void startGroupEffect(GlyphAnimator::GroupLevel level, const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration)
+		{
+			_animator.startStaggeredGroupEffect(level, effect, stagger, _glyphs, staggerDuration, 0);
+		}
+
+		void addLayer(const GlyphEffect& effect, const GlyphStagger& stagger, float staggerDuration, bool loop, float fadeIn)
+		{
+			_animator.addStaggeredLayer(effect, stagger, _glyphs, staggerDuration, loop, fadeIn, 1.f);
+		}
+
+		//AnimatedLabel::recordEffect, stepping the animator as the scheduler would step
+		//the label, sampled as AnimatedLabel::sampleGlyphs samples a white, opaque label
+		GlyphRecording record(const std::vector<float>& timestamps, float dt = 1.f/60)
+		{
+			GlyphRecording recording;
+			std::vector<GlyphSample> samples;
+			float elapsed = 0.f;
+
+			for (float time : timestamps)
+			{
+				while (elapsed + dt <= time)
+				{
+					_animator.update(dt);
+					elapsed += dt;
+				}
+
+				if (time > elapsed)
+				{
+					_animator.update(time - elapsed);
+					elapsed = time;
+				}
+
+				sample(samples);
+				recording.addFrame(time, samples);
+			}
+
+			return recording;
+		}
+
+	private:
+
+		void sample(std::vector<GlyphSample>& samples) const
+		{
+			samples.assign(_glyphs.size(), GlyphSample());
+
+			for (int i = 0; i < (int)_glyphs.size(); ++i)
+			{
+				if (_animator.getLayout(i).atlasIndex < 0)
+					continue;
+
+				GlyphSample& sample = samples[i];
+				GlyphState state;
+				_animator.getComposedState(i, sample.x, sample.y, state);
+				sample.scaleX = sample.scaleY = state.scale;
+				sample.rotation = state.rotation;
+				sample.r = sample.g = sample.b = 255;
+				sample.a = (unsigned char)(255 * std::max(0.f, std::min(1.f, _animator.getOpacity(i))));
+			}
+		}
+
+		GlyphAnimator _animator;
+		std::vector<GlyphStagger::Glyph> _glyphs;
+		std::vector<float> _offsets;
+		float _width;
+};
+
+struct GoldenCase
+{
+	const char *name;
+	float length; //seconds sampled
+	std::function<void(GoldenLabel& label)> start;
+};
+
+static std::vector<GoldenCase> goldenCases()
+{
+	//the label's defaults: getEffectStagger is linear, or linear reverse for effects from the right
+	std::vector<GoldenCase> cases;
+
+	cases.push_back({ "animateInFlyInFromLeft", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::flyIn(-kVisibleWidth, 0), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateInFlyInFromRight", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::flyIn(kVisibleWidth, 0), GlyphStagger::linearReverse(), 1.f);
+	} });
+	cases.push_back({ "animateInFlyInFromTop", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::flyIn(0, kVisibleHeight), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateInFlyInFromBottom", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::flyIn(0, -kVisibleHeight), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateInDropFromTop", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::dropFromTop(kVisibleHeight), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateInTypewriter", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::typewriter(), GlyphStagger::linear(), 1.f, 0.25f);
+	} });
+	cases.push_back({ "animateInSwell", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::inSwell(), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateSwell", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::swell(), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateJump", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::jump(30), GlyphStagger::linear(), 1.f);
+	} });
+	cases.push_back({ "animateStretchElastic", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::stretchElastic(0.25f, 1.f, 1.5f, label.getWidth()), GlyphStagger::linear(), 0);
+	} });
+	cases.push_back({ "animateInSpin", 1.5f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::inSpin(1.f, 2, label.getWidth(), true), GlyphStagger::linear(), 0);
+	} });
+	cases.push_back({ "animateInAlongPath", 2.f, [](GoldenLabel& label) {
+		label.startEffect(GlyphEffectLibrary::alongPath(GlyphPath::bezier(GlyphPath::Point(-200, 100), GlyphPath::Point(-100, 200), GlyphPath::Point(0, -50), GlyphPath::Point(0, 0)), 1.f, GlyphEffect::Ease::SINE_OUT), GlyphStagger::linear(), 0.5f);
+	} });
+	cases.push_back({ "animateInVortex", 3.f, [](GoldenLabel& label) {
+		std::vector<unsigned char> variants;
+		GlyphEffectLibrary::vortexVariants(label.getLength(), variants);
+		label.startEffect(GlyphEffectLibrary::vortex(2.f, 2, label.getWidth()), GlyphStagger::random(7), 0.9f, 0.f, variants);
+	} });
+	cases.push_back({ "animateWordsJump", 1.5f, [](GoldenLabel& label) {
+		label.startGroupEffect(GlyphAnimator::GroupLevel::WORD, GlyphEffectLibrary::jump(30), GlyphStagger::linear(), 0.5f);
+	} });
+	cases.push_back({ "animateInLinesFlyInFromLeft", 2.f, [](GoldenLabel& label) {
+		label.startGroupEffect(GlyphAnimator::GroupLevel::LINE, GlyphEffectLibrary::flyIn(-kVisibleWidth, 0), GlyphStagger::perLine(), 0.5f);
+	} });
+	cases.push_back({ "addWobbleLayer", 2.f, [](GoldenLabel& label) {
+		label.addLayer(GlyphEffectLibrary::wobble(15, 1.f), GlyphStagger::linear(), 0.5f, true, 0.25f);
+	} });
+	cases.push_back({ "addPulseLayer", 2.f, [](GoldenLabel& label) {
+		label.addLayer(GlyphEffectLibrary::pulse(1.25f, 1.f), GlyphStagger::linear(), 0.5f, true, 0.25f);
+	} });
+
+	return cases;
+}
+
+static bool readFile(const std::string& path, std::string& text)
+{
+	std::ifstream file(path.c_str());
+	if (!file)
+		return false;
+
+	std::stringstream contents;
+	contents << file.rdbuf();
+	text = contents.str();
+	return true;
+}
+
+static bool writeFile(const std::string& path, const std::string& text)
+{
+	std::ofstream file(path.c_str());
+	file << text;
+	return (bool)file;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <golden directory> [--update]\n", argv[0]);
+		return 2;
+	}
+
+	const std::string goldenDirectory = argv[1];
+	const bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+	int failures = 0;
+
+	for (const GoldenCase& goldenCase : goldenCases())
+	{
+		//an eighth of a second apart, from the start until length
+		std::vector<float> timestamps;
+		for (int frame = 0; frame * 0.125f <= goldenCase.length; ++frame)
+		{
+			timestamps.push_back(frame * 0.125f);
+		}
+
+		GoldenLabel label("Go on\nup");
+		goldenCase.start(label);
+		const GlyphRecording recording = label.record(timestamps);
+
+		const std::string path = goldenDirectory + "/" + goldenCase.name + ".txt";
+
+		if (update)
+		{
+			if (!writeFile(path, recording.toString()))
+			{
+				fprintf(stderr, "%s: can't write %s\n", goldenCase.name, path.c_str());
+				failures++;
+			}
+			continue;
+		}
+
+		std::string text;
+		GlyphRecording golden;
+		if (!readFile(path, text) || !golden.fromString(text))
+		{
+			fprintf(stderr, "%s: no golden recording at %s\n", goldenCase.name, path.c_str());
+			failures++;
+			continue;
+		}
+
+		std::string report;
+		if (!recording.matches(golden, GlyphRecording::Tolerance(), &report))
+		{
+			fprintf(stderr, "%s: doesn't match its golden recording\n%s", goldenCase.name, report.c_str());
+			failures++;
+			continue;
+		}
+
+		printf("%s: ok\n", goldenCase.name);
+	}
+
+	if (failures > 0)
+	{
+		fprintf(stderr, "%d effects failed\n", failures);
+		return 1;
+	}
+
+	return 0;
+}